@@ -0,0 +1,115 @@
+#include "benchmarks.h"
+
+#include "ann/layers/multiHeadAttention.h"
+#include "math/dot.h"
+#include "math/matrix.h"
+#include "math/random.h"
+#include "utils/parallel.h"
+#include "utils/timer.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+// Same computation as MultiHeadAttention::predict(), but materializing every
+// head's full (timesteps, timesteps) score matrix
+static Math::Matrix<float>
+naiveAttention(const ANN::Layers::MultiHeadAttention &layer,
+               const Math::Matrix<float> &inputs, size_t features) {
+  const size_t batches{inputs.rows()};
+  const size_t steps{inputs.cols() / features};
+  const size_t heads{layer.heads()};
+  const size_t headSize{features / heads};
+  const float scale{1.0f / std::sqrt(static_cast<float>(headSize))};
+
+  auto stepInputs{inputs.view()};
+  stepInputs.reshape(batches * steps, features);
+  const Math::Matrix<float> projections{
+      Math::dotTB(stepInputs, layer.inputWeights())};
+  Math::Matrix<float> concatenated{batches * steps, features};
+
+  Utils::Parallel::dynamicParallelFor(
+      4 * steps * steps * headSize, batches * heads, [&](size_t item) {
+        const size_t batch{item / heads};
+        const size_t head{item % heads};
+        const size_t start{head * headSize};
+        Math::Matrix<float> queries{steps, headSize};
+        Math::Matrix<float> keys{steps, headSize};
+        Math::Matrix<float> values{steps, headSize};
+        for (size_t t{}; t < steps; ++t)
+          for (size_t c{}; c < headSize; ++c) {
+            const size_t row{batch * steps + t};
+            const auto &biases{layer.inputBiases()};
+            queries[t, c] =
+                (projections[row, start + c] + biases[start + c]) * scale;
+            keys[t, c] = projections[row, features + start + c] +
+                         biases[features + start + c];
+            values[t, c] = projections[row, 2 * features + start + c] +
+                           biases[2 * features + start + c];
+          }
+
+        Math::Matrix<float> scores{Math::dotTB(queries, keys, false)};
+        for (size_t t{}; t < steps; ++t) {
+          float *score{&scores[t, 0]};
+          const float max{*std::max_element(score, score + steps)};
+          float sum{};
+          for (size_t k{}; k < steps; ++k) {
+            score[k] = std::exp(score[k] - max);
+            sum += score[k];
+          }
+          for (size_t k{}; k < steps; ++k)
+            score[k] /= sum;
+        }
+
+        const Math::Matrix<float> attention{
+            Math::dot(scores, values, false, true)};
+        for (size_t t{}; t < steps; ++t)
+          std::copy_n(&attention[t, 0], headSize,
+                      &concatenated[batch * steps + t, start]);
+      });
+
+  Math::Matrix<float> output{
+      Math::dotTB(concatenated, layer.outputWeights())};
+  for (size_t i{}; i < output.rows(); ++i)
+    for (size_t j{}; j < features; ++j)
+      output[i, j] += layer.outputBiases()[j];
+  output.reshape(batches, steps * features);
+  return output;
+}
+
+void benchmarkAttention() {
+  constexpr size_t batchSize{8};
+  constexpr size_t features{64};
+  constexpr size_t heads{4};
+  constexpr size_t repeats{3};
+  constexpr std::array<size_t, 4> sequenceLengths{128, 256, 512, 1024};
+
+  std::cout << "\nSelf-attention forward time (ms), batch size " << batchSize
+            << ", " << features << " features, " << heads << " heads\n";
+  std::cout << "Timesteps\tNaive\t\tTiled\t\tSpeedup\t\tNaive scores "
+               "(KiB per head)\n";
+  for (size_t steps : sequenceLengths) {
+    const ANN::Layers::MultiHeadAttention layer{features, heads,
+                                                ANN::WeightInit::Xavier};
+    const Math::Matrix<float> inputs{
+        batchSize, steps * features,
+        []() -> float { return static_cast<float>(Math::Random::getNormal()); }};
+
+    Utils::Timer timer{};
+    for (size_t i{}; i < repeats; ++i)
+      naiveAttention(layer, inputs, features);
+    const double naive{timer.elapsed() * 1000 / repeats};
+
+    timer.reset();
+    for (size_t i{}; i < repeats; ++i)
+      layer.predict(inputs);
+    const double tiled{timer.elapsed() * 1000 / repeats};
+
+    std::cout << steps << "\t\t" << std::fixed << std::setprecision(1)
+              << naive << "\t\t" << tiled << "\t\t" << std::setprecision(2)
+              << naive / tiled << "x\t\t" << steps * steps * sizeof(float) / 1024
+              << std::endl;
+  }
+}
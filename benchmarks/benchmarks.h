@@ -0,0 +1,36 @@
+#pragma once
+
+// Each benchmark prints its own results to std::cout.
+// Data paths are relative, so benchmarks should be ran from the repository root
+
+// Trains a convolutional network and the equivalent dense network on MNIST,
+// and compares training time and test accuracy
+void benchmarkConv();
+
+// Measures LSTM and GRU forward + backward throughput over a grid of sequence
+// lengths and hidden sizes (no data files needed)
+void benchmarkRecurrent();
+
+// Compares MultiHeadAttention's tiled forward pass against a naive one that
+// materializes the full score matrix, over a range of sequence lengths
+void benchmarkAttention();
+
+// Trains the same MNIST network with SGD, LARS, Adam and LAMB over a range of
+// batch sizes, and compares test accuracy after a fixed number of epochs
+void benchmarkLargeBatch();
+
+// Compares the fused Adam update against separate per-item passes, and times
+// the fused update of every optimizer (no data files needed)
+void benchmarkOptimizers();
+
+// Compares the online softmax kernel against three passes over every row, over
+// a range of class counts (no data files needed)
+void benchmarkSoftmax();
+
+// Times a training step of a large output layer with the full softmax loss
+// against sampled softmax, over a range of class counts (no data files needed)
+void benchmarkSampledSoftmax();
+
+// Times a training epoch of small and medium MLPs with a range of data-parallel
+// replica counts (no data files needed)
+void benchmarkDataParallel();
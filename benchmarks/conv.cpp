@@ -0,0 +1,44 @@
+#include "benchmarks.h"
+
+#include "ann/modelLoader.h"
+#include "loaders/mnist.h"
+#include "utils/timer.h"
+
+#include <array>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+void benchmarkConv() {
+  auto loader{std::make_unique<Loaders::MNist>(
+      "data/train-labels-idx1-ubyte", "data/train-images-idx3-ubyte",
+      "data/t10k-labels-idx1-ubyte", "data/t10k-images-idx3-ubyte")};
+  std::array<Loaders::MNist::DataPair, 2> data{loader->loadData()};
+
+  const auto &[trainingLabels, trainingImages]{data[0]};
+  const auto &[testingLabels, testingImages]{data[1]};
+
+  // Both models share the same training configuration, and differ only in
+  // their first layer (dense on the raw pixels vs conv2d)
+  constexpr std::array models{"mnist.model", "mnist-conv.model"};
+  std::array<double, models.size()> trainTimes{};
+  std::array<float, models.size()> accuracies{};
+
+  for (size_t i{}; i < models.size(); ++i) {
+    std::cout << "\nTraining " << models[i] << ":\n";
+    auto model{ANN::ModelLoader::loadFeedForward(models[i])};
+
+    Utils::Timer timer{};
+    model.train(trainingImages, trainingLabels);
+    trainTimes[i] = timer.elapsed();
+
+    model.evaluate(testingImages, testingLabels);
+    accuracies[i] = model.calculateAccuracy();
+  }
+
+  std::cout << "\nModel\t\t\tTrain time\tTest accuracy\n";
+  for (size_t i{}; i < models.size(); ++i)
+    std::cout << std::left << std::setw(24) << models[i] << std::fixed
+              << std::setprecision(2) << trainTimes[i] << "s\t\t"
+              << std::setprecision(4) << accuracies[i] << '\n';
+}
@@ -0,0 +1,61 @@
+#include "benchmarks.h"
+
+#include "ann/feedForwardModel.h"
+#include "ann/modelDescriptors.h"
+#include "math/matrix.h"
+#include "math/random.h"
+#include "math/vector.h"
+#include "utils/timer.h"
+
+#include <array>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+void benchmarkDataParallel() {
+  constexpr size_t samples{16384};
+  constexpr size_t features{64};
+  constexpr unsigned int classes{10};
+  constexpr size_t batchSize{256};
+  constexpr std::array<unsigned int, 3> hiddenSizes{32, 128, 512};
+  constexpr std::array<size_t, 4> replicaCounts{1, 2, 4, 8};
+
+  const Math::Matrix<float> inputs{samples, features, []() -> float {
+                                     return static_cast<float>(
+                                         Math::Random::getNormal());
+                                   }};
+  Math::Vector<uint16_t> labels{samples};
+  for (size_t i{}; i < samples; ++i)
+    labels[i] = static_cast<uint16_t>(Math::Random::getInt(0, classes - 1));
+
+  std::cout << "\nTraining epoch time (ms) of a 2 hidden layer MLP, "
+            << samples << " samples, batch size " << batchSize << ", "
+            << std::thread::hardware_concurrency() << " hardware threads\n";
+  std::cout << "Hidden\t\tReplicas\tTime\t\tSpeedup\n";
+  for (unsigned int hidden : hiddenSizes) {
+    double single{};
+    for (size_t replicas : replicaCounts) {
+      ANN::FeedForwardTrainingDescriptor training{
+          ANN::CategoricalCrossEntropySoftmaxLoss{}, ANN::Adam{}, batchSize, 1,
+          0, false, false};
+      training.dataParallelReplicas = replicas;
+      ANN::FeedForwardModel model{
+          ANN::FeedForwardModelDescriptor{
+              features,
+              {ANN::Dense{hidden}, ANN::ReLU{}, ANN::Dense{hidden},
+               ANN::ReLU{}, ANN::Dense{classes}}},
+          training};
+
+      Utils::Timer timer{};
+      model.train(inputs, labels);
+      const double time{timer.elapsed() * 1e3};
+      if (replicas == 1)
+        single = time;
+
+      std::cout << hidden << "\t\t" << replicas << "\t\t" << std::fixed
+                << std::setprecision(2) << time << "\t\t" << single / time
+                << "x" << std::defaultfloat << std::endl;
+    }
+  }
+}
@@ -0,0 +1,92 @@
+#include "benchmarks.h"
+
+#include "ann/feedForwardModel.h"
+#include "ann/modelDescriptors.h"
+#include "loaders/mnist.h"
+#include "utils/timer.h"
+
+#include <array>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string_view>
+
+void benchmarkLargeBatch() {
+  auto loader{std::make_unique<Loaders::MNist>(
+      "data/train-labels-idx1-ubyte", "data/train-images-idx3-ubyte",
+      "data/t10k-labels-idx1-ubyte", "data/t10k-images-idx3-ubyte")};
+  std::array<Loaders::MNist::DataPair, 2> data{loader->loadData()};
+
+  const auto &[trainingLabels, trainingImages]{data[0]};
+  const auto &[testingLabels, testingImages]{data[1]};
+
+  constexpr std::array<size_t, 4> batchSizes{32, 256, 1024, 4096};
+  constexpr size_t baseBatchSize{batchSizes.front()};
+  constexpr size_t epochs{3};
+
+  // Learning rates grow with sqrt(batch size / base batch size) for every
+  // optimizer, so only the layer-wise ones are expected to keep up
+  struct Candidate {
+    std::string_view name;
+    ANN::OptimizerDescriptor (*optimizer)(float scale);
+  };
+  constexpr std::array<Candidate, 4> candidates{{
+      {"SGD (momentum)",
+       [](float scale) -> ANN::OptimizerDescriptor {
+         return ANN::SGD{.learningRate = 5e-2f * scale, .momentum = 0.9f};
+       }},
+      {"LARS",
+       [](float scale) -> ANN::OptimizerDescriptor {
+         return ANN::LARS{.learningRate = 5.0f * scale,
+                          .weightDecay = 1e-4f};
+       }},
+      {"Adam",
+       [](float scale) -> ANN::OptimizerDescriptor {
+         return ANN::Adam{.learningRate = 1e-3f * scale};
+       }},
+      {"LAMB",
+       [](float scale) -> ANN::OptimizerDescriptor {
+         return ANN::LAMB{.learningRate = 1e-2f * scale};
+       }},
+  }};
+
+  std::cout << "\nTest accuracy after " << epochs
+            << " epochs (train time) by batch size\n"
+            << std::left << std::setw(16) << "Optimizer";
+  for (size_t batchSize : batchSizes)
+    std::cout << std::setw(20) << batchSize;
+  std::cout << '\n';
+
+  for (const auto &candidate : candidates) {
+    std::cout << std::left << std::setw(16) << candidate.name << std::flush;
+    for (size_t batchSize : batchSizes) {
+      const float scale{static_cast<float>(
+          std::sqrt(static_cast<double>(batchSize) / baseBatchSize))};
+
+      ANN::FeedForwardModel model{
+          ANN::FeedForwardModelDescriptor{
+              784,
+              {ANN::Dense{.neurons = 128, .initMethod = ANN::WeightInit::He},
+               ANN::ReLU{},
+               ANN::Dense{.neurons = 10, .initMethod = ANN::WeightInit::He}}},
+          ANN::FeedForwardTrainingDescriptor{
+              .loss = ANN::CategoricalCrossEntropySoftmaxLoss{},
+              .optimizer = candidate.optimizer(scale),
+              .batchSize = batchSize,
+              .epochs = epochs,
+              .trainValidationRate = 0,
+              .verbose = false}};
+
+      Utils::Timer timer{};
+      model.train(trainingImages, trainingLabels);
+      const double trainTime{timer.elapsed()};
+
+      model.evaluate(testingImages, testingLabels);
+      std::cout << std::fixed << std::setprecision(4)
+                << model.calculateAccuracy() << " (" << std::setprecision(1)
+                << trainTime << "s)" << std::setw(6) << "" << std::flush;
+    }
+    std::cout << '\n';
+  }
+}
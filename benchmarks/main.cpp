@@ -0,0 +1,59 @@
+#include "benchmarks.h"
+
+#include <iostream>
+#include <stdexcept>
+
+int main() {
+  try {
+    // 0 - conv vs dense
+    // 1 - recurrent layers throughput
+    // 2 - tiled vs naive attention
+    // 3 - fused optimizer updates
+    // 4 - convergence vs batch size
+    // 5 - online vs three-pass softmax
+    // 6 - full vs sampled softmax training
+    // 7 - data-parallel training scaling
+    int mode{};
+    std::cout << "Which benchmark to run? (0 - conv vs dense on mnist, 1 - "
+                 "recurrent layers throughput, 2 - tiled vs naive "
+                 "attention, 3 - fused optimizer updates, 4 - convergence vs "
+                 "batch size on mnist, 5 - online vs three-pass softmax, 6 - "
+                 "full vs sampled softmax training, 7 - data-parallel "
+                 "training scaling)\n";
+    std::cin >> mode;
+    switch (mode) {
+    case 0:
+      benchmarkConv();
+      break;
+    case 1:
+      benchmarkRecurrent();
+      break;
+    case 2:
+      benchmarkAttention();
+      break;
+    case 3:
+      benchmarkOptimizers();
+      break;
+    case 4:
+      benchmarkLargeBatch();
+      break;
+    case 5:
+      benchmarkSoftmax();
+      break;
+    case 6:
+      benchmarkSampledSoftmax();
+      break;
+    case 7:
+      benchmarkDataParallel();
+      break;
+    default:
+      std::cout << "I expected better of you.\n";
+    }
+  } catch (std::runtime_error &e) {
+    std::cout << "An error occured: " << e.what() << '\n';
+  } catch (...) {
+    std::cout << "An unknown error occured\n";
+  }
+
+  return 0;
+}
@@ -0,0 +1,110 @@
+#include "benchmarks.h"
+
+#include "ann/optimizers/adagrad.h"
+#include "ann/optimizers/adam.h"
+#include "ann/optimizers/optimizer.h"
+#include "ann/optimizers/rmsprop.h"
+#include "ann/optimizers/sgd.h"
+#include "ann/parameter.h"
+#include "math/random.h"
+#include "utils/parallel.h"
+#include "utils/timer.h"
+
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Buffers of a single dense parameter, with the optimizer state of the
+// unfused baseline
+struct ParameterBuffers {
+  explicit ParameterBuffers(size_t size)
+      : values(size), gradients(size), momentums(size), cache(size) {
+    for (size_t i{}; i < size; ++i) {
+      values[i] = static_cast<float>(Math::Random::getNormal());
+      gradients[i] = static_cast<float>(Math::Random::getNormal());
+    }
+  }
+
+  ANN::Parameter parameter() { return {values, gradients}; }
+
+  std::vector<float> values;
+  std::vector<float> gradients;
+  std::vector<float> momentums;
+  std::vector<float> cache;
+};
+
+// Adam update as separate passes over momentums, cache and values, with an
+// indirect call per item (the layout before fused optimizer kernels)
+static void unfusedAdam(ParameterBuffers &param, float learningRate) {
+  constexpr float beta1{0.9f};
+  constexpr float beta2{0.999f};
+  constexpr float epsilon{1e-7f};
+  const float momentumCorrection{1 - beta1};
+  const float cacheCorrection{1 - beta2};
+
+  Utils::Parallel::dynamicParallelFor(5, param.values.size(), [&](size_t i) {
+    param.momentums[i] =
+        beta1 * param.momentums[i] + (1 - beta1) * param.gradients[i];
+  });
+  Utils::Parallel::dynamicParallelFor(5, param.values.size(), [&](size_t i) {
+    param.cache[i] = beta2 * param.cache[i] +
+                     (1 - beta2) * param.gradients[i] * param.gradients[i];
+  });
+  Utils::Parallel::dynamicParallelFor(5, param.values.size(), [&](size_t i) {
+    param.values[i] -=
+        learningRate * (param.momentums[i] / momentumCorrection) /
+        (std::sqrt(param.cache[i] / cacheCorrection) + epsilon);
+  });
+}
+
+// Returns the average nanoseconds per parameter item of update
+template <typename Update>
+static double nsPerItem(size_t size, Update update) {
+  constexpr size_t repeats{20};
+
+  ParameterBuffers buffers{size};
+  update(buffers);
+
+  Utils::Timer timer{};
+  for (size_t i{}; i < repeats; ++i)
+    update(buffers);
+  return timer.elapsed() * 1e9 / static_cast<double>(size * repeats);
+}
+
+void benchmarkOptimizers() {
+  constexpr size_t size{1 << 22};
+
+  std::cout << "\nOptimizer update time (ns per item), " << size
+            << " items\n";
+
+  const double unfused{nsPerItem(
+      size, [](ParameterBuffers &param) { unfusedAdam(param, 1e-3f); })};
+  std::cout << std::left << std::setw(24) << "Adam (unfused passes)"
+            << std::fixed << std::setprecision(3) << unfused << '\n';
+
+  std::vector<std::pair<std::string_view,
+                        std::unique_ptr<ANN::Optimizers::Optimizer>>>
+      fused{};
+  fused.emplace_back("Adam", std::make_unique<ANN::Optimizers::Adam>());
+  fused.emplace_back("Adam (8-bit state)",
+                     std::make_unique<ANN::Optimizers::Adam>());
+  fused.back().second->setQuantizedState(true);
+  fused.emplace_back("RMSProp", std::make_unique<ANN::Optimizers::RMSProp>());
+  fused.emplace_back("Adagrad", std::make_unique<ANN::Optimizers::Adagrad>());
+  fused.emplace_back("SGD",
+                     std::make_unique<ANN::Optimizers::SGD>(1e-2f, 0, 0.9f));
+
+  for (auto &[name, optimizer] : fused) {
+    const double time{
+        nsPerItem(size, [&optimizer](ParameterBuffers &buffers) {
+          const ANN::Parameter param{buffers.parameter()};
+          optimizer->update({&param, 1});
+        })};
+    std::cout << std::left << std::setw(24) << name << std::fixed
+              << std::setprecision(3) << time << '\n';
+  }
+}
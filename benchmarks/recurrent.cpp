@@ -0,0 +1,61 @@
+#include "benchmarks.h"
+
+#include "ann/layers/gru.h"
+#include "ann/layers/lstm.h"
+#include "math/matrix.h"
+#include "math/random.h"
+#include "utils/timer.h"
+
+#include <array>
+#include <iomanip>
+#include <iostream>
+
+// Returns the average sequences per second of a full forward and backward pass
+template <typename RecurrentLayer>
+static double throughput(size_t batchSize, size_t inputSize, size_t steps,
+                         size_t units) {
+  constexpr size_t repeats{3};
+
+  RecurrentLayer layer{static_cast<unsigned int>(inputSize),
+                       static_cast<unsigned int>(units), true,
+                       ANN::WeightInit::Xavier};
+  const Math::Matrix<float> inputs{batchSize, steps * inputSize, []() -> float {
+                                     return static_cast<float>(
+                                         Math::Random::getNormal());
+                                   }};
+  const Math::Matrix<float> dvalues{batchSize, steps * units, []() -> float {
+                                      return static_cast<float>(
+                                          Math::Random::getNormal());
+                                    }};
+
+  // Warm up (allocates the layer's per-timestep buffers)
+  layer.forward(inputs);
+  layer.backward(dvalues);
+
+  Utils::Timer timer{};
+  for (size_t i{}; i < repeats; ++i) {
+    layer.forward(inputs);
+    layer.backward(dvalues);
+  }
+  return static_cast<double>(batchSize * repeats) / timer.elapsed();
+}
+
+void benchmarkRecurrent() {
+  constexpr size_t batchSize{32};
+  constexpr size_t inputSize{32};
+  constexpr std::array<size_t, 3> sequenceLengths{16, 64, 128};
+  constexpr std::array<size_t, 3> hiddenSizes{32, 64, 128};
+
+  std::cout << "\nForward + backward throughput (sequences/s), batch size "
+            << batchSize << ", input size " << inputSize << '\n';
+  std::cout << "Timesteps\tUnits\t\tLSTM\t\tGRU\n";
+  for (size_t steps : sequenceLengths)
+    for (size_t units : hiddenSizes) {
+      const double lstm{
+          throughput<ANN::Layers::LSTM>(batchSize, inputSize, steps, units)};
+      const double gru{
+          throughput<ANN::Layers::GRU>(batchSize, inputSize, steps, units)};
+      std::cout << steps << "\t\t" << units << "\t\t" << std::fixed
+                << std::setprecision(1) << lstm << "\t\t" << gru << std::endl;
+    }
+}
@@ -0,0 +1,73 @@
+#include "benchmarks.h"
+
+#include "ann/layers/dense.h"
+#include "ann/loss/categoricalSoftmax.h"
+#include "ann/loss/sampledSoftmax.h"
+#include "ann/optimizers/adam.h"
+#include "math/matrix.h"
+#include "math/random.h"
+#include "math/vector.h"
+#include "utils/timer.h"
+
+#include <array>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+
+void benchmarkSampledSoftmax() {
+  constexpr size_t batchSize{64};
+  constexpr size_t features{128};
+  constexpr size_t samples{64};
+  constexpr size_t steps{10};
+  constexpr std::array<size_t, 3> classCounts{1000, 10000, 100000};
+
+  const Math::Matrix<float> inputs{batchSize, features, []() -> float {
+                                     return static_cast<float>(
+                                         Math::Random::getNormal());
+                                   }};
+
+  std::cout << "\nOutput layer training step time (ms), batch size "
+            << batchSize << ", " << features << " features, " << samples
+            << " sampled classes\n";
+  std::cout << "Classes\t\tFull\t\tSampled\t\tSpeedup\n";
+  for (size_t classes : classCounts) {
+    Math::Vector<uint32_t> correct{batchSize};
+    for (size_t i{}; i < batchSize; ++i)
+      correct[i] = static_cast<uint32_t>(
+          Math::Random::get(0, static_cast<double>(classes - 1)));
+
+    // A single step of the output layer: forward, loss, backward and update
+    ANN::Layers::Dense fullLayer{features, static_cast<unsigned int>(classes)};
+    ANN::Loss::CategoricalSoftmax fullLoss{};
+    ANN::Optimizers::Adam fullOptimizer{};
+
+    Utils::Timer timer{};
+    for (size_t i{}; i < steps; ++i) {
+      fullLoss.forward(fullLayer.forward(inputs), correct);
+      fullLayer.backward(fullLoss.backward());
+      fullOptimizer.preUpdate();
+      fullOptimizer.update(fullLayer.parameters());
+      fullOptimizer.postUpdate();
+    }
+    const double full{timer.elapsed() * 1e3 / steps};
+
+    ANN::Layers::Dense sampledLayer{features,
+                                    static_cast<unsigned int>(classes)};
+    ANN::Loss::SampledSoftmax sampledLoss{samples, true};
+    ANN::Optimizers::Adam sampledOptimizer{};
+
+    timer.reset();
+    for (size_t i{}; i < steps; ++i) {
+      sampledLoss.forward(sampledLayer, inputs, correct);
+      sampledLayer.backwardSampled(sampledLoss.backwardSampled());
+      sampledOptimizer.preUpdate();
+      sampledOptimizer.update(sampledLayer.parameters());
+      sampledOptimizer.postUpdate();
+    }
+    const double sampled{timer.elapsed() * 1e3 / steps};
+
+    std::cout << classes << "\t\t" << std::fixed << std::setprecision(2)
+              << full << "\t\t" << sampled << "\t\t" << full / sampled << "x"
+              << std::defaultfloat << std::endl;
+  }
+}
@@ -0,0 +1,75 @@
+#include "benchmarks.h"
+
+#include "ann/activations/softmax.h"
+#include "math/matrix.h"
+#include "math/random.h"
+#include "utils/parallel.h"
+#include "utils/timer.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+// Softmax as three passes over every row (max, exponentiate and sum,
+// normalize), the layout before the shared online kernel
+static Math::Matrix<float> threePassSoftmax(const Math::Matrix<float> &inputs) {
+  Math::Matrix<float> output{inputs.rows(), inputs.cols()};
+
+  Utils::Parallel::dynamicParallelFor(
+      55 * inputs.cols(), inputs.rows(), [&](size_t batch) {
+        const float *in{&inputs[batch, 0]};
+        float *out{&output[batch, 0]};
+        const float max{*std::max_element(in, in + inputs.cols())};
+        float sum{};
+        for (size_t i{}; i < inputs.cols(); ++i) {
+          out[i] = std::exp(in[i] - max);
+          sum += out[i];
+        }
+        for (size_t i{}; i < inputs.cols(); ++i)
+          out[i] /= sum;
+      });
+
+  return output;
+}
+
+void benchmarkSoftmax() {
+  // Items per benchmarked batch, split into rows of every class count
+  constexpr size_t items{1 << 22};
+  constexpr size_t repeats{10};
+  constexpr std::array<size_t, 5> classCounts{10, 100, 1000, 10000, 100000};
+
+  std::cout << "\nSoftmax forward time (ns per item), " << items
+            << " items per batch\n";
+  std::cout << "Classes\t\tThree-pass\tOnline\t\tSpeedup\t\tMax difference\n";
+  for (size_t classes : classCounts) {
+    const Math::Matrix<float> inputs{items / classes, classes, []() -> float {
+                                       return static_cast<float>(
+                                           4 * Math::Random::getNormal());
+                                     }};
+    ANN::Activation::Softmax layer{};
+
+    Utils::Timer timer{};
+    Math::Matrix<float> expected{};
+    for (size_t i{}; i < repeats; ++i)
+      expected = threePassSoftmax(inputs);
+    const double threePass{timer.elapsed() * 1e9 / (repeats * items)};
+
+    timer.reset();
+    for (size_t i{}; i < repeats; ++i)
+      layer.forward(inputs);
+    const double online{timer.elapsed() * 1e9 / (repeats * items)};
+
+    float difference{};
+    for (size_t i{}; i < inputs.rows(); ++i)
+      for (size_t j{}; j < classes; ++j)
+        difference = std::max(difference,
+                              std::abs(expected[i, j] - layer.output()[i, j]));
+
+    std::cout << classes << "\t\t" << std::fixed << std::setprecision(2)
+              << threePass << "\t\t" << online << "\t\t" << threePass / online
+              << "x\t\t" << std::scientific << std::setprecision(1)
+              << difference << std::defaultfloat << std::endl;
+  }
+}
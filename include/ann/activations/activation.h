@@ -12,6 +12,11 @@ class Activation : public Layer {
 public:
   virtual ~Activation() = default;
 
+  // Tensor passes (see Layer)
+  using Layer::backward;
+  using Layer::forward;
+  using Layer::predict;
+
   // Forward pass: stores and returns layer outputs
   // inputs dimensions - (batch_num, input_num)
   // outputs dimensions - (batch_num, neuron_num)
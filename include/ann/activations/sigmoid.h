@@ -25,6 +25,11 @@ public:
   // Move assignment
   Sigmoid &operator=(Sigmoid &&other) noexcept;
 
+  // Tensor passes (see Layer)
+  using Layer::backward;
+  using Layer::forward;
+  using Layer::predict;
+
   // Forward pass: stores and returns layer outputs
   // inputs dimensions - (batch_num, input_num)
   // outputs dimensions - (batch_num, neuron_num)
@@ -36,6 +41,9 @@ public:
   // outputs dimensions - (batch_num, neuron_num)
   virtual Math::Matrix<float>
   predict(const Math::MatrixBase<float> &inputs) const;
+  // predict() written into an existing matrix (see Layer)
+  virtual void predict(const Math::MatrixBase<float> &inputs,
+                       Math::Matrix<float> &output) const;
 
   // Backward pass: stores parameters gradients and returns input gradients
   // dvalues dimensions - (batch_num, neuron_num)
@@ -43,6 +51,14 @@ public:
   virtual const Math::Matrix<float> &
   backward(const Math::MatrixBase<float> &dvalues);
 
+  // Preallocates outputs and input gradients (see Layer)
+  virtual size_t reserve(size_t batchSize, const Math::Shape &inputShape) {
+    return reserveBuffers({&m_output, &m_dinputs}, batchSize,
+                          Math::shapeSize(inputShape));
+  }
+
+  virtual void releaseActivations() { m_output = {}; }
+
   virtual const Math::Matrix<float> &output() const { return m_output; }
   virtual const Math::Matrix<float> &dinputs() const { return m_dinputs; }
 
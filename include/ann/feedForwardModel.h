@@ -1,20 +1,30 @@
 #pragma once
 
+#include "ann/gradientAccumulator.h"
 #include "ann/modelDescriptors.h"
 #include "ann/optimizers/optimizer.h"
+#include "ann/trainingLog.h"
 #include "layer.h"
 
 #include "ann/loss/MAE.h"
 #include "ann/loss/MSE.h"
 #include "ann/loss/binary.h"
+#include "ann/loss/binarySigmoid.h"
 #include "ann/loss/categorical.h"
 #include "ann/loss/categoricalSoftmax.h"
+#include "ann/loss/sampledSoftmax.h"
 
 #include "math/matrixBase.h"
+#include "math/tensorBase.h"
 #include "math/vector.h"
 #include "math/vectorBase.h"
 
+#include <array>
+#include <cstdint>
 #include <memory>
+#include <span>
+#include <string_view>
+#include <variant>
 #include <vector>
 
 namespace ANN {
@@ -25,8 +35,10 @@ private:
   using TrainDesc = FeedForwardTrainingDescriptor;
 
 public:
-  using LossVariant = std::variant<Loss::Categorical, Loss::CategoricalSoftmax,
-                                   Loss::Binary, Loss::MSE, Loss::MAE>;
+  using LossVariant =
+      std::variant<Loss::Categorical, Loss::CategoricalSoftmax,
+                   Loss::SampledSoftmax, Loss::Binary, Loss::BinarySigmoid,
+                   Loss::MSE, Loss::MAE>;
 
   FeedForwardModel() = default;
 
@@ -42,6 +54,8 @@ public:
   FeedForwardModel(FeedForwardModel &&) = default;
   FeedForwardModel &operator=(FeedForwardModel &&) = default;
 
+  virtual ~FeedForwardModel() = default;
+
   // Loads given model descriptor into configuration
   // Throws if passed in model has an empty layers array
   void configure(ModelDesc modelDescriptor);
@@ -60,6 +74,22 @@ public:
   // Note: Expects format to be the same format as saveParams()
   void loadParams(const std::string &path);
 
+  // Prepares the model for inference only. Every BatchNorm layer which comes
+  // right after a Dense layer is folded into it and removed, so predictions
+  // don't pay for normalization. Training a frozen model throws.
+  // Note: saveParams() of a frozen model matches the folded layers only
+  virtual void freeze();
+
+  // Preallocates the per-batch buffers of every layer and the loss for
+  // batches of up to maxBatchSize samples, so training steps run without
+  // allocating. Returns the planned bytes (the peak memory of the buffers).
+  // train() plans for its batch size, or for every data-parallel replica's
+  // share of it, and plans the evaluation workspaces of validation as well
+  // (see evaluate()). With gradient checkpointing, layers whose activations
+  // are recomputed aren't planned, since their buffers are released every step
+  // Throws if the model isn't loaded
+  virtual size_t planMemory(size_t maxBatchSize);
+
   // Train network based on given inputs
   // inputs dims - (X, input_num)
   // correct dims - (X, output_num)
@@ -76,26 +106,42 @@ public:
   // correct dims - (X)
   // logPath - path to log file to be created
   // X / batch_size = steps per epoch
-  // throws if loss isn't categorical cross-entropy
+  // throws if loss isn't categorical cross-entropy, or if it's sampled and the
+  // last layer isn't Dense
   void train(const Math::MatrixBase<float> &inputs,
              const Math::VectorBase<float> &correct,
              const std::string &logPath = "");
+  // Integer indices overloads (see Loaders::MNist), which the losses read
+  // without converting them
+  void train(const Math::MatrixBase<float> &inputs,
+             const Math::VectorBase<uint16_t> &correct,
+             const std::string &logPath = "");
+  void train(const Math::MatrixBase<float> &inputs,
+             const Math::VectorBase<uint32_t> &correct,
+             const std::string &logPath = "");
 
-  // Evaluate input batch
-  // Returns average loss per batch
-  // For more information, mean loss and accuracy (if supported) can be acquired
-  // via corresponding member functions
+  // Evaluate inputs
+  // Inputs are forwarded in chunks of evaluationChunkSize samples, spread
+  // across the current thread budget (see Utils::Parallel::threadBudget()),
+  // so the activations held don't grow with the number of inputs. Every
+  // thread has its own workspace (activation buffers and a copy of the loss),
+  // kept across calls, so repeated evaluations don't allocate
+  // Returns the loss of every input
+  // The mean loss and accuracy (if supported) over all inputs can be acquired
+  // via calculateLoss() and calculateAccuracy()
   Math::Vector<float> evaluate(const Math::MatrixBase<float> &inputs,
                                const Math::MatrixBase<float> &correct);
 
-  // Evaluate input batch for categorical loss
+  // Evaluate inputs for categorical loss (see evaluate() above)
   // correct - vector of correct indices for each batch output
-  // Returns average loss per batch
-  // For more information, mean loss and accuracy (if supported) can be acquired
-  // via corresponding member functions
+  // Returns the loss of every input
   // throws if loss isn't categorical / categoricalSoftmax
   Math::Vector<float> evaluate(const Math::MatrixBase<float> &inputs,
                                const Math::VectorBase<float> &correct);
+  Math::Vector<float> evaluate(const Math::MatrixBase<float> &inputs,
+                               const Math::VectorBase<uint16_t> &correct);
+  Math::Vector<float> evaluate(const Math::MatrixBase<float> &inputs,
+                               const Math::VectorBase<uint32_t> &correct);
 
   // Predict single input
   [[nodiscard]] Math::Vector<float>
@@ -106,28 +152,125 @@ public:
 
   // Gives current saved loss in the model. Puts it into given pointers.
   // If either of them are null pointers, loss for the corresponding one won't
-  // be calculated.
+  // be calculated. The data loss is the mean over the last evaluate() (which
+  // training validation runs), or over the training epoch so far
   void calculateLoss(float *dataLoss, float *regularizationLoss = {}) const;
 
-  // Get current saved accuracy (if exists).
+  // Get current saved accuracy (if exists), over the same inputs as
+  // calculateLoss()'s data loss.
   // If loss class doesn't support it, returns -1
   [[nodiscard]] float calculateAccuracy() const;
 
-private:
+protected:
   // CONFIG FUNCTIONS
   // addLayer overloads (for unpacking LayerDescriptor)
-  void addLayer(Dense &, unsigned int &inputs);
-  void addLayer(Dropout &, unsigned int &inputs);
-  void addLayer(Step &, unsigned int &inputs);
-  void addLayer(ReLU &, unsigned int &inputs);
-  void addLayer(LeakyReLU &, unsigned int &inputs);
-  void addLayer(Sigmoid &, unsigned int &inputs);
-  void addLayer(Softmax &, unsigned int &inputs);
+  void addLayer(Dense &, const Math::Shape &inputShape);
+  void addLayer(Dropout &, const Math::Shape &inputShape);
+  void addLayer(Conv2D &, const Math::Shape &inputShape);
+  void addLayer(Embedding &, const Math::Shape &inputShape);
+  void addLayer(LSTM &, const Math::Shape &inputShape);
+  void addLayer(GRU &, const Math::Shape &inputShape);
+  void addLayer(MultiHeadAttention &, const Math::Shape &inputShape);
+  void addLayer(BatchNorm &, const Math::Shape &inputShape);
+  void addLayer(MaxPool2D &, const Math::Shape &inputShape);
+  void addLayer(AvgPool2D &, const Math::Shape &inputShape);
+  void addLayer(Step &, const Math::Shape &inputShape);
+  void addLayer(ReLU &, const Math::Shape &inputShape);
+  void addLayer(LeakyReLU &, const Math::Shape &inputShape);
+  void addLayer(Sigmoid &, const Math::Shape &inputShape);
+  void addLayer(Softmax &, const Math::Shape &inputShape);
+
+  // Returns (height, width, channels) of the images a spatial layer receives.
+  // Dimensions left as 0 are taken from the previous layer's image shape. For
+  // flat inputs, channels default to 1 and the image is assumed to be square.
+  // Throws if the dimensions don't match the previous layer's outputs
+  static std::array<unsigned int, 3>
+  imageShape(unsigned int height, unsigned int width, unsigned int channels,
+             const Math::Shape &inputShape, std::string_view layerName);
+
+  // Returns the features per timestep a recurrent layer receives.
+  // If inputSize is 0 it's taken from the previous layer's sequence shape, and
+  // defaults to 1 for flat inputs.
+  // Throws if it doesn't divide the previous layer's outputs
+  static unsigned int sequenceInputSize(unsigned int inputSize,
+                                        const Math::Shape &inputShape,
+                                        std::string_view layerName);
 
+  // TRAINING FUNCTIONS
+  // Forwards batchData through layers (not loss)
+  // If training = false, doesn't go through dropout layers
+  // With gradient checkpointing, training passes release the activations of
+  // every layer but the segment ends (see isRecomputed())
+  virtual void forward(const Math::MatrixBase<float> &batchData,
+                       bool training = true);
+  // Performs backward pass accross all layers, and optimizes trainable layers
+  // Inputs - matrix of gradients for the final layer in the network
+  // With gradient checkpointing, every segment's released activations are
+  // recomputed from its last checkpoint right before its backward pass
+  virtual void optimize(const Math::MatrixBase<float> &outputGradients);
+  // Backward pass of optimize(), which leaves the parameter gradients in the
+  // layers (data-parallel replicas only run this part)
+  void backward(const Math::MatrixBase<float> &outputGradients);
+  // Updates the parameters of every trainable layer in a single optimizer pass
+  // (after the backward pass, so no layer's gradients depend on the update).
+  // With gradient accumulation, the gradients are accumulated instead, and the
+  // update uses their mean at the end of the step (see m_isStepEnd). With
+  // data-parallel replicas, the update uses the mean of every replica's
+  // gradients, and the updated parameters are copied to the replicas
+  void updateParameters();
+  // Puts the parameters of every trainable layer into m_parameters
+  void collectParameters();
+  // Returns the model outputs of the last forward pass
+  virtual Math::MatrixView<float> outputs() const;
+  // Buffers of inference passes (see predictOutputs()), kept across passes so
+  // their storage is reused
+  struct InferenceWorkspace {
+    // Activation buffers the layers write their outputs into
+    std::vector<Math::Matrix<float>> buffers{};
+    // Views of every node's outputs and of a merge node's inputs (see
+    // GraphModel)
+    std::vector<Math::MatrixView<float>> values{};
+    std::vector<Math::MatrixView<float>> mergeInputs{};
+  };
+  // Returns the model outputs for inputs without storing any activations (so
+  // it may run concurrently with other workspaces), before the loss'
+  // activation (see predict()). The outputs are one of workspace's buffers,
+  // which are valid until its next pass
+  virtual Math::Matrix<float> &
+  predictOutputs(const Math::MatrixBase<float> &inputs,
+                 InferenceWorkspace &workspace) const;
+  // Preallocates workspace's buffers for inference passes of up to
+  // maxBatchSize samples. Returns the bytes reserved
+  virtual size_t reserveWorkspace(InferenceWorkspace &workspace,
+                                  size_t maxBatchSize) const;
+  // Number of layers run by training passes. With sampled softmax, the last
+  // (Dense) layer is left to the loss, which computes the sampled logits only
+  size_t trainedLayers() const;
+
+  unsigned int m_inputs{};
+  // Layer is abstract, so unique_ptr is needed
+  std::vector<std::unique_ptr<Layer>> m_layers{};
+
+  LossVariant m_loss{};
+  std::unique_ptr<Optimizers::Optimizer> m_optimizer{};
+  // Parameters of the current update (kept to reuse their storage)
+  std::vector<Parameter> m_parameters{};
+  GradientAccumulator m_accumulator{};
+  // Whether the current micro-batch ends an optimizer step
+  bool m_isStepEnd{true};
+
+  // Is model data loaded
+  bool m_isModelLoaded{false};
+  // Were layers folded for inference (see freeze())
+  bool m_isFrozen{false};
+
+private:
   // setLoss overloads (for unpacking TrainingDescriptor
   void setLoss(CategoricalCrossEntropyLoss &);
   void setLoss(CategoricalCrossEntropySoftmaxLoss &);
+  void setLoss(SampledCategoricalCrossEntropySoftmaxLoss &);
   void setLoss(BinaryCrossEntropyLoss &);
+  void setLoss(BinaryCrossEntropySigmoidLoss &);
   void setLoss(MeanSquaredErrorLoss &);
   void setLoss(MeanAbsoluteErrorLoss &);
 
@@ -136,40 +279,126 @@ private:
   void setOptimizer(AdaGrad &);
   void setOptimizer(RMSProp &);
   void setOptimizer(Adam &);
+  void setOptimizer(LAMB &);
+  void setOptimizer(LARS &);
 
-  // TRAINING FUNCTIONS
   std::vector<size_t> createBatchSequence(size_t stepNum) const;
-  // Forwards batchData through layers (not loss)
-  // If training = false, doesn't go through dropout layers
-  void forward(const Math::MatrixBase<float> &batchData, bool training = true);
-  // Performs backward pass accross all layers, and optimizes trainable layers
-  // Inputs - matrix of gradients for the final layer in the network
-  void optimize(const Math::MatrixBase<float> &outputGradients);
 
-  // Returns info about current network progression
-  std::stringstream getUpdateMsg(double epochTime, size_t currentBatch,
-                                 size_t stepNum) const;
+  // Shared implementation of the train() overloads for correct index vectors
+  template <typename Label>
+  void trainLabels(const Math::MatrixBase<float> &inputs,
+                   const Math::VectorBase<Label> &correct,
+                   const std::string &logPath);
+
+  // Builds the data-parallel replicas (if any) from the model's parameters,
+  // and plans the memory of every replica for its share of a batch (see
+  // planMemory()), and the evaluation workspaces of validationSamples samples
+  // (if any). Returns the planned bytes
+  size_t planTraining(size_t validationSamples);
+
+  // Runs the loss' forward and backward passes on the outputs of the last
+  // training forward pass of batchData, and returns the output gradients.
+  // With sampled softmax, the loss drives the last (Dense) layer as well
+  template <typename Correct>
+  Math::MatrixView<float>
+  lossGradients(const Math::MatrixBase<float> &batchData,
+                const Correct &batchCorrect);
+
+  // Training step split between the data-parallel replicas: every replica
+  // runs the forward and backward passes of its equal shard of the batch
+  // concurrently, and a single update follows (see updateParameters())
+  template <typename Correct>
+  void trainReplicas(const Math::MatrixBase<float> &batchData,
+                     const Correct &batchCorrect);
+
+  // All-reduce of the replicas' gradients - returns params with their
+  // gradients replaced by the mean of the model's and every replica's
+  // gradients (summed in m_replicaGradients)
+  std::span<const Parameter> allReduce(std::span<const Parameter> params);
+
+  // Copies the values of the given (updated) parameters of the model to the
+  // matching parameters of every replica
+  void broadcastParameters(std::span<const Parameter> params);
+
+  // Samples forwarded at once by every evaluate() thread
+  static constexpr size_t evaluationChunkSize{256};
+
+  // Shared implementation of the evaluate() overloads, for either correct
+  // index vectors or correct matrices
+  // Throws for index vectors if loss isn't categorical
+  template <typename Correct>
+  Math::Vector<float> evaluateChunks(const Math::MatrixBase<float> &inputs,
+                                     const Correct &correct);
+
+  // Returns a new loss of the same kind as m_loss, for a single evaluation
+  // thread. Sampled softmax gives a plain CategoricalSoftmax (its full
+  // forward pass)
+  LossVariant evaluationLoss() const;
+
+  // Workspace of a single evaluate() thread
+  struct EvaluationWorkspace {
+    InferenceWorkspace inference{};
+    LossVariant loss{};
+    // Index of the m_loss alternative loss was built for
+    size_t lossKind{std::variant_npos};
+  };
+
+  // Number of threads evaluating the given number of samples: the current
+  // thread's budget, so evaluating inside a parallel loop (e.g. a
+  // data-parallel replica) doesn't oversubscribe the cores, up to a thread per
+  // chunk
+  static size_t evaluationThreads(size_t samples);
+
+  // Whether m_evaluation holds workspaces for the given number of threads,
+  // with losses of m_loss' kind
+  bool isEvaluationPlanned(size_t threads) const;
+
+  // Builds the workspaces of the given number of evaluation threads (keeping
+  // existing ones whose loss is still of m_loss' kind), and preallocates them
+  // for chunks of evaluationChunkSize samples. Returns the planned bytes
+  size_t planEvaluation(size_t threads);
+
+  // Layers per gradient checkpointing segment (~sqrt(layer_num))
+  size_t segmentSize() const;
+
+  // Whether gradient checkpointing releases the activations of the given
+  // layer after the forward pass. True for recomputable layers which don't end
+  // a segment, except in the last segment (which is needed right away)
+  bool isRecomputed(size_t layer) const;
+
+  // Returns info about current network progression, from the loss' running
+  // metrics over the epoch so far (see Loss::runningMean())
+  TrainingLog::Update progress(double epochTime, size_t currentBatch,
+                               size_t stepNum) const;
+
+  // Transforms given float one-hot encoded matrix into index vector
+  Math::Vector<uint32_t> argmaxLabels(const Math::MatrixBase<float> &m);
 
-  // Formats given time into string with units - ns, us, ms, or s
-  static std::string formatTime(double seconds);
-
-  // Transforms given float one-hot encoded matrix into index matrix
-  Math::Vector<float> argmaxFloat(const Math::MatrixBase<float> &m);
-
-  unsigned int m_inputs{};
-  // Layer is abstract, so unique_ptr is needed
-  std::vector<std::unique_ptr<Layer>> m_layers{};
-
-  LossVariant m_loss{};
-  std::unique_ptr<Optimizers::Optimizer> m_optimizer{};
   size_t m_batchSize{};
   size_t m_epochs{};
   float m_trainValidationRate{};
   bool m_shuffleBatches{};
   bool m_verbose{};
+  size_t m_logInterval{100};
+  bool m_gradientCheckpointing{};
+  size_t m_gradientAccumulationSteps{1};
+  size_t m_dataParallelReplicas{1};
+
+  // Descriptor of the model's layers, which data-parallel replicas are built
+  // from
+  ModelDesc m_modelDescriptor{};
+  // Data-parallel replicas other than the model itself (built by
+  // planTraining()). Only their layers and loss are used
+  std::vector<std::unique_ptr<FeedForwardModel>> m_replicas{};
+  // Shared buffers of the replicas' gradients (see allReduce())
+  GradientAccumulator m_replicaGradients{};
+
+  // Workspaces of the evaluate() threads (see planEvaluation())
+  std::vector<EvaluationWorkspace> m_evaluation{};
+
+  // Inputs of the last training forward pass (recomputation starts from them)
+  Math::MatrixView<float> m_batchInputs{};
 
-  // Is model data loaded
-  bool m_isModelLoaded{false};
   // Is training data loaded
   bool m_isTrainLoaded{false};
 };
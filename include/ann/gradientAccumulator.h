@@ -0,0 +1,47 @@
+#pragma once
+
+#include "parameter.h"
+
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace ANN {
+// Sums the parameter gradients of several micro-batches, so a single optimizer
+// update covers all of them (gradient accumulation). Sparse gradients stay
+// sparse: only the union of the rows touched by the micro-batches is kept.
+class GradientAccumulator {
+public:
+  // Adds the gradients of params. Every call until the next mean() must pass
+  // the same parameters, in the same order
+  void add(std::span<const Parameter> params);
+
+  // Returns params with their gradients replaced by the mean of the added
+  // gradients, and starts a new accumulation. The returned handles are valid
+  // until the next add()
+  std::span<const Parameter> mean(std::span<const Parameter> params);
+
+  // Number of micro-batches added since the last mean()
+  size_t count() const { return m_count; }
+
+private:
+  static constexpr size_t noSlot{std::numeric_limits<size_t>::max()};
+
+  // Accumulated gradients of a single parameter
+  struct Buffer {
+    std::vector<float> gradients{};
+    // Sparse parameters only - touched rows, and the row of gradients each
+    // parameter row is accumulated in (noSlot if untouched)
+    std::vector<size_t> rows{};
+    std::vector<size_t> slots{};
+  };
+
+  // Adds sparse param's gradients into buffer, appending rows it didn't have
+  static void addRows(const Parameter &param, Buffer &buffer);
+
+  std::vector<Buffer> m_buffers{};
+  // Handles returned by mean() (kept to reuse their storage)
+  std::vector<Parameter> m_mean{};
+  size_t m_count{};
+};
+} // namespace ANN
@@ -0,0 +1,138 @@
+#pragma once
+
+#include "ann/feedForwardModel.h"
+#include "ann/modelDescriptors.h"
+
+#include "math/matrix.h"
+#include "math/matrixBase.h"
+
+#include <limits>
+#include <vector>
+
+namespace ANN {
+// Feed forward model over a directed acyclic graph of layers, e.g. residual
+// networks with skip edges. Nodes are either layers or merges (see
+// GraphModelDescriptor), and run in a topological order computed once on
+// configuration. Training, evaluation and saving behave like FeedForwardModel's
+// (layers are saved in the scheduled order).
+//
+// Buffers are assigned by liveness analysis over the schedule: a buffer is
+// recycled as soon as the last node reading it has run, so memory tracks the
+// largest live set instead of the node count. Inference keeps every activation
+// in such buffers, which layers and merges write into in place, and evaluate()
+// keeps them across calls (see FeedForwardModel::evaluate()). During training the layers keep their own outputs (they're
+// needed by the backward pass), and the gradients of node outputs are pooled
+// instead: outputs read by a single layer pass its input gradients through as
+// views, and only outputs read several times or by Concat merges are
+// accumulated into pooled buffers.
+class GraphModel : public FeedForwardModel {
+private:
+  using ModelDesc = GraphModelDescriptor;
+  using TrainDesc = FeedForwardTrainingDescriptor;
+
+public:
+  GraphModel() = default;
+
+  GraphModel(ModelDesc modelDescriptor);
+
+  GraphModel(ModelDesc modelDescriptor, TrainDesc trainingDescriptor);
+
+  // Loads given model descriptor into configuration
+  // Throws if the nodes are empty, reference missing nodes, form a cycle, or
+  // don't all lead to the last node
+  void configure(ModelDesc modelDescriptor);
+
+  // Loads given training descriptor into configuration
+  // Throws if the loss is sampled softmax
+  void configure(TrainDesc trainingDescriptor);
+
+  // Loads given descriptors into configuration
+  void configure(ModelDesc modelDescriptor, TrainDesc trainingDescriptor);
+
+  // Prepares the model for inference only. Every BatchNorm node whose input is
+  // a Dense node read by nothing else is folded into it and removed (see
+  // FeedForwardModel::freeze())
+  virtual void freeze();
+
+  // Also preallocates merge outputs and pooled gradients (see
+  // FeedForwardModel::planMemory())
+  virtual size_t planMemory(size_t maxBatchSize);
+
+  // Number of activation buffers inference keeps at once
+  size_t activationBuffers() const { return m_activationBuffers; }
+  // Number of pooled gradient buffers of the backward pass
+  size_t gradientBuffers() const { return m_gradients.size(); }
+
+protected:
+  virtual void forward(const Math::MatrixBase<float> &batchData,
+                       bool training = true);
+  virtual void optimize(const Math::MatrixBase<float> &outputGradients);
+  virtual Math::MatrixView<float> outputs() const;
+  virtual Math::Matrix<float> &
+  predictOutputs(const Math::MatrixBase<float> &inputs,
+                 InferenceWorkspace &workspace) const;
+  // Reserves every activation buffer for the widest value it's assigned
+  virtual size_t reserveWorkspace(InferenceWorkspace &workspace,
+                                  size_t maxBatchSize) const;
+
+private:
+  static constexpr size_t noBuffer{std::numeric_limits<size_t>::max()};
+
+  // Scheduled node. Values are node outputs: value 0 is the model inputs and
+  // value i + 1 is the outputs of the i-th scheduled node.
+  struct Node {
+    Merge merge{Merge::None};
+    // Index in m_layers (layer nodes only)
+    size_t layer{};
+    // Values the node receives
+    std::vector<size_t> inputs{};
+  };
+
+  // Assigns activation and gradient buffers to values by liveness analysis
+  // over the schedule
+  void planBuffers();
+
+  // Whether node is a dropout layer, which passes its inputs through when not
+  // training
+  bool isDropout(const Node &node) const;
+
+  // Writes node's merge of inputs into output (reallocated only if its
+  // dimensions change)
+  static void merge(const Node &node,
+                    const std::vector<Math::MatrixView<float>> &inputs,
+                    Math::Matrix<float> &output);
+
+  // Adds dvalues' columns [colOffset, colOffset + value cols) to the gradients
+  // of value, or passes them through if its gradients aren't pooled
+  void accumulate(size_t value, const Math::MatrixBase<float> &dvalues,
+                  size_t colOffset = 0);
+
+  // Nodes in topological order
+  std::vector<Node> m_nodes{};
+  // Per-sample size of every value
+  std::vector<size_t> m_valueSizes{};
+
+  // Per value buffer of predict(), noBuffer for the model inputs and values
+  // passed through dropout nodes
+  std::vector<size_t> m_activationBuffer{};
+  size_t m_activationBuffers{};
+  // Value a dropout node passes through when not training (the value itself
+  // for every other node)
+  std::vector<size_t> m_inferenceValue{};
+
+  // Per value buffer in m_gradients, noBuffer for gradients passed as views
+  std::vector<size_t> m_gradientBuffer{};
+  std::vector<Math::Matrix<float>> m_gradients{};
+  // Contributions to every value's gradients so far in the current backward
+  // pass
+  std::vector<size_t> m_contributions{};
+
+  // Outputs of merge nodes in the last forward pass (by node)
+  std::vector<Math::Matrix<float>> m_mergeOutputs{};
+  // Current views of every value and its gradients
+  std::vector<Math::MatrixView<float>> m_values{};
+  std::vector<Math::MatrixView<float>> m_dvalues{};
+  // Reused input views of merge nodes
+  std::vector<Math::MatrixView<float>> m_mergeInputs{};
+};
+} // namespace ANN
@@ -1,14 +1,35 @@
 #pragma once
 
+#include "parameter.h"
+
 #include "math/matrix.h"
+#include "math/tensor.h"
 
+#include <initializer_list>
 #include <string_view>
+#include <vector>
 
 namespace ANN {
 // Base layer class. Inherited by all layers and activations
 class Layer {
 public:
-  enum class Type { Dense, Dropout, Step, ReLU, LeakyReLU, Sigmoid, Softmax };
+  enum class Type {
+    Dense,
+    Dropout,
+    Conv2D,
+    Embedding,
+    LSTM,
+    GRU,
+    MultiHeadAttention,
+    BatchNorm,
+    MaxPool2D,
+    AvgPool2D,
+    Step,
+    ReLU,
+    LeakyReLU,
+    Sigmoid,
+    Softmax
+  };
 
   virtual ~Layer() = default;
 
@@ -24,17 +45,77 @@ public:
   virtual Math::Matrix<float>
   predict(const Math::MatrixBase<float> &inputs) const = 0;
 
+  // predict() written into an existing matrix, which is resized only if its
+  // dimensions don't match, so reusing it across calls avoids allocations.
+  // Layers without their own overload move predict()'s result into it
+  virtual void predict(const Math::MatrixBase<float> &inputs,
+                       Math::Matrix<float> &output) const;
+
   // Backward pass: stores parameters gradients and returns input gradients
   // dvalues dimensions - (batch_num, neuron_num)
   // outputs dimensions - (batch_num, input_num)
   virtual const Math::Matrix<float> &
   backward(const Math::MatrixBase<float> &dvalues) = 0;
 
+  // Switches between training and inference behavior of forward() (e.g.
+  // batch statistics vs running statistics). Layers which behave the same in
+  // both keep the default
+  virtual void setTraining(bool) {}
+
+  // Per-sample shape of the layer's outputs for the given per-sample input
+  // shape (e.g. (height, width, channels) for images). Shape preserving layers
+  // keep the default. Throws if the layer can't receive inputs of that shape
+  virtual Math::Shape outputShape(const Math::Shape &inputShape) const {
+    return inputShape;
+  }
+
+  // Tensor passes. Tensors are viewed as (batch_num, rest) matrices and
+  // outputs are viewed back in their per-sample shape, so no data is copied.
+  // Derived classes bring them into scope with using-declarations.
+
+  // Forward pass: stores layer outputs and returns a view of them
+  // inputs dimensions - (batch_num, ...input_shape), must be contiguous
+  // outputs dimensions - (batch_num, ...outputShape(input_shape))
+  Math::TensorView<float> forward(const Math::TensorView<float> &inputs);
+
+  // Forward pass without storing layer outputs
+  // inputs dimensions - (batch_num, ...input_shape)
+  // outputs dimensions - (batch_num, ...outputShape(input_shape))
+  Math::Tensor<float> predict(const Math::TensorView<float> &inputs) const;
+
+  // Backward pass: returns a view of the input gradients
+  // dvalues dimensions - (batch_num, ...outputShape(input_shape))
+  // outputs dimensions - (batch_num, ...input_shape) of the last tensor
+  // forward pass
+  Math::TensorView<float> backward(const Math::TensorView<float> &dvalues);
+
+  // Preallocates the buffers of forward() and backward() for batches of up to
+  // batchSize samples of the given per-sample input shape, so smaller batches
+  // run without allocating. Returns the bytes reserved. Layers without
+  // per-batch buffers keep the default
+  virtual size_t reserve(size_t, const Math::Shape &) { return 0; }
+
+  // Frees the buffers forward() keeps for backward() (e.g. outputs), which
+  // the next forward() recreates. Used by gradient checkpointing, which then
+  // recomputes them before the backward pass
+  virtual void releaseActivations() {}
+
+  // Whether forward() can run again on the same inputs without changing its
+  // results or the layer's state (false e.g. for random dropout masks or
+  // running statistics), so its activations can be recomputed
+  virtual bool isRecomputable() const { return true; }
+
   // Saves learnable parameters of the layers into file in its current position
   virtual void saveParams(std::ofstream &) const {}
   // Loads learnable parameters of the layers from file in its current position
   virtual void loadParams(std::ifstream &) {}
 
+  // Returns handles to the layer's trainable parameters, which are passed to an
+  // optimizer. Empty for layers which aren't trainable. Gradients are only
+  // allocated by the first backward pass, so handles taken before it have
+  // empty gradients
+  virtual std::vector<Parameter> parameters() { return {}; }
+
   virtual const Math::Matrix<float> &output() const = 0;
   virtual const Math::Matrix<float> &dinputs() const = 0;
 
@@ -46,5 +127,16 @@ public:
 
   // Returns layer type (e.g. Type::Dense)
   virtual Type type() const = 0;
+
+protected:
+  // Reserves (rows, cols) floats in every given buffer, returns the bytes
+  // reserved
+  static size_t
+  reserveBuffers(std::initializer_list<Math::Matrix<float> *> buffers,
+                 size_t rows, size_t cols);
+
+private:
+  // Per-sample input shape of the last tensor forward pass
+  Math::Shape m_tensorInputShape{};
 };
 } // namespace ANN
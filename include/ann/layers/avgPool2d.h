@@ -0,0 +1,95 @@
+#pragma once
+
+#include "../layer.h"
+
+#include "math/matrix.h"
+#include "math/matrixBase.h"
+
+namespace ANN {
+namespace Layers {
+// 2D average pooling layer.
+// Images are passed flattened in (height, width, channels) order, so every
+// pooling window is reduced across all channels at once.
+class AvgPool2D : public Layer {
+public:
+  AvgPool2D() = delete;
+
+  // stride - defaults to poolSize (non-overlapping windows) if 0
+  AvgPool2D(unsigned int inputHeight, unsigned int inputWidth,
+            unsigned int channels, unsigned int poolSize,
+            unsigned int stride = 0);
+
+  // Copy constructor deleted
+  AvgPool2D(const AvgPool2D &other) = delete;
+
+  // Move constructor
+  AvgPool2D(AvgPool2D &&other) noexcept;
+
+  // Copy assignment deleted
+  AvgPool2D &operator=(const AvgPool2D &other) = delete;
+
+  // Move assignment
+  AvgPool2D &operator=(AvgPool2D &&other) noexcept;
+
+  // Tensor passes (see Layer)
+  using Layer::backward;
+  using Layer::forward;
+  using Layer::predict;
+
+  // Forward pass: stores and returns layer outputs
+  // inputs dimensions - (batch_num, input_height * input_width * channels)
+  // outputs dimensions - (batch_num, output_height * output_width * channels)
+  virtual const Math::Matrix<float> &
+  forward(const Math::MatrixBase<float> &inputs);
+
+  // Forward pass without storing layer outputs
+  // inputs dimensions - (batch_num, input_height * input_width * channels)
+  // outputs dimensions - (batch_num, output_height * output_width * channels)
+  virtual Math::Matrix<float>
+  predict(const Math::MatrixBase<float> &inputs) const;
+
+  // Backward pass: returns input gradients
+  // dvalues dimensions - (batch_num, output_height * output_width * channels)
+  // outputs dimensions - (batch_num, input_height * input_width * channels)
+  virtual const Math::Matrix<float> &
+  backward(const Math::MatrixBase<float> &dvalues);
+
+  // Per-sample output shape - (output_height, output_width, channels)
+  // Throws if inputShape's item count isn't
+  // input_height * input_width * channels
+  virtual Math::Shape outputShape(const Math::Shape &inputShape) const;
+
+  // Preallocates outputs and input gradients (see Layer)
+  virtual size_t reserve(size_t batchSize, const Math::Shape &inputShape);
+
+  virtual void releaseActivations() { m_output = {}; }
+
+  virtual const Math::Matrix<float> &output() const { return m_output; }
+  virtual const Math::Matrix<float> &dinputs() const { return m_dinputs; }
+
+  unsigned int outputHeight() const { return m_outputHeight; }
+  unsigned int outputWidth() const { return m_outputWidth; }
+  unsigned int channels() const { return m_channels; }
+
+  virtual bool isTrainable() const { return false; }
+  virtual std::string_view name() const { return "AvgPool2D"; }
+  virtual Layer::Type type() const { return Layer::Type::AvgPool2D; }
+
+private:
+  void pool(const Math::MatrixBase<float> &inputs,
+            Math::Matrix<float> &output) const;
+
+  unsigned int m_inputHeight{};
+  unsigned int m_inputWidth{};
+  unsigned int m_channels{};
+  unsigned int m_poolSize{};
+  unsigned int m_stride{};
+  unsigned int m_outputHeight{};
+  unsigned int m_outputWidth{};
+
+  Math::Matrix<float> m_output{};
+
+  Math::Matrix<float> m_dinputs{};
+};
+} // namespace Layers
+} // namespace ANN
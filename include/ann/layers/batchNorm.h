@@ -0,0 +1,134 @@
+#pragma once
+
+#include "../layer.h"
+#include "dense.h"
+
+#include "math/matrix.h"
+#include "math/matrixBase.h"
+#include "math/vector.h"
+
+namespace ANN {
+namespace Layers {
+// Batch normalization layer.
+// Every feature (column) is normalized with the mean and variance of the
+// batch during training, and with running estimates of them during inference.
+// The normalized features are then scaled and shifted by learned parameters
+// (gamma and beta).
+class BatchNorm : public Layer {
+public:
+  BatchNorm() = delete;
+
+  // features - number of inputs (and outputs)
+  // momentum - weight of the previous running statistics on every update
+  // epsilon - added to the variance to avoid division by 0
+  BatchNorm(unsigned int features, float momentum = 0.99f,
+            float epsilon = 1e-3f);
+
+  // Copy constructor deleted
+  BatchNorm(const BatchNorm &other) = delete;
+
+  // Move constructor
+  BatchNorm(BatchNorm &&other) noexcept;
+
+  // Copy assignment deleted
+  BatchNorm &operator=(const BatchNorm &other) = delete;
+
+  // Move assignment
+  BatchNorm &operator=(BatchNorm &&other) noexcept;
+
+  // Tensor passes (see Layer)
+  using Layer::backward;
+  using Layer::forward;
+  using Layer::predict;
+
+  // Forward pass: stores and returns layer outputs
+  // In training mode, normalizes with the batch statistics and updates the
+  // running ones. Otherwise acts the same as predict()
+  // inputs dimensions - (batch_num, features)
+  // outputs dimensions - (batch_num, features)
+  virtual const Math::Matrix<float> &
+  forward(const Math::MatrixBase<float> &inputs);
+
+  // Forward pass without storing layer outputs. Uses the running statistics
+  // inputs dimensions - (batch_num, features)
+  // outputs dimensions - (batch_num, features)
+  virtual Math::Matrix<float>
+  predict(const Math::MatrixBase<float> &inputs) const;
+  // predict() written into an existing matrix (see Layer)
+  virtual void predict(const Math::MatrixBase<float> &inputs,
+                       Math::Matrix<float> &output) const;
+
+  // Backward pass: stores parameters gradients and returns input gradients
+  // Expects the last forward pass to be in training mode
+  // dvalues dimensions - (batch_num, features)
+  // outputs dimensions - (batch_num, features)
+  virtual const Math::Matrix<float> &
+  backward(const Math::MatrixBase<float> &dvalues);
+
+  virtual void setTraining(bool training) { m_training = training; }
+
+  // Folds the inference-time normalization into the given Dense layer, which
+  // has to be the layer right before this one. After folding, the Dense
+  // layer's outputs are the same as this layer's predict() outputs, so this
+  // layer can be removed.
+  // Throws if the Dense layer's neuron number doesn't match the features
+  void foldInto(Dense &dense) const;
+
+  virtual void saveParams(std::ofstream &file) const;
+  virtual void loadParams(std::ifstream &file);
+
+  virtual std::vector<Parameter> parameters();
+
+  const Math::Vector<float> &gamma() const { return m_gamma; }
+  const Math::Vector<float> &beta() const { return m_beta; }
+  const Math::Vector<float> &runningMean() const { return m_runningMean; }
+  const Math::Vector<float> &runningVariance() const {
+    return m_runningVariance;
+  }
+  // Preallocates normalized inputs, outputs and input gradients (see Layer)
+  virtual size_t reserve(size_t batchSize, const Math::Shape &inputShape);
+
+  // Training passes update the running statistics, so they're never
+  // recomputed
+  virtual bool isRecomputable() const { return false; }
+
+  virtual const Math::Matrix<float> &output() const { return m_output; }
+  virtual const Math::Matrix<float> &dinputs() const { return m_dinputs; }
+
+  virtual bool isTrainable() const { return true; }
+  virtual std::string_view name() const { return "BatchNorm"; }
+  virtual Layer::Type type() const { return Layer::Type::BatchNorm; }
+
+private:
+  // Computes per-feature (scale, shift) so that inference output is
+  // inputs * scale + shift
+  std::pair<Math::Vector<float>, Math::Vector<float>> inferenceAffine() const;
+
+  // output = inputs * scale + shift, per feature
+  static void applyAffine(const Math::MatrixBase<float> &inputs,
+                          const Math::Vector<float> &scale,
+                          const Math::Vector<float> &shift,
+                          Math::Matrix<float> &output);
+
+  float m_momentum{};
+  float m_epsilon{};
+  bool m_training{true};
+
+  Math::Vector<float> m_gamma{};
+  Math::Vector<float> m_beta{};
+  Math::Vector<float> m_runningMean{};
+  Math::Vector<float> m_runningVariance{};
+
+  // Normalized inputs and inverse standard deviations of the last training
+  // forward pass (kept for backward pass)
+  Math::Matrix<float> m_normalized{};
+  Math::Vector<float> m_inverseStd{};
+  Math::Matrix<float> m_output{};
+
+  Math::Matrix<float> m_dinputs{};
+  Math::Vector<float> m_dgamma{};
+  Math::Vector<float> m_dbeta{};
+
+};
+} // namespace Layers
+} // namespace ANN
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "../layer.h"
+#include "../modelDescriptors.h"
+
+#include "math/matrix.h"
+#include "math/matrixBase.h"
+#include "math/vector.h"
+
+namespace ANN {
+namespace Layers {
+// 2D convolution layer.
+// Images are passed between layers flattened into rows, in (height, width,
+// channels) order. The convolution is computed by unfolding the input patches
+// (im2col) and multiplying them by the kernel matrix, so the output rows come
+// out in the same (height, width, filters) order with no reordering needed.
+class Conv2D : public Layer {
+public:
+  Conv2D() = delete;
+
+  // 0-init biases and outputs
+  // Uses random weight initialization as default.
+  Conv2D(unsigned int inputHeight, unsigned int inputWidth,
+         unsigned int inputChannels, unsigned int filters,
+         unsigned int kernelSize, unsigned int stride = 1,
+         unsigned int padding = 0,
+         ANN::WeightInit initMethod = ANN::WeightInit::Random);
+
+  // Copy constructor deleted
+  Conv2D(const Conv2D &other) = delete;
+
+  // Move constructor
+  Conv2D(Conv2D &&other) noexcept;
+
+  // Copy assignment deleted
+  Conv2D &operator=(const Conv2D &other) = delete;
+
+  // Move assignment
+  Conv2D &operator=(Conv2D &&other) noexcept;
+
+  // Tensor passes (see Layer)
+  using Layer::backward;
+  using Layer::forward;
+  using Layer::predict;
+
+  // Forward pass: stores and returns layer outputs
+  // inputs dimensions - (batch_num, input_height * input_width * channels)
+  // outputs dimensions - (batch_num, output_height * output_width * filters)
+  virtual const Math::Matrix<float> &
+  forward(const Math::MatrixBase<float> &inputs);
+
+  // Forward pass without storing layer outputs
+  // inputs dimensions - (batch_num, input_height * input_width * channels)
+  // outputs dimensions - (batch_num, output_height * output_width * filters)
+  virtual Math::Matrix<float>
+  predict(const Math::MatrixBase<float> &inputs) const;
+
+  // Backward pass: stores parameters gradients and returns input gradients
+  // dvalues dimensions - (batch_num, output_height * output_width * filters)
+  // outputs dimensions - (batch_num, input_height * input_width * channels)
+  virtual const Math::Matrix<float> &
+  backward(const Math::MatrixBase<float> &dvalues);
+
+  virtual void saveParams(std::ofstream &file) const;
+  virtual void loadParams(std::ifstream &file);
+
+  virtual std::vector<Parameter> parameters();
+
+  // Per-sample output shape - (output_height, output_width, filters)
+  // Throws if inputShape's item count isn't
+  // input_height * input_width * channels
+  virtual Math::Shape outputShape(const Math::Shape &inputShape) const;
+
+  // Kernel matrix - (kernel_size * kernel_size * channels, filters)
+  const Math::Matrix<float> &weights() const { return m_weights; }
+  const Math::Vector<float> &biases() const { return m_biases; }
+  // Preallocates unfolded inputs, outputs and their gradients (see Layer)
+  virtual size_t reserve(size_t batchSize, const Math::Shape &inputShape);
+
+  virtual void releaseActivations() {
+    m_cols = {};
+    m_output = {};
+  }
+
+  virtual const Math::Matrix<float> &output() const { return m_output; }
+  virtual const Math::Matrix<float> &dinputs() const { return m_dinputs; }
+
+  unsigned int outputHeight() const { return m_outputHeight; }
+  unsigned int outputWidth() const { return m_outputWidth; }
+  unsigned int filters() const { return m_filters; }
+
+  virtual bool isTrainable() const { return true; }
+  virtual std::string_view name() const { return "Conv2D"; }
+  virtual Layer::Type type() const { return Layer::Type::Conv2D; }
+
+private:
+  // Forward pass over already unfolded inputs, written into output (reused
+  // across calls)
+  void convolve(const Math::Matrix<float> &cols, size_t batches,
+                Math::Matrix<float> &output) const;
+
+  unsigned int m_inputHeight{};
+  unsigned int m_inputWidth{};
+  unsigned int m_inputChannels{};
+  unsigned int m_filters{};
+  unsigned int m_kernelSize{};
+  unsigned int m_stride{};
+  unsigned int m_padding{};
+  unsigned int m_outputHeight{};
+  unsigned int m_outputWidth{};
+
+  // Unfolded inputs of the last forward pass (kept for backward pass)
+  Math::Matrix<float> m_cols{};
+  Math::Matrix<float> m_weights{};
+  Math::Vector<float> m_biases{};
+  Math::Matrix<float> m_output{};
+
+  Math::Matrix<float> m_dweights{};
+  // Gradients of the unfolded inputs (folded back into m_dinputs)
+  Math::Matrix<float> m_dcols{};
+  Math::Matrix<float> m_dinputs{};
+  Math::Vector<float> m_dbiases{};
+
+};
+} // namespace Layers
+} // namespace ANN
@@ -7,17 +7,11 @@
 #include "math/matrixBase.h"
 #include "math/vector.h"
 
+#include <span>
+
 // Forward declarations
 
 namespace ANN {
-namespace Optimizers {
-class Optimizer;
-class SGD;
-class Adagrad;
-class RMSProp;
-class Adam;
-} // namespace Optimizers
-
 namespace Loss {
 class Loss;
 }
@@ -47,6 +41,11 @@ public:
   // Move assignment
   Dense &operator=(Dense &&other);
 
+  // Tensor passes (see Layer)
+  using Layer::backward;
+  using Layer::forward;
+  using Layer::predict;
+
   // Forward pass: stores and returns layer outputs
   // inputs dimensions - (batch_num, input_num)
   // outputs dimensions - (batch_num, neuron_num)
@@ -58,6 +57,9 @@ public:
   // outputs dimensions - (batch_num, neuron_num)
   virtual Math::Matrix<float>
   predict(const Math::MatrixBase<float> &inputs) const;
+  // predict() written into an existing matrix (see Layer)
+  virtual void predict(const Math::MatrixBase<float> &inputs,
+                       Math::Matrix<float> &output) const;
 
   // Backward pass: stores parameters gradients and returns input gradients
   // dvalues dimensions - (batch_num, neuron_num)
@@ -65,6 +67,21 @@ public:
   virtual const Math::Matrix<float> &
   backward(const Math::MatrixBase<float> &dvalues);
 
+  // Forward pass over the given neurons (output classes) only, e.g. for
+  // sampled softmax training. Writes their outputs into output (dimensions -
+  // (batch_num, classes.size()), reallocated only if they change). classes
+  // must stay valid until the matching backwardSampled()
+  void forwardSampled(const Math::MatrixBase<float> &inputs,
+                      std::span<const size_t> classes,
+                      Math::Matrix<float> &output);
+
+  // Backward pass of forwardSampled(): stores the gradients of the given
+  // neurons' weights and biases only (so parameters() returns them sparse
+  // until the next backward()) and returns input gradients
+  // dvalues dimensions - (batch_num, classes.size())
+  const Math::Matrix<float> &
+  backwardSampled(const Math::MatrixBase<float> &dvalues);
+
   // Loads weights/biases into layer.
   // Given parameters will be invalid after the function is called
   void loadWeights(Math::Matrix<float> &weights);
@@ -73,8 +90,19 @@ public:
   virtual void saveParams(std::ofstream &file) const;
   virtual void loadParams(std::ifstream &file);
 
+  virtual std::vector<Parameter> parameters();
+
+  // Per-sample output shape - (neuron_num)
+  // Throws if inputShape doesn't hold input_num items
+  virtual Math::Shape outputShape(const Math::Shape &inputShape) const;
+
   const Math::Matrix<float> &weights() const { return m_weights; }
   const Math::Vector<float> &biases() const { return m_biases; }
+  // Preallocates outputs and input gradients (see Layer)
+  virtual size_t reserve(size_t batchSize, const Math::Shape &inputShape);
+
+  virtual void releaseActivations() { m_output = {}; }
+
   virtual const Math::Matrix<float> &output() const { return m_output; }
   virtual const Math::Matrix<float> &dinputs() const { return m_dinputs; }
 
@@ -82,15 +110,18 @@ public:
   virtual std::string_view name() const { return "Dense"; }
   virtual Layer::Type type() const { return Layer::Type::Dense; }
 
-  friend class Optimizers::Optimizer;
-  friend class Optimizers::SGD;
-  friend class Optimizers::Adagrad;
-  friend class Optimizers::RMSProp;
-  friend class Optimizers::Adam;
-
   friend class Loss::Loss;
 
 private:
+  // Writes inputs * weights + biases into output, which is only reallocated
+  // when it has to grow
+  void run(const Math::MatrixBase<float> &inputs,
+           Math::Matrix<float> &output) const;
+
+  // Recomputes the regularization losses of the weights and biases, which
+  // the optimizer then keeps up to date (see Parameter)
+  void resetPenalties();
+
   Math::MatrixView<float> m_input{};
   Math::Matrix<float> m_weights{};
   Math::Vector<float> m_biases{};
@@ -100,15 +131,19 @@ private:
   Math::Matrix<float> m_dinputs{};
   Math::Vector<float> m_dbiases{};
 
-  Math::Matrix<float> m_weightCache{};
-  Math::Matrix<float> m_weightMomentums{};
-  Math::Vector<float> m_biasCache{};
-  Math::Vector<float> m_biasMomentums{};
+  // Whether the stored gradients are of sampled neurons only
+  bool m_isSampled{};
+  // Neurons of the last forwardSampled(), and their weights (one neuron per
+  // row, gathered from the columns of m_weights)
+  std::span<const size_t> m_sampledClasses{};
+  Math::Matrix<float> m_sampledWeights{};
 
   float m_l1Weight{};
   float m_l1Bias{};
   float m_l2Weight{};
   float m_l2Bias{};
+  float m_weightsPenalty{};
+  float m_biasesPenalty{};
 };
 } // namespace Layers
 } // namespace ANN
@@ -25,6 +25,11 @@ public:
   // Move assignment
   Dropout &operator=(Dropout &&other) noexcept;
 
+  // Tensor passes (see Layer)
+  using Layer::backward;
+  using Layer::forward;
+  using Layer::predict;
+
   // Forward pass: stores and returns layer outputs
   // inputs dimensions - (batch_num, input_num)
   // outputs dimensions - (batch_num, neuron_num)
@@ -43,6 +48,12 @@ public:
   virtual const Math::Matrix<float> &
   backward(const Math::MatrixBase<float> &dvalues);
 
+  // Preallocates outputs, mask and input gradients (see Layer)
+  virtual size_t reserve(size_t batchSize, const Math::Shape &inputShape);
+
+  // Masks are random, so they're never recomputed
+  virtual bool isRecomputable() const { return false; }
+
   virtual const Math::Matrix<float> &output() const { return m_output; }
   virtual const Math::Matrix<float> &dinputs() const { return m_dinputs; }
 
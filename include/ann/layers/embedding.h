@@ -0,0 +1,116 @@
+#pragma once
+
+#include "../layer.h"
+#include "../modelDescriptors.h"
+
+#include "math/matrix.h"
+#include "math/matrixBase.h"
+
+#include <vector>
+
+namespace ANN {
+namespace Layers {
+// Embedding layer - maps integer indices to learned vectors by table lookup.
+// Inputs hold indices (stored as floats, so exact up to 2^24) instead of
+// one-hot encodings. Gradients are kept only for the table rows used by the
+// last batch, so the optimizer's update cost scales with the batch and not
+// with the vocabulary size.
+class Embedding : public Layer {
+public:
+  Embedding() = delete;
+
+  // vocabularySize - number of distinct indices (table rows)
+  // dimensions - size of every embedding vector
+  // Uses random weight initialization as default.
+  Embedding(unsigned int vocabularySize, unsigned int dimensions,
+            ANN::WeightInit initMethod = ANN::WeightInit::Random);
+
+  // Copy constructor deleted
+  Embedding(const Embedding &other) = delete;
+
+  // Move constructor
+  Embedding(Embedding &&other) noexcept;
+
+  // Copy assignment deleted
+  Embedding &operator=(const Embedding &other) = delete;
+
+  // Move assignment
+  Embedding &operator=(Embedding &&other) noexcept;
+
+  // Tensor passes (see Layer)
+  using Layer::backward;
+  using Layer::forward;
+  using Layer::predict;
+
+  // Forward pass: stores and returns layer outputs
+  // Throws if an input isn't a valid index
+  // inputs dimensions - (batch_num, index_num)
+  // outputs dimensions - (batch_num, index_num * dimensions)
+  virtual const Math::Matrix<float> &
+  forward(const Math::MatrixBase<float> &inputs);
+
+  // Forward pass without storing layer outputs
+  // Throws if an input isn't a valid index
+  // inputs dimensions - (batch_num, index_num)
+  // outputs dimensions - (batch_num, index_num * dimensions)
+  virtual Math::Matrix<float>
+  predict(const Math::MatrixBase<float> &inputs) const;
+
+  // Backward pass: stores the gradients of the used table rows.
+  // Indices aren't differentiable, so returned input gradients are all 0
+  // dvalues dimensions - (batch_num, index_num * dimensions)
+  // outputs dimensions - (batch_num, index_num)
+  virtual const Math::Matrix<float> &
+  backward(const Math::MatrixBase<float> &dvalues);
+
+  virtual void saveParams(std::ofstream &file) const;
+  virtual void loadParams(std::ifstream &file);
+
+  // The table is a sparse parameter (see Parameter)
+  virtual std::vector<Parameter> parameters();
+
+  // Per-sample output shape - (index_num, dimensions)
+  virtual Math::Shape outputShape(const Math::Shape &inputShape) const;
+
+  // Embedding table - (vocabulary_size, dimensions)
+  const Math::Matrix<float> &table() const { return m_table; }
+  // Preallocates outputs, indices and input gradients (see Layer)
+  virtual size_t reserve(size_t batchSize, const Math::Shape &inputShape);
+
+  virtual void releaseActivations() { m_output = {}; }
+
+  virtual const Math::Matrix<float> &output() const { return m_output; }
+  virtual const Math::Matrix<float> &dinputs() const { return m_dinputs; }
+
+  virtual bool isTrainable() const { return true; }
+  virtual std::string_view name() const { return "Embedding"; }
+  virtual Layer::Type type() const { return Layer::Type::Embedding; }
+
+private:
+  // Converts inputs to table rows, written into indices (reused across calls).
+  // Throws on invalid indices
+  void toIndices(const Math::MatrixBase<float> &inputs,
+                 std::vector<size_t> &indices) const;
+
+  // Copies the table rows of the given indices into output
+  void lookup(const std::vector<size_t> &indices,
+              Math::Matrix<float> &output) const;
+
+  Math::Matrix<float> m_table{};
+  Math::Matrix<float> m_output{};
+  // Table rows of the last forward pass (kept for backward pass)
+  std::vector<size_t> m_indices{};
+
+  Math::Matrix<float> m_dinputs{};
+  // Positions of the last forward pass grouped by table row, and the start of
+  // every group (with an end sentinel)
+  std::vector<size_t> m_order{};
+  std::vector<size_t> m_groupStarts{};
+  // Unique table rows used by the last backward pass, sorted
+  std::vector<size_t> m_touchedRows{};
+  // Gradients of m_touchedRows - (touched_rows, dimensions)
+  std::vector<float> m_dtable{};
+
+};
+} // namespace Layers
+} // namespace ANN
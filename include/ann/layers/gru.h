@@ -0,0 +1,166 @@
+#pragma once
+
+#include "../layer.h"
+#include "../modelDescriptors.h"
+
+#include "math/matrix.h"
+#include "math/matrixBase.h"
+#include "math/vector.h"
+
+namespace ANN {
+namespace Layers {
+// Gated recurrent unit layer.
+// Sequences are passed between layers flattened into rows, in (timestep,
+// features) order. Computed the same way as LSTM: one GEMM for the input
+// projections of all timesteps, then one recurrent GEMM for all gates and a
+// fused gate pass per timestep. Gate order in the weight matrices is (reset,
+// update, new). The reset gate is applied after the recurrent projection of the
+// new gate, which is what keeps a single recurrent GEMM per timestep possible.
+class GRU : public Layer {
+public:
+  GRU() = delete;
+
+  // inputSize - features of every timestep
+  // units - size of the hidden state
+  // returnSequences - output the hidden state of every timestep instead of
+  //                   only the last one
+  // 0-init biases
+  // Uses random weight initialization as default.
+  GRU(unsigned int inputSize, unsigned int units, bool returnSequences = false,
+      ANN::WeightInit initMethod = ANN::WeightInit::Random);
+
+  // Copy constructor deleted
+  GRU(const GRU &other) = delete;
+
+  // Move constructor
+  GRU(GRU &&other) noexcept;
+
+  // Copy assignment deleted
+  GRU &operator=(const GRU &other) = delete;
+
+  // Move assignment
+  GRU &operator=(GRU &&other) noexcept;
+
+  // Tensor passes (see Layer)
+  using Layer::backward;
+  using Layer::forward;
+  using Layer::predict;
+
+  // Forward pass: stores and returns layer outputs
+  // inputs dimensions - (batch_num, timesteps * input_size)
+  // outputs dimensions - (batch_num, timesteps * units) if returnSequences,
+  //                      otherwise (batch_num, units)
+  virtual const Math::Matrix<float> &
+  forward(const Math::MatrixBase<float> &inputs);
+
+  // Forward pass without storing layer outputs
+  // Same dimensions as forward()
+  virtual Math::Matrix<float>
+  predict(const Math::MatrixBase<float> &inputs) const;
+
+  // Backward pass through time: stores parameters gradients and returns input
+  // gradients
+  // dvalues dimensions - same as forward()'s outputs
+  // outputs dimensions - (batch_num, timesteps * input_size)
+  virtual const Math::Matrix<float> &
+  backward(const Math::MatrixBase<float> &dvalues);
+
+  virtual void saveParams(std::ofstream &file) const;
+  virtual void loadParams(std::ifstream &file);
+
+  virtual std::vector<Parameter> parameters();
+
+  // Per-sample output shape - (timesteps, units) if returnSequences, otherwise
+  // (units)
+  // Throws if inputShape's item count isn't a multiple of input_size
+  virtual Math::Shape outputShape(const Math::Shape &inputShape) const;
+
+  // Input weights - (3 * units, input_size)
+  const Math::Matrix<float> &inputWeights() const { return m_inputWeights; }
+  // Recurrent weights - (3 * units, units)
+  const Math::Matrix<float> &recurrentWeights() const {
+    return m_recurrentWeights;
+  }
+  const Math::Vector<float> &inputBiases() const { return m_inputBiases; }
+  const Math::Vector<float> &recurrentBiases() const {
+    return m_recurrentBiases;
+  }
+  // Preallocates sequence state and its gradients (see Layer)
+  virtual size_t reserve(size_t batchSize, const Math::Shape &inputShape);
+
+  virtual void releaseActivations() {
+    m_output = {};
+    m_state = {};
+  }
+
+  virtual const Math::Matrix<float> &output() const { return m_output; }
+  virtual const Math::Matrix<float> &dinputs() const { return m_dinputs; }
+
+  unsigned int units() const { return m_units; }
+  bool returnSequences() const { return m_returnSequences; }
+
+  virtual bool isTrainable() const { return true; }
+  virtual std::string_view name() const { return "GRU"; }
+  virtual Layer::Type type() const { return Layer::Type::GRU; }
+
+private:
+  // Buffers of a single forward pass. They're only reallocated when the batch
+  // size or the sequence length changes.
+  struct State {
+    // Input projections of all timesteps - (batch_num * timesteps, 3 * units)
+    Math::Matrix<float> projections{};
+    // Activated gates of all timesteps - (batch_num * timesteps, 3 * units)
+    Math::Matrix<float> gates{};
+    // Recurrent projections of the new gate (before the reset gate is applied)
+    // of all timesteps - (batch_num, timesteps * units)
+    Math::Matrix<float> recurrentNew{};
+    // Hidden state before every timestep - (batch_num, timesteps * units)
+    Math::Matrix<float> prevHiddens{};
+    // Recurrent projections of the current timestep - (batch_num, 3 * units)
+    Math::Matrix<float> stepGates{};
+    // Current hidden state - (batch_num, units)
+    Math::Matrix<float> hidden{};
+  };
+
+  // Runs the sequence, filling state and output
+  void run(const Math::MatrixBase<float> &inputs, State &state,
+           Math::Matrix<float> &output) const;
+
+  // Returns timestep count of the given inputs. Throws if it isn't whole
+  size_t timesteps(const Math::MatrixBase<float> &inputs) const;
+
+  unsigned int m_inputSize{};
+  unsigned int m_units{};
+  bool m_returnSequences{};
+
+  Math::MatrixView<float> m_input{};
+  Math::Matrix<float> m_inputWeights{};
+  Math::Matrix<float> m_recurrentWeights{};
+  Math::Vector<float> m_inputBiases{};
+  Math::Vector<float> m_recurrentBiases{};
+  Math::Matrix<float> m_output{};
+  State m_state{};
+
+  // Backward pass buffers
+  // Gate pre-activation gradients of the input and recurrent projections -
+  // (batch_num * timesteps, 3 * units)
+  Math::Matrix<float> m_dgates{};
+  Math::Matrix<float> m_drecurrentGates{};
+  // Recurrent gate gradients of the current timestep - (batch_num, 3 * units)
+  Math::Matrix<float> m_stepDGates{};
+  // Hidden gradients flowing to the previous timestep through the recurrent
+  // projections, and directly through the update gate - (batch_num, units)
+  Math::Matrix<float> m_dhidden{};
+  Math::Matrix<float> m_dcarry{};
+  // Transposed recurrent weights (refreshed every backward pass)
+  Math::Matrix<float> m_recurrentWeightsT{};
+
+  Math::Matrix<float> m_dinputWeights{};
+  Math::Matrix<float> m_drecurrentWeights{};
+  Math::Vector<float> m_dinputBiases{};
+  Math::Vector<float> m_drecurrentBiases{};
+  Math::Matrix<float> m_dinputs{};
+
+};
+} // namespace Layers
+} // namespace ANN
@@ -0,0 +1,155 @@
+#pragma once
+
+#include "../layer.h"
+#include "../modelDescriptors.h"
+
+#include "math/matrix.h"
+#include "math/matrixBase.h"
+#include "math/vector.h"
+
+#include <vector>
+
+namespace ANN {
+namespace Layers {
+// Multi-head self-attention layer.
+// Sequences are passed between layers flattened into rows, in (timestep,
+// features) order. Attention is computed in (query, key) tiles with an online
+// softmax: every query tile keeps a running max and sum of its scores and
+// rescales its partial outputs as new key tiles arrive. Only a tile of scores
+// exists at a time, so memory grows linearly with the sequence length. The
+// backward pass recomputes the score tiles from the stored per-query softmax
+// normalizers instead of keeping them.
+class MultiHeadAttention : public Layer {
+public:
+  MultiHeadAttention() = delete;
+
+  // features - features of every timestep (model dimensions)
+  // heads - number of attention heads. Must divide features
+  // 0-init biases
+  // Uses random weight initialization as default.
+  MultiHeadAttention(unsigned int features, unsigned int heads,
+                     ANN::WeightInit initMethod = ANN::WeightInit::Random);
+
+  // Copy constructor deleted
+  MultiHeadAttention(const MultiHeadAttention &other) = delete;
+
+  // Move constructor
+  MultiHeadAttention(MultiHeadAttention &&other) noexcept;
+
+  // Copy assignment deleted
+  MultiHeadAttention &operator=(const MultiHeadAttention &other) = delete;
+
+  // Move assignment
+  MultiHeadAttention &operator=(MultiHeadAttention &&other) noexcept;
+
+  // Tensor passes (see Layer)
+  using Layer::backward;
+  using Layer::forward;
+  using Layer::predict;
+
+  // Forward pass: stores and returns layer outputs
+  // inputs dimensions - (batch_num, timesteps * features)
+  // outputs dimensions - (batch_num, timesteps * features)
+  virtual const Math::Matrix<float> &
+  forward(const Math::MatrixBase<float> &inputs);
+
+  // Forward pass without storing layer outputs
+  // inputs dimensions - (batch_num, timesteps * features)
+  // outputs dimensions - (batch_num, timesteps * features)
+  virtual Math::Matrix<float>
+  predict(const Math::MatrixBase<float> &inputs) const;
+
+  // Backward pass: stores parameters gradients and returns input gradients
+  // dvalues dimensions - (batch_num, timesteps * features)
+  // outputs dimensions - (batch_num, timesteps * features)
+  virtual const Math::Matrix<float> &
+  backward(const Math::MatrixBase<float> &dvalues);
+
+  virtual void saveParams(std::ofstream &file) const;
+  virtual void loadParams(std::ifstream &file);
+
+  virtual std::vector<Parameter> parameters();
+
+  // Per-sample output shape - (timesteps, features)
+  // Throws if inputShape's item count isn't a multiple of features
+  virtual Math::Shape outputShape(const Math::Shape &inputShape) const;
+
+  // Query, key and value weights, stacked - (3 * features, features)
+  const Math::Matrix<float> &inputWeights() const { return m_inputWeights; }
+  const Math::Vector<float> &inputBiases() const { return m_inputBiases; }
+  // Output projection weights - (features, features)
+  const Math::Matrix<float> &outputWeights() const { return m_outputWeights; }
+  const Math::Vector<float> &outputBiases() const { return m_outputBiases; }
+  // Preallocates projections, heads and their gradients (see Layer)
+  virtual size_t reserve(size_t batchSize, const Math::Shape &inputShape);
+
+  virtual void releaseActivations() {
+    m_output = {};
+    m_state = {};
+  }
+
+  virtual const Math::Matrix<float> &output() const { return m_output; }
+  virtual const Math::Matrix<float> &dinputs() const { return m_dinputs; }
+
+  unsigned int heads() const { return m_heads; }
+
+  virtual bool isTrainable() const { return true; }
+  virtual std::string_view name() const { return "MultiHeadAttention"; }
+  virtual Layer::Type type() const { return Layer::Type::MultiHeadAttention; }
+
+private:
+  // Buffers of a single forward pass. Heads are stored head-major, where row
+  // (batch * heads + head) * timesteps + timestep holds a single timestep's
+  // head_size values.
+  struct State {
+    // Query, key and value projections - (batch_num * timesteps, 3 * features)
+    Math::Matrix<float> projections{};
+    // Scaled queries, keys and values by head -
+    // (batch_num * heads * timesteps, head_size)
+    Math::Matrix<float> queries{};
+    Math::Matrix<float> keys{};
+    Math::Matrix<float> values{};
+    // Attention outputs by head - (batch_num * heads * timesteps, head_size)
+    Math::Matrix<float> attention{};
+    // Log of every query's softmax normalizer, head-major
+    std::vector<float> logSums{};
+    // Attention outputs with heads concatenated -
+    // (batch_num * timesteps, features)
+    Math::Matrix<float> concatenated{};
+  };
+
+  // Runs attention over inputs, filling state and output
+  void run(const Math::MatrixBase<float> &inputs, State &state,
+           Math::Matrix<float> &output) const;
+
+  // Returns timestep count of the given inputs. Throws if it isn't whole
+  size_t timesteps(const Math::MatrixBase<float> &inputs) const;
+
+  unsigned int m_features{};
+  unsigned int m_heads{};
+
+  Math::MatrixView<float> m_input{};
+  Math::Matrix<float> m_inputWeights{};
+  Math::Vector<float> m_inputBiases{};
+  Math::Matrix<float> m_outputWeights{};
+  Math::Vector<float> m_outputBiases{};
+  Math::Matrix<float> m_output{};
+  State m_state{};
+
+  // Backward pass buffers (same layouts as their State counterparts)
+  Math::Matrix<float> m_dconcatenated{};
+  Math::Matrix<float> m_dattention{};
+  Math::Matrix<float> m_dqueryHeads{};
+  Math::Matrix<float> m_dkeyHeads{};
+  Math::Matrix<float> m_dvalueHeads{};
+  Math::Matrix<float> m_dprojections{};
+
+  Math::Matrix<float> m_dinputWeights{};
+  Math::Vector<float> m_dinputBiases{};
+  Math::Matrix<float> m_doutputWeights{};
+  Math::Vector<float> m_doutputBiases{};
+  Math::Matrix<float> m_dinputs{};
+
+};
+} // namespace Layers
+} // namespace ANN
@@ -39,6 +39,8 @@ public:
   // Calculate average plain accuracy based on calculated
   float accuracy() const;
 
+  virtual bool hasAccuracy() const { return true; }
+
 private:
   // No ownership of m_input and m_correct by the class. Just a constant view.
   Math::MatrixView<float> m_predictions{};
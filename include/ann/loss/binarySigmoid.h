@@ -0,0 +1,58 @@
+#pragma once
+
+#include "loss.h"
+
+#include "math/matrix.h"
+#include "math/matrixBase.h"
+
+namespace ANN {
+namespace Loss {
+// Binary Cross-Entropy loss class, fused with the sigmoid activation before
+// it. Takes the logits (sigmoid inputs), so the loss is computed from
+// log-sigmoid without ever clamping probabilities, and the input gradients
+// (sigmoid(x) - y) come out of the same pass as the loss
+class BinarySigmoid : public Loss {
+public:
+  BinarySigmoid() = default;
+
+  virtual ~BinarySigmoid() = default;
+
+  // Copy constructor deleted
+  BinarySigmoid(const BinarySigmoid &other) = delete;
+
+  // Move constructor
+  BinarySigmoid(BinarySigmoid &&other) noexcept;
+
+  // Copy assignment deleted
+  BinarySigmoid &operator=(const BinarySigmoid &other) = delete;
+
+  // Move assignment
+  BinarySigmoid &operator=(BinarySigmoid &&other) noexcept;
+
+  // Forward pass: stores and returns layer output (average batch loss), and
+  // stores the input gradients backward() returns
+  // inputs = inputs to sigmoid layer
+  // correct = "wanted" values of sigmoid outputs (0 or 1 per label)
+  virtual const Math::Vector<float> &
+  forward(const Math::MatrixBase<float> &inputs,
+          const Math::MatrixBase<float> &correct);
+
+  // Backward pass: returns input gradients (calculated by forward())
+  virtual const Math::Matrix<float> &backward();
+
+  // Forward pass without storing layer outputs
+  // inputs = input to sigmoid layer
+  Math::Matrix<float>
+  predictSigmoid(const Math::MatrixBase<float> &inputs) const;
+
+  // Calculate average plain accuracy based on calculated
+  float accuracy() const;
+
+  virtual bool hasAccuracy() const { return true; }
+
+private:
+  // Predictions made per sample by the last forward pass
+  size_t m_labels{};
+};
+} // namespace Loss
+} // namespace ANN
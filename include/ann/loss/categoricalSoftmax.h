@@ -6,6 +6,9 @@
 #include "math/matrixBase.h"
 #include "math/vectorBase.h"
 
+#include <cstdint>
+#include <vector>
+
 namespace ANN {
 namespace Loss {
 // Categorical Cross-Entropy loss class
@@ -32,12 +35,17 @@ public:
   // correct = indicies correct matrix
   const Math::Vector<float> &forward(const Math::MatrixBase<float> &inputs,
                                      const Math::VectorBase<float> &correct);
+  // Integer indices overloads (see Loaders::MNist), read without conversion
+  const Math::Vector<float> &forward(const Math::MatrixBase<float> &inputs,
+                                     const Math::VectorBase<uint16_t> &correct);
+  const Math::Vector<float> &forward(const Math::MatrixBase<float> &inputs,
+                                     const Math::VectorBase<uint32_t> &correct);
 
   // Forward pass: stores and returns layer output (average batch loss)
   // inputs = input to softmax layer
   // correct = one-hot encoded correct matrix
-  // Note: other forward function is more optimized. Optimally, it's the one
-  //       which should be used.
+  // Note: other forward functions are more optimized (every row of correct is
+  //       scanned for its index). Optimally, they're the ones to be used.
   virtual const Math::Vector<float> &
   forward(const Math::MatrixBase<float> &inputs,
           const Math::MatrixBase<float> &correct);
@@ -53,15 +61,27 @@ public:
   // Calculate average plain accuracy based on calculated
   float accuracy() const;
 
+  virtual bool hasAccuracy() const { return true; }
+
   // Calculate average loss accross batches
   virtual float mean() const;
 
+  // Preallocates outputs, softmax outputs and input gradients (see Loss)
+  virtual size_t reserve(size_t batchSize, size_t outputs);
+
   const Math::Matrix<float> &softmaxOutput() const { return m_softmaxOutput; }
 
 private:
+  // Shared forward pass of every correct type. labelOf(batch) returns the
+  // correct index of the given batch
+  template <typename LabelOf>
+  const Math::Vector<float> &
+  forwardLabels(const Math::MatrixBase<float> &inputs, const LabelOf &labelOf);
+
   // No ownership of m_input by the class. Just a constant view.
   Math::MatrixView<float> m_input{};
-  Math::VectorView<float> m_correct{};
+  // Correct index of every batch of the last forward pass
+  std::vector<uint32_t> m_labels{};
 
   Math::Matrix<float> m_softmaxOutput{};
 
@@ -4,6 +4,9 @@
 #include "math/matrixBase.h"
 #include "math/vector.h"
 
+#include <functional>
+#include <vector>
+
 namespace ANN {
 // Forward declarations
 namespace Layers {
@@ -26,10 +29,30 @@ public:
   // Backward pass: stores and returns input gradients
   virtual const Math::Matrix<float> &backward() = 0;
 
+  // Preallocates outputs and input gradients for batches of up to batchSize
+  // samples of the given output size, so smaller batches run without
+  // allocating. Returns the bytes reserved
+  virtual size_t reserve(size_t batchSize, size_t outputs);
+
   // Calculate average loss from calculated output derived from member function
   virtual float mean() const;
 
-  // Calculate layer regularization loss based on its learned + hyper parameters
+  // Whether the loss measures accuracy (classification losses)
+  virtual bool hasAccuracy() const { return false; }
+
+  // Running metrics - every forward pass adds its sample losses (and correct
+  // predictions) to running sums, so reading their averages over all passes
+  // since the last resetMetrics() is O(1). runningAccuracy() is -1 for losses
+  // without accuracy, and both are 0 before any forward pass
+  float runningMean() const;
+  float runningAccuracy() const;
+  void resetMetrics();
+  // Adds the running metrics of other (e.g. a copy of the loss which ran part
+  // of an evaluation) to this loss'
+  void mergeMetrics(const Loss &other);
+
+  // Layer regularization loss based on its learned + hyper parameters. Kept
+  // up to date by the optimizer, so it doesn't scan the parameters
   float regularizationLoss(const Layers::Dense &layer) const;
 
   virtual const Math::Vector<float> &output() const { return m_output; }
@@ -39,10 +62,36 @@ protected:
   Loss() = default;
 
   // Move constructor
-  Loss(Loss &&other) : m_output{std::move(other.m_output)} {}
+  Loss(Loss &&other)
+      : m_output{std::move(other.m_output)}, m_hits{std::move(other.m_hits)} {}
+
+  // Runs kernel (which fills m_output, and m_hits for classification losses,
+  // for a single sample) over the batch's samples in parallel (see
+  // Utils::Parallel::dynamicParallelFor()), and adds them to the running
+  // metrics in the same loop: every thread's block of samples sums the results
+  // it just wrote, so there's no separate pass over the batch. Classification
+  // losses pass the number of predictions made per sample
+  void forwardSamples(size_t cost, size_t samples,
+                      const std::function<void(size_t)> &kernel,
+                      size_t predictionsPerSample = 0);
+
+  // Accuracy of the last forward pass (classification losses only)
+  float hitRate(size_t predictionsPerSample) const;
 
   Math::Vector<float> m_output{};
   Math::Matrix<float> m_dinputs{};
+  // Correct predictions of every sample of the last forward pass, written by
+  // the forward kernels of classification losses
+  Math::Vector<float> m_hits{};
+
+private:
+  // Loss and hit sums of every block of forwardSamples() (kept to reuse their
+  // storage)
+  std::vector<float> m_blockSums{};
+  double m_lossSum{};
+  double m_hitSum{};
+  size_t m_sampleSum{};
+  size_t m_predictionSum{};
 };
 } // namespace Loss
 } // namespace ANN
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "categoricalSoftmax.h"
+
+#include "math/matrix.h"
+#include "math/matrixBase.h"
+#include "math/vectorBase.h"
+
+#include <vector>
+
+namespace ANN {
+namespace Layers {
+class Dense;
+}
+
+namespace Loss {
+// Sampled softmax loss class - Categorical Cross-Entropy + softmax, trained on
+// the correct classes and a few sampled ones (see
+// SampledCategoricalCrossEntropySoftmaxLoss). Full forward passes (validation
+// and evaluation) behave like CategoricalSoftmax's.
+class SampledSoftmax : public CategoricalSoftmax {
+public:
+  // samples - distinct classes sampled for every training step
+  // logUniform - sample from a log-uniform distribution instead of uniformly
+  SampledSoftmax(size_t samples, bool logUniform);
+
+  virtual ~SampledSoftmax() = default;
+
+  // Copy constructor deleted
+  SampledSoftmax(const SampledSoftmax &other) = delete;
+
+  // Move constructor
+  SampledSoftmax(SampledSoftmax &&other) noexcept = default;
+
+  // Copy assignment deleted
+  SampledSoftmax &operator=(const SampledSoftmax &other) = delete;
+
+  // Move assignment
+  SampledSoftmax &operator=(SampledSoftmax &&other) noexcept = default;
+
+  using CategoricalSoftmax::forward;
+
+  // Sampled forward pass: stores and returns layer output (average batch
+  // loss), computing only the sampled and correct classes' logits through
+  // layer (see Dense::forwardSampled())
+  // layer = the model's last layer, whose outputs are the logits
+  // inputs = inputs to layer
+  // correct = indicies correct matrix
+  // Throws if samples aren't fewer than layer's classes
+  const Math::Vector<float> &forward(Layers::Dense &layer,
+                                     const Math::MatrixBase<float> &inputs,
+                                     const Math::VectorBase<float> &correct);
+  const Math::Vector<float> &forward(Layers::Dense &layer,
+                                     const Math::MatrixBase<float> &inputs,
+                                     const Math::VectorBase<uint16_t> &correct);
+  const Math::Vector<float> &forward(Layers::Dense &layer,
+                                     const Math::MatrixBase<float> &inputs,
+                                     const Math::VectorBase<uint32_t> &correct);
+
+  // Sampled backward pass: returns the gradients of the logits computed by
+  // the last sampled forward pass (to be passed to Dense::backwardSampled())
+  const Math::Matrix<float> &backwardSampled() const { return m_dlogits; }
+
+  // Preallocates the sampled pass' buffers as well (see CategoricalSoftmax)
+  virtual size_t reserve(size_t batchSize, size_t outputs);
+
+  size_t samples() const { return m_samples; }
+
+private:
+  // Shared sampled forward pass of every correct type. labelOf(batch) returns
+  // the correct index of the given batch
+  template <typename LabelOf>
+  const Math::Vector<float> &
+  forwardLabels(Layers::Dense &layer, const Math::MatrixBase<float> &inputs,
+                const LabelOf &labelOf);
+
+  // Draws of a sample() call. Draws stop after maxDrawsPerSample draws per
+  // sample (e.g. when nearly every class is sampled, and tail classes of the
+  // log-uniform distribution are rarely drawn), and the missing classes are
+  // then chosen uniformly among the classes not drawn. completion is the
+  // probability of every such class to be chosen (0 without completion)
+  struct Draws {
+    size_t draws{};
+    double completion{};
+  };
+  static constexpr size_t maxDrawsPerSample{32};
+
+  // Samples m_samples distinct classes out of classes into m_candidates
+  Draws sample(size_t classes);
+
+  // Log of the probability of class to be sampled by the given draws (its
+  // sampling correction)
+  float logExpectedCount(size_t classes, const Draws &draws,
+                         size_t label) const;
+
+  size_t m_samples{};
+  bool m_logUniform{};
+
+  // Sampled classes followed by the batch's correct classes which weren't
+  // sampled, with the slot of every class among them (noSlot otherwise)
+  std::vector<size_t> m_candidates{};
+  std::vector<size_t> m_slots{};
+  // Sampling correction of every candidate
+  std::vector<float> m_corrections{};
+  // Logits of the candidates, turned into their gradients in place
+  Math::Matrix<float> m_dlogits{};
+};
+} // namespace Loss
+} // namespace ANN
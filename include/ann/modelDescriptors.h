@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <variant>
 #include <vector>
 
@@ -25,6 +26,94 @@ struct Dropout {
   float dropRate{};
 };
 
+// 2D convolution layer descriptor
+// Images are expected flattened in (height, width, channels) order.
+// Input dimensions left as 0 are taken from the previous layer's image shape
+// (e.g. a Conv2D or pooling layer). For flat inputs, inputChannels defaults to
+// 1 and the input is assumed to be a square image.
+struct Conv2D {
+  unsigned int filters{};
+  unsigned int kernelSize{};
+  unsigned int stride{1};
+  unsigned int padding{};
+  unsigned int inputChannels{};
+  unsigned int inputHeight{};
+  unsigned int inputWidth{};
+  WeightInit initMethod{WeightInit::Random};
+};
+
+// Embedding layer descriptor
+// Inputs are expected to be indices in [0, vocabularySize), one embedding
+// vector of size dimensions is looked up for each of them.
+struct Embedding {
+  unsigned int vocabularySize{};
+  unsigned int dimensions{};
+  WeightInit initMethod{WeightInit::Random};
+};
+
+// LSTM layer descriptor
+// Sequences are expected flattened in (timestep, features) order.
+// inputSize (features per timestep) left as 0 is taken from the previous
+// layer's sequence shape (e.g. an Embedding or a recurrent layer returning
+// sequences). For flat inputs, it defaults to 1.
+// returnSequences outputs the hidden state of every timestep instead of only
+// the last one.
+struct LSTM {
+  unsigned int units{};
+  unsigned int inputSize{};
+  bool returnSequences{};
+  WeightInit initMethod{WeightInit::Random};
+};
+
+// GRU layer descriptor
+// Same conventions as LSTM
+struct GRU {
+  unsigned int units{};
+  unsigned int inputSize{};
+  bool returnSequences{};
+  WeightInit initMethod{WeightInit::Random};
+};
+
+// Multi-head self-attention layer descriptor
+// Sequences are expected flattened in (timestep, features) order. inputSize
+// (features per timestep) is inferred the same way as LSTM's, and heads must
+// divide it.
+struct MultiHeadAttention {
+  unsigned int heads{};
+  unsigned int inputSize{};
+  WeightInit initMethod{WeightInit::Random};
+};
+
+// Batch normalization layer descriptor
+// Normalizes every feature of the previous layer's outputs.
+// momentum ∈ [0.0, 1.0], weight of the old running statistics on update
+struct BatchNorm {
+  float momentum{0.99f};
+  float epsilon{1e-3f};
+};
+
+// 2D max pooling layer descriptor
+// Images are expected flattened in (height, width, channels) order.
+// stride of 0 means non-overlapping windows (stride = poolSize).
+// Input dimensions are inferred the same way as Conv2D's.
+struct MaxPool2D {
+  unsigned int poolSize{};
+  unsigned int stride{};
+  unsigned int inputChannels{};
+  unsigned int inputHeight{};
+  unsigned int inputWidth{};
+};
+
+// 2D average pooling layer descriptor
+// Same conventions as MaxPool2D
+struct AvgPool2D {
+  unsigned int poolSize{};
+  unsigned int stride{};
+  unsigned int inputChannels{};
+  unsigned int inputHeight{};
+  unsigned int inputWidth{};
+};
+
 struct Step {};
 
 struct Sigmoid {};
@@ -37,27 +126,78 @@ struct LeakyReLU {
 
 struct Softmax {};
 
-using LayerDescriptor = std::variant<std::monostate, Dense, Dropout, Step,
-                                     Sigmoid, ReLU, LeakyReLU, Softmax>;
+using LayerDescriptor =
+    std::variant<std::monostate, Dense, Dropout, Conv2D, Embedding, LSTM, GRU,
+                 MultiHeadAttention, BatchNorm, MaxPool2D, AvgPool2D, Step,
+                 Sigmoid, ReLU, LeakyReLU, Softmax>;
 
 struct FeedForwardModelDescriptor {
   unsigned int inputs{};
   std::vector<LayerDescriptor> layers{};
 };
 
+// Merges of graph nodes with several inputs
+// Add - element-wise sum, all inputs must have the same size
+// Concat - per-sample outputs joined in input order (flattened)
+enum class Merge {
+  None,
+  Add,
+  Concat,
+};
+
+// Graph model node descriptor. A node is either a layer or a merge.
+// inputs - nodes this node receives outputs of. 0 is the model inputs and n is
+//          the n-th node of the descriptor (starting at 1). Layers receive a
+//          single input, merges at least two. Left empty, it's the previous
+//          node (or the model inputs for the first node).
+struct GraphNode {
+  LayerDescriptor layer{};
+  Merge merge{Merge::None};
+  std::vector<size_t> inputs{};
+};
+
+// Graph model descriptor
+// Nodes may be listed in any order, as long as they form no cycles. The last
+// node's outputs are the model outputs, and every other node must lead to it.
+struct GraphModelDescriptor {
+  unsigned int inputs{};
+  std::vector<GraphNode> nodes{};
+};
+
 struct CategoricalCrossEntropyLoss {};
 
 struct CategoricalCrossEntropySoftmaxLoss {};
 
+// Categorical cross-entropy + softmax trained on sampled classes, for very
+// large class counts. The model must end with a Dense layer (its logits, no
+// softmax layer). Every training step only computes the logits of the batch's
+// correct classes and of `samples` distinct sampled classes, with the loss
+// corrected for their sampling probabilities, and only updates the weights of
+// those classes. Validation, evaluation and predictions use the full softmax,
+// and training metrics cover the sampled classes only.
+// logUniform - sample classes from a log-uniform (Zipfian) distribution, which
+//              expects classes sorted by decreasing frequency. If false,
+//              classes are sampled uniformly
+struct SampledCategoricalCrossEntropySoftmaxLoss {
+  unsigned int samples{};
+  bool logUniform{true};
+};
+
 struct BinaryCrossEntropyLoss {};
 
+// Binary cross-entropy fused with the sigmoid activation. Expects the model
+// to end with the logits (no sigmoid layer), and predictions get the sigmoid
+struct BinaryCrossEntropySigmoidLoss {};
+
 struct MeanSquaredErrorLoss {};
 
 struct MeanAbsoluteErrorLoss {};
 
 using LossDescriptor =
     std::variant<std::monostate, CategoricalCrossEntropyLoss,
-                 CategoricalCrossEntropySoftmaxLoss, BinaryCrossEntropyLoss,
+                 CategoricalCrossEntropySoftmaxLoss,
+                 SampledCategoricalCrossEntropySoftmaxLoss,
+                 BinaryCrossEntropyLoss, BinaryCrossEntropySigmoidLoss,
                  MeanSquaredErrorLoss, MeanAbsoluteErrorLoss>;
 
 struct SGD {
@@ -87,8 +227,28 @@ struct Adam {
   float beta2{0.999f};
 };
 
+// Layer-wise adaptive optimizers for large batches (see Optimizers::LAMB and
+// Optimizers::LARS). weightDecay is decoupled from the loss, and applied
+// through the trust ratio.
+struct LAMB {
+  float learningRate{1e-3f};
+  float decay{};
+  float epsilon{1e-6f};
+  float beta1{0.9f};
+  float beta2{0.999f};
+  float weightDecay{1e-2f};
+};
+
+struct LARS {
+  float learningRate{1e-1f};
+  float decay{};
+  float momentum{0.9f};
+  float weightDecay{};
+  float trustCoefficient{1e-3f};
+};
+
 using OptimizerDescriptor =
-    std::variant<std::monostate, SGD, AdaGrad, RMSProp, Adam>;
+    std::variant<std::monostate, SGD, AdaGrad, RMSProp, Adam, LAMB, LARS>;
 
 struct FeedForwardTrainingDescriptor {
   LossDescriptor loss{};
@@ -100,5 +260,31 @@ struct FeedForwardTrainingDescriptor {
   bool shuffleBatches{true};
   // If true, prints update messages every ~0.5s
   bool verbose{true};
+  // If true, training keeps layer activations only at the end of every
+  // ~sqrt(layer_num) layers, and recomputes the rest one segment at a time
+  // during the backward pass. Trades about one extra forward pass for memory.
+  // Ignored by GraphModel
+  bool gradientCheckpointing{false};
+  // Micro-batches (of batchSize samples each) whose gradients are averaged
+  // into every optimizer update, so the effective batch is
+  // batchSize * gradientAccumulationSteps while activations only take memory
+  // for batchSize samples. The last step of an epoch may have fewer
+  // micro-batches
+  size_t gradientAccumulationSteps{1};
+  // Replicas of the model every batch is split between (synchronous data
+  // parallelism). Each replica runs the forward and backward passes of its
+  // batchSize / dataParallelReplicas samples on its own threads, and their
+  // gradients are averaged into a single optimizer update, which is then
+  // copied to every replica. batchSize must be divisible by it. Batch norm
+  // statistics are computed per replica, and the model keeps the running
+  // statistics of the first one. Not supported by sampled softmax or GraphModel
+  size_t dataParallelReplicas{1};
+  // If true, the optimizer state (e.g. Adam's momentums and cache) is kept
+  // 8-bit blockwise-quantized, taking ~1/4 of its full precision memory
+  bool quantizedOptimizerState{false};
+  // Batches between update messages written to the log file (the last batch
+  // of every epoch is always logged). Messages report running averages over
+  // the epoch, so logging doesn't recompute anything per batch
+  size_t logInterval{100};
 };
 } // namespace ANN
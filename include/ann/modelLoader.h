@@ -19,6 +19,30 @@ private:
   static void configLayer(Dropout &layer, const std::string &config,
                           const std::string &value,
                           const std::string &lineNumStr);
+  static void configLayer(Conv2D &layer, const std::string &config,
+                          const std::string &value,
+                          const std::string &lineNumStr);
+  static void configLayer(Embedding &layer, const std::string &config,
+                          const std::string &value,
+                          const std::string &lineNumStr);
+  static void configLayer(LSTM &layer, const std::string &config,
+                          const std::string &value,
+                          const std::string &lineNumStr);
+  static void configLayer(GRU &layer, const std::string &config,
+                          const std::string &value,
+                          const std::string &lineNumStr);
+  static void configLayer(MultiHeadAttention &layer, const std::string &config,
+                          const std::string &value,
+                          const std::string &lineNumStr);
+  static void configLayer(BatchNorm &layer, const std::string &config,
+                          const std::string &value,
+                          const std::string &lineNumStr);
+  static void configLayer(MaxPool2D &layer, const std::string &config,
+                          const std::string &value,
+                          const std::string &lineNumStr);
+  static void configLayer(AvgPool2D &layer, const std::string &config,
+                          const std::string &value,
+                          const std::string &lineNumStr);
   static void configLayer(Step &layer, const std::string &config,
                           const std::string &value,
                           const std::string &lineNumStr);
@@ -34,6 +58,20 @@ private:
   static void configLayer(Softmax &layer, const std::string &config,
                           const std::string &value,
                           const std::string &lineNumStr);
+  // Shared configuration of the pooling layers
+  // typeName - layer type as written in model files (for exception formatting)
+  template <typename PoolDescriptor>
+  static void configPool(PoolDescriptor &layer, std::string_view typeName,
+                         const std::string &config, const std::string &value,
+                         const std::string &lineNumStr);
+  // Shared configuration of the recurrent layers
+  // typeName - layer type as written in model files (for exception formatting)
+  template <typename RecurrentDescriptor>
+  static void configRecurrent(RecurrentDescriptor &layer,
+                              std::string_view typeName,
+                              const std::string &config,
+                              const std::string &value,
+                              const std::string &lineNumStr);
 
   // Handles changing optimizer configuration by type (for easy use with
   // std::visit)
@@ -49,6 +87,12 @@ private:
   static void configOptimizer(Adam &optimizer, const std::string &config,
                               const std::string &value,
                               const std::string &lineNumStr);
+  static void configOptimizer(LAMB &optimizer, const std::string &config,
+                              const std::string &value,
+                              const std::string &lineNumStr);
+  static void configOptimizer(LARS &optimizer, const std::string &config,
+                              const std::string &value,
+                              const std::string &lineNumStr);
 
   // Trims whitespace from str (left and right)
   static void trim(std::string &str);
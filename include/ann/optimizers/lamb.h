@@ -0,0 +1,49 @@
+#pragma once
+
+#include "optimizer.h"
+
+namespace ANN {
+namespace Optimizers {
+// Layer-wise adaptive Adam (LAMB). The Adam step of every parameter tensor,
+// plus weight decay, is scaled by the tensor's trust ratio
+// ||values|| / ||step||, which keeps large-batch training stable.
+class LAMB : public Optimizer {
+public:
+  LAMB(float learningRate = 1e-3f, float decay = 0, float epsilon = 1e-6f,
+       float beta1 = 0.9f, float beta2 = 0.999f, float weightDecay = 1e-2f)
+      : m_startingLearningRate{learningRate}, m_learningRate{learningRate},
+        m_decay{decay}, m_epsilon{epsilon}, m_beta1{beta1}, m_beta2{beta2},
+        m_weightDecay{weightDecay} {};
+
+  void preUpdate();
+
+  void postUpdate();
+
+  float learningRate() const { return m_learningRate; }
+
+protected:
+  void updateRange(const Range &range) const;
+
+  size_t itemCost() const { return 15; }
+
+  bool usesMomentums() const { return true; }
+  bool usesCache() const { return true; }
+
+  // Squared norms of the values and of the steps
+  size_t sumCount() const { return 2; }
+
+  // Updates momentums and cache, and measures the norms
+  void measureRange(const Range &range, float *sums) const;
+
+private:
+  float m_startingLearningRate{};
+  float m_learningRate{};
+  float m_decay{};
+  float m_epsilon{};
+  float m_beta1{};
+  float m_beta2{};
+  float m_weightDecay{};
+  float m_iteration{1};
+};
+} // namespace Optimizers
+} // namespace ANN
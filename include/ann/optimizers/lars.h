@@ -0,0 +1,48 @@
+#pragma once
+
+#include "optimizer.h"
+
+namespace ANN {
+namespace Optimizers {
+// Layer-wise adaptive SGD (LARS). The learning rate of every parameter tensor
+// is scaled by its trust ratio
+// trustCoefficient * ||values|| / (||gradients|| + weightDecay * ||values||),
+// which keeps large-batch training stable.
+class LARS : public Optimizer {
+public:
+  LARS(float learningRate = 1e-1f, float decay = 0, float momentum = 0.9f,
+       float weightDecay = 0, float trustCoefficient = 1e-3f)
+      : m_startingLearningRate{learningRate}, m_learningRate{learningRate},
+        m_decay{decay}, m_momentum{momentum}, m_weightDecay{weightDecay},
+        m_trustCoefficient{trustCoefficient} {};
+
+  void preUpdate();
+
+  void postUpdate();
+
+  float learningRate() const { return m_learningRate; }
+
+protected:
+  void updateRange(const Range &range) const;
+
+  size_t itemCost() const { return 6; }
+
+  bool usesMomentums() const { return m_momentum != 0; }
+  bool usesCache() const { return false; }
+
+  // Squared norms of the values and of the gradients
+  size_t sumCount() const { return 2; }
+
+  void measureRange(const Range &range, float *sums) const;
+
+private:
+  float m_startingLearningRate{};
+  float m_learningRate{};
+  float m_decay{};
+  float m_momentum{};
+  float m_weightDecay{};
+  float m_trustCoefficient{};
+  float m_iteration{1};
+};
+} // namespace Optimizers
+} // namespace ANN
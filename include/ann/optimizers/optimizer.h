@@ -1,6 +1,11 @@
 #pragma once
 
-#include "ann/layers/dense.h"
+#include "ann/parameter.h"
+
+#include <cmath>
+#include <cstdint>
+#include <span>
+#include <vector>
 
 namespace ANN {
 namespace Optimizers {
@@ -11,11 +16,156 @@ public:
 
   virtual void preUpdate() = 0;
 
-  virtual void updateParams(Layers::Dense &layer) const = 0;
+  // Updates all given parameters (e.g. every trainable parameter of a model)
+  // in a single parallel pass over their items.
+  // The optimizer state of the parameters is kept in flat arenas, laid out in
+  // the order of params. Only the state the optimizer uses is allocated (see
+  // usesMomentums() and usesCache()), on the first update, so models which are
+  // never trained don't hold any. It's reset whenever the given parameters
+  // aren't the ones it was allocated for. The state of column-sparse
+  // parameters is laid out by columns, so a touched column's state is
+  // contiguous while its values are gathered one block at a time.
+  // Regularized parameters get the L1/L2 penalties' derivatives added to
+  // their gradients by the update kernels, and their penalty is refreshed
+  // from every updated range while it's still in cache (see Parameter).
+  void update(std::span<const Parameter> params);
 
   virtual void postUpdate() = 0;
 
   virtual float learningRate() const = 0;
+
+  // Whether the optimizer state is kept 8-bit quantized, in blocks of
+  // quantizationBlock items sharing a single scale. Every block is
+  // dequantized right before its items are updated and quantized back right
+  // after, so the state takes ~1/4 of the memory. Changing it resets the state
+  void setQuantizedState(bool quantized);
+  bool isStateQuantized() const { return m_quantized; }
+
+protected:
+  // Contiguous items of a single parameter, with their gradients and
+  // optimizer state (null for state the optimizer doesn't use)
+  struct Range {
+    float *values{};
+    const float *gradients{};
+    float *momentums{};
+    float *cache{};
+    size_t count{};
+    // Sums measureRange() gathered over the range's whole parameter (null if
+    // the optimizer gathers none)
+    const float *sums{};
+    // Regularization strengths of the range's parameter
+    float l1{};
+    float l2{};
+  };
+
+  // Returns gradient with the derivatives of the L1/L2 penalties of value
+  // added. Update kernels use it in place of the raw gradients
+  static float regularize(float gradient, float value, float l1, float l2) {
+    return gradient + l1 * std::copysign(1.0f, value) + 2 * l2 * value;
+  }
+
+  // Updates every item of range in a single tight loop
+  virtual void updateRange(const Range &range) const = 0;
+
+  // Number of per-parameter sums (e.g. squared norms) the optimizer gathers
+  // before updating. Optimizers which gather any (e.g. layer-wise trust
+  // ratios) get a first parallel pass of measureRange() over every range, and
+  // each parameter's sums are then reduced and passed to updateRange()
+  virtual size_t sumCount() const { return 0; }
+
+  // Adds the range's contributions to sums (sumCount() items)
+  virtual void measureRange(const Range &, float *) const {}
+
+  // Estimated operation cost of a single item update
+  virtual size_t itemCost() const = 0;
+
+  // Whether the optimizer keeps momentums/cache per parameter item
+  virtual bool usesMomentums() const = 0;
+  virtual bool usesCache() const = 0;
+
+private:
+  // Items of a dense parameter updated by a single parallel iteration
+  static constexpr size_t chunkSize{4096};
+  // Items sharing a scale in quantized state. Dense parameters are split into
+  // blocks from their start, and sparse parameters from every row's start (so
+  // a row's update never touches blocks of other rows)
+  static constexpr size_t quantizationBlock{256};
+
+  // Range of a single parameter, before resolving it into pointers. Items
+  // of column-sparse parameters are stride values apart
+  struct Chunk {
+    size_t param{};
+    size_t valueStart{};
+    size_t gradientStart{};
+    size_t count{};
+    size_t stateStart{};
+    size_t stride{1};
+  };
+
+  // Parameter the state is allocated for
+  struct Binding {
+    std::span<float> values{};
+    bool sparseColumns{};
+  };
+
+  // Allocates zeroed state for params, unless it's already allocated for them
+  void bind(std::span<const Parameter> params);
+
+  // Returns the range of the given chunk of params (without state pointers if
+  // the state is quantized, and with the first of the chunk's values if
+  // they're strided)
+  Range range(std::span<const Parameter> params, size_t chunk);
+
+  // Calls function with the range of the given chunk of params. Quantized
+  // state and strided values are gathered into scratch one block at a time,
+  // so function is called once per block, and they're written back after it
+  template <typename Function>
+  void visit(std::span<const Parameter> params, size_t chunk,
+             Function &&function);
+
+  // Returns the first quantization block of the given chunk
+  size_t firstBlock(std::span<const Parameter> params, size_t chunk) const;
+
+  // Gathers the per-parameter sums of params (see sumCount())
+  void measure(std::span<const Parameter> params);
+
+  // Updates the given chunk of params, and stores the change of its
+  // regularization loss in m_chunkPenalties (for regularized parameters)
+  void updateChunk(std::span<const Parameter> params, size_t chunk);
+
+  // Applies the chunks' regularization loss changes to the parameters'
+  // penalties
+  void trackPenalties(std::span<const Parameter> params);
+
+  // Splits params into chunks covering every item which has a gradient. Dense
+  // parameters are split into chunks of chunkSize items, and sparse parameters
+  // into their touched rows, so the cost scales with the gradients and not
+  // with the whole parameter.
+  void split(std::span<const Parameter> params);
+
+  // Parameters the state is allocated for
+  std::vector<Binding> m_bound{};
+  // Offset of every bound parameter in the state arenas
+  std::vector<size_t> m_offsets{};
+  std::vector<float> m_momentums{};
+  std::vector<float> m_cache{};
+
+  // Quantized state (replacing m_momentums and m_cache), with the scale of
+  // every block, and the first block of every bound parameter
+  bool m_quantized{};
+  std::vector<int8_t> m_quantizedMomentums{};
+  std::vector<uint8_t> m_quantizedCache{};
+  std::vector<float> m_momentumScales{};
+  std::vector<float> m_cacheScales{};
+  std::vector<size_t> m_blockOffsets{};
+
+  // Chunks of the current update, the sums gathered over every chunk and
+  // parameter, and the regularization loss change of every chunk (kept to
+  // reuse their storage)
+  std::vector<Chunk> m_chunks{};
+  std::vector<float> m_chunkSums{};
+  std::vector<float> m_sums{};
+  std::vector<float> m_chunkPenalties{};
 };
 } // namespace Optimizers
 } // namespace ANN
@@ -1,6 +1,5 @@
 #pragma once
 
-#include "ann/layers/dense.h"
 #include "optimizer.h"
 
 namespace ANN {
@@ -14,12 +13,18 @@ public:
 
   void preUpdate();
 
-  void updateParams(Layers::Dense &layer) const;
-
   void postUpdate();
 
   float learningRate() const { return m_learningRate; }
 
+protected:
+  void updateRange(const Range &range) const;
+
+  size_t itemCost() const { return 10; }
+
+  bool usesMomentums() const { return false; }
+  bool usesCache() const { return true; }
+
 private:
   float m_startingLearningRate{};
   float m_learningRate{};
@@ -1,6 +1,5 @@
 #pragma once
 
-#include "ann/layers/dense.h"
 #include "optimizer.h"
 
 namespace ANN {
@@ -13,12 +12,18 @@ public:
 
   void preUpdate();
 
-  void updateParams(Layers::Dense &layer) const;
-
   void postUpdate();
 
   float learningRate() const { return m_learningRate; }
 
+protected:
+  void updateRange(const Range &range) const;
+
+  size_t itemCost() const { return 4; }
+
+  bool usesMomentums() const { return m_momentum != 0; }
+  bool usesCache() const { return false; }
+
 private:
   float m_startingLearningRate{};
   float m_learningRate{};
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+
+namespace ANN {
+// Non-owning handle to a single trainable tensor of a layer (e.g. weights or
+// biases), together with its gradients. Both spans are of the same size,
+// except for gradients of sparse parameters. The optimizer state kept for it
+// is owned by the optimizer (see Optimizers::Optimizer::update()).
+struct Parameter {
+  std::span<float> values{};
+  std::span<const float> gradients{};
+
+  // Sparse parameters (e.g. embedding tables) only have gradients for some of
+  // their rows. rows holds the unique indices of those rows, and gradients
+  // holds rows.size() rows of rowSize items in the same order. Dense
+  // parameters leave both empty.
+  std::span<const size_t> rows{};
+  size_t rowSize{};
+
+  // L1/L2 regularization strengths. The optimizer adds the penalties'
+  // derivatives to the gradients as part of its update, and keeps penalty (if
+  // given) equal to the regularization loss of values (see
+  // regularizationLoss()). Sparse parameters are only regularized on their
+  // touched rows.
+  float l1{};
+  float l2{};
+  float *penalty{};
+
+  // Sparse parameters with sparseColumns set only have gradients for some of
+  // their columns instead (e.g. the weights of sampled output classes). values
+  // is then a row-major matrix of rowSize rows, rows holds the indices of the
+  // touched columns, and gradients holds each of them contiguously
+  bool sparseColumns{};
+
+  bool isSparse() const { return rowSize != 0; }
+  bool isRegularized() const { return l1 != 0 || l2 != 0; }
+};
+
+// Returns l1 * sum(|value|) + l2 * sum(value^2) over values
+float regularizationLoss(std::span<const float> values, float l1, float l2);
+} // namespace ANN
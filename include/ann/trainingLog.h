@@ -0,0 +1,106 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <thread>
+
+namespace ANN {
+// Asynchronous sink of training progress messages. The training loop pushes
+// compact records into a lock-free single-producer/single-consumer ring
+// buffer, and a writer thread formats them and writes them to the console
+// and/or the log file, so no formatting or I/O happens on the training thread.
+// Output is the same as writing the messages directly, and is complete once
+// the log is destroyed.
+class TrainingLog {
+public:
+  // Progress of a single training step
+  struct Update {
+    size_t batch{};
+    size_t steps{};
+    double epochTime{};
+    // -1 for losses without accuracy
+    float accuracy{-1};
+    float dataLoss{};
+    float regularizationLoss{};
+    float learningRate{};
+  };
+
+  // verbose - whether messages are written to the console
+  // file - log file, or a closed stream for no log file
+  TrainingLog(bool verbose, std::ofstream file);
+
+  TrainingLog(const TrainingLog &other) = delete;
+  TrainingLog &operator=(const TrainingLog &other) = delete;
+
+  // Writes every pushed record, then stops the writer thread
+  ~TrainingLog();
+
+  bool isVerbose() const { return m_verbose; }
+  bool hasFile() const { return m_hasFile; }
+
+  // Messages of train(), in the order they're written
+  void plannedMemory(size_t bytes);
+  void epoch(size_t epoch);
+  // toConsole/toFile select where the update is written (each is ignored
+  // when its output is off)
+  void update(const Update &update, bool toConsole, bool toFile);
+  void validation(float loss, float accuracy);
+  void epochEnd();
+
+  // Formats given time into string with units - ns, us, ms, or s
+  static std::string formatTime(double seconds);
+
+  // Formats given byte count into string with units - B, KiB, MiB or GiB
+  static std::string formatBytes(size_t bytes);
+
+private:
+  enum class Kind : uint8_t {
+    PlannedMemory,
+    Epoch,
+    Update,
+    Validation,
+    EpochEnd,
+    Stop,
+  };
+
+  struct Record {
+    Kind kind{};
+    bool toConsole{};
+    bool toFile{};
+    // Planned bytes or epoch number
+    size_t count{};
+    // Step progress, or validation loss (dataLoss) and accuracy
+    Update update{};
+  };
+
+  // Records the buffer holds. Once it's full, the training thread waits for
+  // the writer (which only happens if the writer can't keep up at all)
+  static constexpr uint32_t capacity{256};
+
+  // Adds record to the buffer, and wakes the writer
+  void push(const Record &record);
+
+  // Writer thread - formats records until a Stop record
+  void write();
+
+  void format(const Record &record);
+
+  bool m_verbose{};
+  // Whether file was open, set before the writer thread starts (which owns
+  // m_file from then on), so the training thread doesn't touch the stream
+  const bool m_hasFile{};
+  std::ofstream m_file{};
+
+  std::array<Record, capacity> m_records{};
+  // Counts of records written by the writer and pushed by the training thread
+  // (wrapping, indexed modulo capacity)
+  std::atomic<uint32_t> m_head{};
+  std::atomic<uint32_t> m_tail{};
+
+  std::thread m_writer{};
+};
+} // namespace ANN
@@ -4,6 +4,7 @@
 #include "math/vector.h"
 
 #include <array>
+#include <cstdint>
 #include <fstream>
 #include <string>
 #include <string_view>
@@ -13,7 +14,8 @@ namespace Loaders {
 class MNist {
 public:
   // a type which contains a vector of labels and a matching vector of images
-  using DataPair = std::tuple<Math::Vector<float>, Math::Matrix<float>>;
+  // Labels are stored as integers, which the categorical losses read directly
+  using DataPair = std::tuple<Math::Vector<uint16_t>, Math::Matrix<float>>;
 
   MNist(std::string_view trainingLabelsPath,
         std::string_view trainingImagesPath, std::string_view testingLabelsPath,
@@ -41,7 +43,7 @@ private:
   static DataPair loadImages(const std::string &labelsPath,
                              const std::string &imagesPath);
 
-  static Math::Vector<float> loadLabelsFile(const std::string &labelsPath);
+  static Math::Vector<uint16_t> loadLabelsFile(const std::string &labelsPath);
 
   static Math::Matrix<float> loadImagesFile(const std::string &imagesPath);
 
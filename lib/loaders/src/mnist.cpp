@@ -24,7 +24,7 @@ MNist::DataPair MNist::loadImages(const std::string &labelsPath,
   return std::make_tuple(std::move(labels), std::move(images));
 }
 
-Math::Vector<float> MNist::loadLabelsFile(const std::string &labelsPath) {
+Math::Vector<uint16_t> MNist::loadLabelsFile(const std::string &labelsPath) {
   std::ifstream labelsFile{labelsPath, std::ios::binary | std::ios::in};
 
   // testing number which should always be 2049
@@ -39,17 +39,17 @@ Math::Vector<float> MNist::loadLabelsFile(const std::string &labelsPath) {
   // file)
   unsigned int size{readU32(labelsFile, labelsPath)};
 
-  Math::Vector<float> labels{size};
+  Math::Vector<uint16_t> labels{size};
 
   labels.fill(
-      [&labelsFile, &labelsPath](float *item) {
+      [&labelsFile, &labelsPath](uint16_t *item) {
         unsigned char byte{};
         if (!labelsFile.read(reinterpret_cast<char *>(&byte), 1))
           throw Loaders::Exception{
               CURRENT_FUNCTION,
               "Can't read file " + labelsPath +
                   ": file size smaller then needed to read all images."};
-        *item = static_cast<float>(byte);
+        *item = byte;
       },
       false);
 
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "matrix.h"
+#include "matrixBase.h"
+
+#include <optional>
+
+namespace Math {
+
+// Returns the output size of a single convolved dimension
+// Throws if the kernel doesn't fit in the padded input
+size_t convOutputSize(size_t inputSize, size_t kernelSize, size_t stride,
+                      size_t padding);
+
+// Unfolds every kernel-sized patch of the given images into a row.
+// images - (batch_num, height * width * channels), each row an image stored in
+//          (height, width, channels) order
+// Returns matrix of dims (batch_num * out_height * out_width,
+// kernel_size * kernel_size * channels), where each row is a single patch
+// stored in (kernel_row, kernel_col, channel) order. Padded values are 0.
+// parallelize - should unfolding be parallized. If provided empty, will
+//               parallelize automatically as seen needed
+template <typename T>
+Matrix<T> im2col(const MatrixBase<T> &images, size_t height, size_t width,
+                 size_t channels, size_t kernelSize, size_t stride,
+                 size_t padding, std::optional<bool> parallelize = std::nullopt);
+
+// Inverse of im2col: sums every patch row back into its image position.
+// cols - matrix in the format returned by im2col()
+// Returns matrix of dims (batch_num, height * width * channels)
+// parallelize - should folding be parallized. If provided empty, will
+//               parallelize automatically as seen needed
+template <typename T>
+Matrix<T> col2im(const MatrixBase<T> &cols, size_t batches, size_t height,
+                 size_t width, size_t channels, size_t kernelSize,
+                 size_t stride, size_t padding,
+                 std::optional<bool> parallelize = std::nullopt);
+
+// im2col() written into an existing matrix
+// cols - output matrix. Resized with its storage kept (see Matrix::resize()),
+//        so reusing it across calls avoids allocations
+template <typename T>
+void im2col(const MatrixBase<T> &images, size_t height, size_t width,
+            size_t channels, size_t kernelSize, size_t stride, size_t padding,
+            Matrix<T> &cols, std::optional<bool> parallelize = std::nullopt);
+
+// col2im() written into an existing matrix
+// images - output matrix. Resized the same way as im2col()'s cols
+template <typename T>
+void col2im(const MatrixBase<T> &cols, size_t batches, size_t height,
+            size_t width, size_t channels, size_t kernelSize, size_t stride,
+            size_t padding, Matrix<T> &images,
+            std::optional<bool> parallelize = std::nullopt);
+
+}; // namespace Math
+
+// Include template function implementation file
+#include "convolution.tpp"
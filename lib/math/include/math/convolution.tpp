@@ -0,0 +1,147 @@
+#pragma once
+
+#include "convolution.h"
+
+#include "exception.h"
+#include "matrix.h"
+#include "utils/exceptions.h"
+
+#include "utils/parallel.h"
+
+namespace Math {
+
+inline size_t convOutputSize(size_t inputSize, size_t kernelSize,
+                             size_t stride, size_t padding) {
+  if (kernelSize == 0 || stride == 0)
+    throw Math::Exception{CURRENT_FUNCTION,
+                          "Kernel size and stride must be positive"};
+  if (kernelSize > inputSize + 2 * padding)
+    throw Math::Exception{CURRENT_FUNCTION,
+                          "Kernel doesn't fit inside the padded input"};
+
+  return (inputSize + 2 * padding - kernelSize) / stride + 1;
+}
+
+template <typename T>
+Matrix<T> im2col(const MatrixBase<T> &images, size_t height, size_t width,
+                 size_t channels, size_t kernelSize, size_t stride,
+                 size_t padding, std::optional<bool> parallelize) {
+  Matrix<T> cols{};
+  im2col(images, height, width, channels, kernelSize, stride, padding, cols,
+         parallelize);
+  return cols;
+}
+
+template <typename T>
+void im2col(const MatrixBase<T> &images, size_t height, size_t width,
+            size_t channels, size_t kernelSize, size_t stride, size_t padding,
+            Matrix<T> &cols, std::optional<bool> parallelize) {
+  if (images.cols() != height * width * channels)
+    throw Math::Exception{
+        CURRENT_FUNCTION,
+        "Image matrix's col number doesn't match height * width * channels"};
+
+  const size_t outHeight{convOutputSize(height, kernelSize, stride, padding)};
+  const size_t outWidth{convOutputSize(width, kernelSize, stride, padding)};
+
+  // Padding positions are left 0
+  cols.resize(images.rows() * outHeight * outWidth,
+              kernelSize * kernelSize * channels);
+
+  // Each iteration unfolds a single row of output positions of one image
+  const auto unfoldRow{[&](size_t i) {
+    const size_t batch{i / outHeight};
+    const size_t outY{i % outHeight};
+
+    for (size_t outX{}; outX < outWidth; ++outX) {
+      const size_t row{i * outWidth + outX};
+      for (size_t ky{}; ky < kernelSize; ++ky) {
+        // Skip rows inside the padding (already 0-filled)
+        if (outY * stride + ky < padding ||
+            outY * stride + ky - padding >= height)
+          continue;
+        const size_t inY{outY * stride + ky - padding};
+
+        for (size_t kx{}; kx < kernelSize; ++kx) {
+          if (outX * stride + kx < padding ||
+              outX * stride + kx - padding >= width)
+            continue;
+          const size_t inX{outX * stride + kx - padding};
+
+          const size_t colStart{(ky * kernelSize + kx) * channels};
+          const size_t imageStart{(inY * width + inX) * channels};
+          for (size_t c{}; c < channels; ++c)
+            cols[row, colStart + c] = images[batch, imageStart + c];
+        }
+      }
+    }
+  }};
+
+  // Operation cost per iteration (a copy per patch value)
+  const size_t cost{outWidth * kernelSize * kernelSize * channels};
+
+  Utils::Parallel::dynamicParallelFor(cost, images.rows() * outHeight,
+                                      unfoldRow, parallelize);
+}
+
+template <typename T>
+Matrix<T> col2im(const MatrixBase<T> &cols, size_t batches, size_t height,
+                 size_t width, size_t channels, size_t kernelSize,
+                 size_t stride, size_t padding,
+                 std::optional<bool> parallelize) {
+  Matrix<T> images{};
+  col2im(cols, batches, height, width, channels, kernelSize, stride, padding,
+         images, parallelize);
+  return images;
+}
+
+template <typename T>
+void col2im(const MatrixBase<T> &cols, size_t batches, size_t height,
+            size_t width, size_t channels, size_t kernelSize, size_t stride,
+            size_t padding, Matrix<T> &images,
+            std::optional<bool> parallelize) {
+  const size_t outHeight{convOutputSize(height, kernelSize, stride, padding)};
+  const size_t outWidth{convOutputSize(width, kernelSize, stride, padding)};
+
+  if (cols.rows() != batches * outHeight * outWidth ||
+      cols.cols() != kernelSize * kernelSize * channels)
+    throw Math::Exception{CURRENT_FUNCTION,
+                          "Column matrix's dimensions don't match the given "
+                          "image and kernel dimensions"};
+
+  // Patch values are summed into a 0-filled matrix
+  images.resize(batches, height * width * channels);
+
+  // Patches of the same image overlap, so each iteration folds a whole image
+  const auto foldImage{[&](size_t batch) {
+    for (size_t outY{}; outY < outHeight; ++outY)
+      for (size_t outX{}; outX < outWidth; ++outX) {
+        const size_t row{(batch * outHeight + outY) * outWidth + outX};
+        for (size_t ky{}; ky < kernelSize; ++ky) {
+          if (outY * stride + ky < padding ||
+              outY * stride + ky - padding >= height)
+            continue;
+          const size_t inY{outY * stride + ky - padding};
+
+          for (size_t kx{}; kx < kernelSize; ++kx) {
+            if (outX * stride + kx < padding ||
+                outX * stride + kx - padding >= width)
+              continue;
+            const size_t inX{outX * stride + kx - padding};
+
+            const size_t colStart{(ky * kernelSize + kx) * channels};
+            const size_t imageStart{(inY * width + inX) * channels};
+            for (size_t c{}; c < channels; ++c)
+              images[batch, imageStart + c] += cols[row, colStart + c];
+          }
+        }
+      }
+  }};
+
+  // Operation cost per iteration (an addition per patch value)
+  const size_t cost{outHeight * outWidth * kernelSize * kernelSize * channels};
+
+  Utils::Parallel::dynamicParallelFor(cost, batches, foldImage, parallelize);
+}
+
+}; // namespace Math
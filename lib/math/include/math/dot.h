@@ -59,6 +59,34 @@ template <typename T>
 Matrix<T> dotTB(const MatrixBase<T> &ma, const MatrixBase<T> &mb,
                 std::optional<bool> parallelize = std::nullopt);
 
+// dot(a, b), written into an existing matrix
+// Iterates in (row of a, row of b) order, so no transposition is needed for
+// cache friendliness
+// result - output matrix. Resized if its dimensions don't match, which keeps
+//          its storage (see Matrix::resize()), so reusing it across calls
+//          avoids allocations
+// parallelize - should dot product be parallized. If provided empty, will
+//               parallelize automatically as seen needed
+template <typename T>
+void dot(const MatrixBase<T> &ma, const MatrixBase<T> &mb, Matrix<T> &result,
+         std::optional<bool> parallelize = std::nullopt);
+
+// dot(a^T, b), written into an existing matrix
+// Same iteration order and result handling as the dot() overload above
+template <typename T>
+void dotTA(const MatrixBase<T> &ma, const MatrixBase<T> &mb, Matrix<T> &result,
+           std::optional<bool> parallelize = std::nullopt);
+
+// dot(a, b^T), written into an existing matrix
+// result - output matrix. Resized if its dimensions don't match, which keeps
+//          its storage (see Matrix::resize()), so reusing it across calls
+//          avoids allocations
+// parallelize - should dot product be parallized. If provided empty, will
+//               parallelize automatically as seen needed
+template <typename T>
+void dotTB(const MatrixBase<T> &ma, const MatrixBase<T> &mb, Matrix<T> &result,
+           std::optional<bool> parallelize = std::nullopt);
+
 }; // namespace Math
 
 // Include template function implementation file
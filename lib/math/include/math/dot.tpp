@@ -9,6 +9,7 @@
 
 #include "utils/parallel.h"
 
+#include <algorithm>
 #include <vector>
 
 namespace Math {
@@ -140,9 +141,108 @@ Matrix<T> dotTA(const MatrixBase<T> &ma, const MatrixBase<T> &mb,
   return result;
 }
 
+template <typename T>
+void dot(const MatrixBase<T> &ma, const MatrixBase<T> &mb, Matrix<T> &result,
+         std::optional<bool> parallelize) {
+  if (ma.cols() != mb.rows())
+    throw Math::Exception{
+        CURRENT_FUNCTION,
+        "Can't compute the dot product of two matrices where the first "
+        "matrix's col number isn't the same as the second matrix's row number"};
+
+  if (result.rows() != ma.rows() || result.cols() != mb.cols())
+    result.resize(ma.rows(), mb.cols());
+
+  if (result.rows() == 0 || result.cols() == 0)
+    return;
+  if (ma.cols() == 0) {
+    std::fill(result.data().begin(), result.data().end(), T{});
+    return;
+  }
+
+  // Matrices are stored as a single contiguous block, so items are read
+  // through raw pointers instead of the virtual operator[]
+  const T *dataA{&ma[0, 0]};
+  const T *dataB{&mb[0, 0]};
+  const size_t colsA{ma.cols()};
+  const size_t colsB{mb.cols()};
+
+  const auto computeRow{[&result, dataA, dataB, colsA, colsB](size_t i) {
+    // The result row is accumulated from whole rows of b, which vectorizes
+    // without transposing b
+    T *row{&result[i, 0]};
+    std::fill_n(row, colsB, T{});
+    for (size_t k{}; k < colsA; ++k) {
+      const T a{dataA[i * colsA + k]};
+      const T *rowB{dataB + k * colsB};
+      for (size_t j{}; j < colsB; ++j)
+        row[j] += a * rowB[j];
+    }
+  }};
+
+  // Operation cost per iteration (n additions and multiplications)
+  const size_t cost{2 * mb.cols() * ma.cols()};
+
+  Utils::Parallel::dynamicParallelFor(cost, ma.rows(), computeRow, parallelize);
+}
+
+template <typename T>
+void dotTA(const MatrixBase<T> &ma, const MatrixBase<T> &mb, Matrix<T> &result,
+           std::optional<bool> parallelize) {
+  if (ma.rows() != mb.rows())
+    throw Math::Exception{
+        CURRENT_FUNCTION,
+        "Can't compute the \"transposed\" dot product of two matrices where "
+        "the first matrix's row number isn't the same as the second matrix's "
+        "row number"};
+
+  if (result.rows() != ma.cols() || result.cols() != mb.cols())
+    result.resize(ma.cols(), mb.cols());
+
+  if (result.rows() == 0 || result.cols() == 0)
+    return;
+  if (ma.rows() == 0) {
+    std::fill(result.data().begin(), result.data().end(), T{});
+    return;
+  }
+
+  // Matrices are stored as a single contiguous block, so items are read
+  // through raw pointers instead of the virtual operator[]
+  const T *dataA{&ma[0, 0]};
+  const T *dataB{&mb[0, 0]};
+  const size_t rowsA{ma.rows()};
+  const size_t colsA{ma.cols()};
+  const size_t colsB{mb.cols()};
+
+  const auto computeRow{[&result, dataA, dataB, rowsA, colsA,
+                         colsB](size_t i) {
+    T *row{&result[i, 0]};
+    std::fill_n(row, colsB, T{});
+    for (size_t k{}; k < rowsA; ++k) {
+      const T a{dataA[k * colsA + i]};
+      const T *rowB{dataB + k * colsB};
+      for (size_t j{}; j < colsB; ++j)
+        row[j] += a * rowB[j];
+    }
+  }};
+
+  // Operation cost per iteration (n additions and multiplications)
+  const size_t cost{2 * mb.cols() * ma.rows()};
+
+  Utils::Parallel::dynamicParallelFor(cost, ma.cols(), computeRow, parallelize);
+}
+
 template <typename T>
 Matrix<T> dotTB(const MatrixBase<T> &ma, const MatrixBase<T> &mb,
                 std::optional<bool> parallelize) {
+  Matrix<T> result{};
+  dotTB(ma, mb, result, parallelize);
+  return result;
+}
+
+template <typename T>
+void dotTB(const MatrixBase<T> &ma, const MatrixBase<T> &mb, Matrix<T> &result,
+           std::optional<bool> parallelize) {
   if (ma.cols() != mb.cols())
     throw Math::Exception{
         CURRENT_FUNCTION,
@@ -150,23 +250,28 @@ Matrix<T> dotTB(const MatrixBase<T> &ma, const MatrixBase<T> &mb,
         "the first matrix's col number isn't the same as the second matrix's "
         "col number"};
 
-  Matrix<T> result{ma.rows(), mb.rows()};
+  if (result.rows() != ma.rows() || result.cols() != mb.rows())
+    result.resize(ma.rows(), mb.rows());
 
   const auto computeRow{[&result, &ma, &mb](size_t i) {
+    // Rows are contiguous, so raw pointers let the inner loop vectorize
+    // without going through the virtual operator[]
+    const T *rowA{&ma[i, 0]};
     for (size_t j = 0; j < mb.rows(); ++j) {
+      const T *rowB{&mb[j, 0]};
       T sum{};
       size_t k{};
 
       // Unrolling the loop for better performance
       for (; k + 4 <= ma.cols(); k += 4) {
-        sum += ma[i, k] * mb[j, k];
-        sum += ma[i, k + 1] * mb[j, k + 1];
-        sum += ma[i, k + 2] * mb[j, k + 2];
-        sum += ma[i, k + 3] * mb[j, k + 3];
+        sum += rowA[k] * rowB[k];
+        sum += rowA[k + 1] * rowB[k + 1];
+        sum += rowA[k + 2] * rowB[k + 2];
+        sum += rowA[k + 3] * rowB[k + 3];
       }
       // Handle remaining elements
       for (; k < ma.cols(); ++k) {
-        sum += ma[i, k] * mb[j, k];
+        sum += rowA[k] * rowB[k];
       }
       result[i, j] = sum;
     }
@@ -176,8 +281,6 @@ Matrix<T> dotTB(const MatrixBase<T> &ma, const MatrixBase<T> &mb,
   const size_t cost{2 * mb.rows() * ma.cols()};
 
   Utils::Parallel::dynamicParallelFor(cost, ma.rows(), computeRow, parallelize);
-
-  return result;
 }
 
 }; // namespace Math
@@ -77,6 +77,11 @@ public:
   Matrix<T> transpose(size_t chunkSize = 4,
                       std::optional<bool> parallelize = std::nullopt) const;
 
+  // Transposes the matrix into result, which is only resized if its
+  // dimensions don't match (so reusing it across calls avoids allocations)
+  void transpose(Matrix<T> &result, size_t chunkSize = 4,
+                 std::optional<bool> parallelize = std::nullopt) const;
+
   // Single item access - NO BOUNDS CHECKING
   T &operator[](const size_t row, const size_t col);
   const T &operator[](const size_t row, const size_t col) const;
@@ -95,6 +100,18 @@ public:
   // Throws if given (rows * cols) is not equal to current (rows * cols).
   Matrix &reshape(const size_t rows, const size_t cols);
 
+  // Resizes matrix to given dimensions, filled with 0s. Returns *this.
+  // Storage is kept while it can hold (rows * cols) items, so shrinking and
+  // growing back (e.g. a smaller last batch) doesn't reallocate.
+  Matrix &resize(const size_t rows, const size_t cols);
+
+  // Makes storage hold at least (rows * cols) items without changing the
+  // matrix, so resizing up to that size won't reallocate
+  void reserve(const size_t rows, const size_t cols);
+
+  // Number of items the storage holds without reallocating
+  size_t capacity() const { return m_data.capacity(); }
+
   // Get view of the entire matrix.
   const MatrixView<T> view() const;
 
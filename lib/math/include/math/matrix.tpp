@@ -39,8 +39,12 @@ Matrix<T>::Matrix(const size_t rows, const size_t cols)
 
 template <typename T>
 Matrix<T>::Matrix(const MatrixBase<T> &other)
-    : m_data(other.data().size()), m_rows{other.rows()}, m_cols{other.cols()} {
-  std::copy_n(other.data().begin(), m_rows * m_cols, m_data.begin());
+    : m_data(other.rows() * other.cols()), m_rows{other.rows()},
+      m_cols{other.cols()} {
+  // Views share the data of their whole matrix, so their items start at their
+  // first row rather than at the start of data()
+  if (!m_data.empty())
+    std::copy_n(&other[0, 0], m_data.size(), m_data.begin());
 }
 template <typename T>
 Matrix<T>::Matrix(const Matrix<T> &other)
@@ -126,6 +130,16 @@ template <typename T>
 Matrix<T> Matrix<T>::transpose(size_t chunkSize,
                                std::optional<bool> parallelize) const {
   Matrix<T> result{cols(), rows()};
+  transpose(result, chunkSize, parallelize);
+
+  return result;
+}
+
+template <typename T>
+void Matrix<T>::transpose(Matrix<T> &result, size_t chunkSize,
+                          std::optional<bool> parallelize) const {
+  if (result.rows() != cols() || result.cols() != rows())
+    result.resize(cols(), rows());
 
   const size_t cost{cols() * chunkSize * chunkSize};
 
@@ -147,8 +161,6 @@ Matrix<T> Matrix<T>::transpose(size_t chunkSize,
         }
       },
       parallelize);
-
-  return result;
 }
 
 template <typename T>
@@ -221,6 +233,20 @@ Matrix<T> &Matrix<T>::reshape(const size_t rows, const size_t cols) {
   return *this;
 };
 
+template <typename T>
+Matrix<T> &Matrix<T>::resize(const size_t rows, const size_t cols) {
+  m_data.assign(rows * cols, T{});
+  m_rows = rows;
+  m_cols = cols;
+
+  return *this;
+}
+
+template <typename T>
+void Matrix<T>::reserve(const size_t rows, const size_t cols) {
+  m_data.reserve(rows * cols);
+}
+
 template <typename T> const MatrixView<T> Matrix<T>::view() const {
   return MatrixView<T>{0, m_rows, m_cols, m_data};
 }
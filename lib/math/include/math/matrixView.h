@@ -9,6 +9,10 @@ namespace Math {
 
 template <typename T> class Matrix;
 
+template <typename T> class Tensor;
+
+template <typename T> class TensorView;
+
 // Class which mimics Math::Matrix class, but holds a reference to a data vector
 // instead of the data itself. Hence, it has no ownership of the data it holds.
 template <typename T> class MatrixView : public MatrixBase<T> {
@@ -64,6 +68,8 @@ public:
   virtual Math::VectorView<T> asVector();
 
   friend Matrix<T>;
+  friend Tensor<T>;
+  friend TensorView<T>;
 
 private:
   MatrixView(size_t start, size_t rows, size_t cols, const std::vector<T> &data)
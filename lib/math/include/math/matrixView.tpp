@@ -95,8 +95,8 @@ const MatrixView<T> MatrixView<T>::view(size_t startRow, size_t endRow) const {
     throw Math::Exception{CURRENT_FUNCTION,
                           "End row is outside the matrix's bound"};
 
-  return MatrixView<T>{m_start + startRow * m_cols, m_start + endRow - startRow,
-                       m_cols, *m_data};
+  return MatrixView<T>{m_start + startRow * m_cols, endRow - startRow, m_cols,
+                       *m_data};
 }
 
 template <typename T>
@@ -108,7 +108,7 @@ Matrix<T> MatrixView<T>::transpose(size_t chunkSize,
   Utils::Parallel::dynamicParallelFor(
       cost, (rows() + chunkSize - 1) / chunkSize,
       [this, &result, chunkSize](size_t i) {
-        for (size_t j{}; j < cols() / chunkSize; ++j)
+        for (size_t j{}; j < (cols() + chunkSize - 1) / chunkSize; ++j)
           // Process a single block of chunkSizexchunkSize
           for (size_t ci{i * chunkSize};
                ci < std::min((i + 1) * chunkSize, rows()); ++ci)
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "matrix.h"
+#include "matrixBase.h"
+
+#include <optional>
+
+namespace Math {
+
+// Normalization of a single softmax row
+// max - largest input (every exponent is taken relative to it)
+// sum - sum of exp(input - max) over the row
+// argmax - index of the first largest input
+template <typename T> struct SoftmaxRow {
+  T max{};
+  T sum{};
+  size_t argmax{};
+};
+
+// Online softmax of count (> 0) contiguous values: outputs[i] =
+// exp(inputs[i] - max) / sum. Inputs are read once - the row is processed in
+// tiles, each exponentiated against the running max (with the running sum
+// rescaled whenever the max grows), and the outputs are normalized afterwards
+// with a single scale per tile. outputs may be inputs.
+// Returns the row's normalization (e.g. log(sum) + max is its log-sum-exp)
+template <typename T>
+SoftmaxRow<T> softmax(const T *inputs, T *outputs, size_t count);
+
+// Softmax of every row of inputs
+// parallelize - should rows be computed in parallel. If provided empty, will
+//               parallelize automatically as seen needed
+template <typename T>
+Matrix<T> softmax(const MatrixBase<T> &inputs,
+                  std::optional<bool> parallelize = std::nullopt);
+
+// softmax() written into an existing matrix
+// outputs - output matrix. Resized (with its storage kept, see
+//           Matrix::resize()) only if its dimensions don't match inputs', so
+//           reusing it across calls avoids allocations and extra writes
+template <typename T>
+void softmax(const MatrixBase<T> &inputs, Matrix<T> &outputs,
+             std::optional<bool> parallelize = std::nullopt);
+
+}; // namespace Math
+
+// Include template function implementation file
+#include "softmax.tpp"
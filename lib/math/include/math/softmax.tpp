@@ -0,0 +1,142 @@
+#pragma once
+
+#include "softmax.h"
+
+#include "matrix.h"
+
+#include "utils/parallel.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+namespace Math {
+
+// exp() of the softmax kernels. For float, a branchless polynomial (Cephes'
+// expf, within ~2 ulp) which GCC vectorizes, unlike std::exp. Inputs are
+// never positive (values minus their max), and ones below the smallest normal
+// float's exponent give 0
+template <typename T> inline T softmaxExp(T value) {
+  if constexpr (!std::is_same_v<T, float>) {
+    return std::exp(value);
+  } else {
+    const float x{std::max(value, -87.0f)};
+
+    // x = n * ln(2) + r, with n rounded to nearest (|r| <= ln(2) / 2)
+    constexpr float round{12582912.0f}; // 1.5 * 2^23
+    const float n{(x * 1.44269504f + round) - round};
+    const float r{x - n * 0.693359375f + n * 2.12194440e-4f};
+
+    float p{1.9875691500e-4f};
+    p = p * r + 1.3981999507e-3f;
+    p = p * r + 8.3334519073e-3f;
+    p = p * r + 4.1665795894e-2f;
+    p = p * r + 1.6666665459e-1f;
+    p = p * r + 5.0000001201e-1f;
+    p = p * r * r + r + 1;
+
+    // Multiply by 2^n through the exponent bits
+    const int32_t exponent{(static_cast<int32_t>(n) + 127) << 23};
+    return value < -87.0f ? 0.0f : p * std::bit_cast<float>(exponent);
+  }
+}
+
+template <typename T>
+SoftmaxRow<T> softmax(const T *inputs, T *outputs, size_t count) {
+  // Independent partial maxima and sums, so the loops vectorize
+  constexpr size_t lanes{8};
+  // Tiles are small enough to stay in L1 between their max and exponent
+  // loops, and grow for long rows so their running maxima fit on the stack
+  constexpr size_t maxTiles{64};
+  const size_t tile{std::max<size_t>(256, (count + maxTiles - 1) / maxTiles)};
+
+  SoftmaxRow<T> row{-std::numeric_limits<T>::infinity(), 0, 0};
+  // Running max every tile was exponentiated against
+  T tileMaxima[maxTiles];
+
+  size_t tiles{};
+  for (size_t start{}; start < count; start += tile, ++tiles) {
+    const T *in{inputs + start};
+    T *out{outputs + start};
+    const size_t size{std::min(tile, count - start)};
+    const size_t body{size - size % lanes};
+
+    T maxima[lanes];
+    std::fill_n(maxima, lanes, -std::numeric_limits<T>::infinity());
+    for (size_t i{}; i < body; i += lanes)
+      for (size_t j{}; j < lanes; ++j)
+        maxima[j] = std::max(maxima[j], in[i + j]);
+    for (size_t i{body}; i < size; ++i)
+      maxima[0] = std::max(maxima[0], in[i]);
+    const T tileMax{*std::max_element(maxima, maxima + lanes)};
+
+    // Rescale the sum so far to the new max
+    if (tileMax > row.max) {
+      row.argmax =
+          start + static_cast<size_t>(std::find(in, in + size, tileMax) - in);
+      row.sum *= std::exp(row.max - tileMax);
+      row.max = tileMax;
+    }
+
+    const T max{row.max};
+    T sums[lanes]{};
+    for (size_t i{}; i < body; i += lanes)
+      for (size_t j{}; j < lanes; ++j) {
+        out[i + j] = softmaxExp(in[i + j] - max);
+        sums[j] += out[i + j];
+      }
+    for (size_t i{body}; i < size; ++i) {
+      out[i] = softmaxExp(in[i] - max);
+      sums[0] += out[i];
+    }
+    for (size_t j{}; j < lanes; ++j)
+      row.sum += sums[j];
+
+    tileMaxima[tiles] = max;
+  }
+
+  // Normalize, moving every tile from its running max to the row's max
+  for (size_t t{}; t < tiles; ++t) {
+    T *out{outputs + t * tile};
+    const size_t size{std::min(tile, count - t * tile)};
+    const T scale{std::exp(tileMaxima[t] - row.max) / row.sum};
+    for (size_t i{}; i < size; ++i)
+      out[i] *= scale;
+  }
+
+  return row;
+}
+
+template <typename T>
+Matrix<T> softmax(const MatrixBase<T> &inputs,
+                  std::optional<bool> parallelize) {
+  Matrix<T> outputs{};
+  softmax(inputs, outputs, parallelize);
+  return outputs;
+}
+
+template <typename T>
+void softmax(const MatrixBase<T> &inputs, Matrix<T> &outputs,
+             std::optional<bool> parallelize) {
+  // Every item is overwritten by the kernel, so matching outputs aren't
+  // resized (which would fill them first)
+  if (outputs.rows() != inputs.rows() || outputs.cols() != inputs.cols())
+    outputs.resize(inputs.rows(), inputs.cols());
+  if (inputs.cols() == 0)
+    return;
+
+  // An estimation of all the operations in a single row item
+  const size_t cost{20 * inputs.cols()};
+
+  Utils::Parallel::dynamicParallelFor(
+      cost, inputs.rows(),
+      [&inputs, &outputs](size_t row) {
+        softmax(&inputs[row, 0], &outputs[row, 0], inputs.cols());
+      },
+      parallelize);
+}
+
+}; // namespace Math
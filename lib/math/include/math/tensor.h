@@ -0,0 +1,123 @@
+#pragma once
+
+#include "matrix.h"
+#include "matrixView.h"
+#include "tensorBase.h"
+#include "tensorView.h"
+
+#include <concepts>
+#include <functional>
+#include <optional>
+#include <vector>
+
+namespace Math {
+
+// N-dimensional tensor, stored contiguously in row-major order.
+// Layout changes which don't move data (reshape, slicing, permute) are done
+// through views, and conversions from/to Matrix can move the data instead of
+// copying it.
+// T = the data type the tensor holds
+template <typename T> class Tensor : public TensorBase<T> {
+public:
+  using TensorBase<T>::shape;
+  using TensorBase<T>::rank;
+  using TensorBase<T>::size;
+
+  Tensor() = default;
+
+  // Create 0-filled tensor of given shape
+  explicit Tensor(Shape shape);
+
+  // Create tensor filled with values outputted from given function
+  Tensor(Shape shape, std::function<T()> gen);
+
+  // Constructor with shape and a single data vector of type T containing all
+  // the tensor's data in row-major order.
+  // Note: the data will be moved on construction
+  Tensor(Shape shape, std::vector<T> &&data);
+
+  // Create tensor of shape (rows, cols), taking ownership of the matrix's data
+  explicit Tensor(Matrix<T> &&m);
+
+  // Copy constructor. Non-contiguous views are copied into contiguous storage
+  Tensor(const TensorBase<T> &other);
+  Tensor(const Tensor &other) = default;
+
+  // Move constructor
+  Tensor(Tensor &&other) noexcept;
+
+  // Copy assignment
+  Tensor &operator=(const Tensor &other) = default;
+
+  // Move assignment
+  Tensor &operator=(Tensor &&other) noexcept;
+
+  // Fill the tensor with values from the generator function
+  // gen input - a pointer to the item to be filled
+  // cost - estimated operation cost of gen, 1 = single addition
+  void fill(std::function<void(T *)> gen,
+            std::optional<bool> parallelize = std::nullopt, size_t cost = 5);
+
+  // Single item access - NO BOUNDS CHECKING
+  // Expects one index per dimension (e.g. t[batch, y, x, channel])
+  template <std::convertible_to<size_t>... Index>
+  T &operator[](Index... index) {
+    return m_data[offset(index...)];
+  }
+  template <std::convertible_to<size_t>... Index>
+  const T &operator[](Index... index) const {
+    return m_data[offset(index...)];
+  }
+
+  // Single item access - WITH BOUNDS CHECKING
+  T &at(const Shape &index);
+  const T &at(const Shape &index) const;
+
+  // Reshapes tensor to given shape. Returns *this.
+  // Throws if given shape's item count doesn't match the current one
+  Tensor &reshape(Shape shape);
+
+  // Getters
+  const Shape &shape() const { return m_shape; }
+  const Shape &strides() const { return m_strides; }
+  bool isContiguous() const { return true; }
+  std::vector<T> &data() { return m_data; }
+  const std::vector<T> &data() const { return m_data; }
+
+  // Returns a view of the entire tensor
+  const TensorView<T> view() const;
+
+  // Returns a view of a range [start, end) of the outermost dimension
+  // Throws if end > shape(0) or start >= end.
+  const TensorView<T> view(size_t start, size_t end) const;
+
+  // Returns a view with the dimensions reordered, without copying. Dimension i
+  // of the result is dimension axes[i] of the current tensor.
+  // Throws if axes isn't a permutation of the tensor's dimensions
+  const TensorView<T> permute(const Shape &axes) const;
+
+  // Returns a matrix view of the tensor, where the first rowDims dimensions
+  // make up the rows and the rest make up the columns. No data is copied.
+  const MatrixView<T> matrix(size_t rowDims = 1) const;
+
+  // Moves the tensor's data into a matrix, where the first rowDims dimensions
+  // make up the rows and the rest make up the columns. Leaves tensor empty.
+  Matrix<T> toMatrix(size_t rowDims = 1) &&;
+
+  friend TensorView<T>;
+
+private:
+  template <typename... Index> size_t offset(Index... index) const {
+    size_t result{};
+    size_t dim{};
+    ((result += static_cast<size_t>(index) * m_strides[dim++]), ...);
+    return result;
+  }
+
+  std::vector<T> m_data{};
+  Shape m_shape{};
+  Shape m_strides{};
+};
+} // namespace Math
+
+#include "tensor.tpp"
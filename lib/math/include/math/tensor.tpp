@@ -0,0 +1,132 @@
+#pragma once
+
+#include "tensor.h"
+
+#include "exception.h"
+#include "utils/exceptions.h"
+
+#include "utils/parallel.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace Math {
+
+template <typename T>
+Tensor<T>::Tensor(Shape shape)
+    : m_data(shapeSize(shape)), m_shape{std::move(shape)},
+      m_strides{contiguousStrides(m_shape)} {}
+
+template <typename T>
+Tensor<T>::Tensor(Shape shape, std::function<T()> gen)
+    : m_data(shapeSize(shape)), m_shape{std::move(shape)},
+      m_strides{contiguousStrides(m_shape)} {
+  std::generate(m_data.begin(), m_data.end(), gen);
+}
+
+template <typename T>
+Tensor<T>::Tensor(Shape shape, std::vector<T> &&data)
+    : m_data{std::move(data)}, m_shape{std::move(shape)},
+      m_strides{contiguousStrides(m_shape)} {
+  if (m_data.size() != shapeSize(m_shape))
+    throw Math::Exception{CURRENT_FUNCTION,
+                          "Given vector doesn't match the shape's item count"};
+}
+
+template <typename T>
+Tensor<T>::Tensor(Matrix<T> &&m)
+    : m_shape{m.rows(), m.cols()}, m_strides{contiguousStrides(m_shape)} {
+  m_data = std::move(m.data());
+  m = Matrix<T>{};
+}
+
+template <typename T>
+Tensor<T>::Tensor(const TensorBase<T> &other)
+    : Tensor{other.view().contiguous()} {}
+
+template <typename T>
+Tensor<T>::Tensor(Tensor &&other) noexcept
+    : m_data{std::move(other.m_data)}, m_shape{std::move(other.m_shape)},
+      m_strides{std::move(other.m_strides)} {
+  other.m_shape.clear();
+  other.m_strides.clear();
+}
+
+template <typename T> Tensor<T> &Tensor<T>::operator=(Tensor &&other) noexcept {
+  if (&other != this) {
+    m_data = std::move(other.m_data);
+    m_shape = std::move(other.m_shape);
+    m_strides = std::move(other.m_strides);
+    other.m_shape.clear();
+    other.m_strides.clear();
+  }
+  return *this;
+}
+
+template <typename T>
+void Tensor<T>::fill(std::function<void(T *)> gen,
+                     std::optional<bool> parallelize, size_t cost) {
+  Utils::Parallel::dynamicParallelFor(
+      cost, m_data.size(), [gen, &data = m_data](size_t i) { gen(&data[i]); },
+      parallelize);
+}
+
+template <typename T> T &Tensor<T>::at(const Shape &index) {
+  return const_cast<T &>(std::as_const(*this).at(index));
+}
+
+template <typename T> const T &Tensor<T>::at(const Shape &index) const {
+  if (index.size() != rank())
+    throw Math::Exception{CURRENT_FUNCTION,
+                          "Index rank doesn't match the tensor's rank"};
+
+  size_t offset{};
+  for (size_t i{}; i < index.size(); ++i) {
+    if (index[i] >= m_shape[i])
+      throw Math::Exception{CURRENT_FUNCTION, "Index out of bounds"};
+    offset += index[i] * m_strides[i];
+  }
+
+  return m_data[offset];
+}
+
+template <typename T> Tensor<T> &Tensor<T>::reshape(Shape shape) {
+  if (shapeSize(shape) != m_data.size())
+    throw Math::Exception{CURRENT_FUNCTION, "Reshape dimension mismatch"};
+
+  m_shape = std::move(shape);
+  m_strides = contiguousStrides(m_shape);
+
+  return *this;
+}
+
+template <typename T> const TensorView<T> Tensor<T>::view() const {
+  return TensorView<T>{0, m_shape, m_strides, m_data};
+}
+
+template <typename T>
+const TensorView<T> Tensor<T>::view(size_t start, size_t end) const {
+  return view().view(start, end);
+}
+
+template <typename T>
+const TensorView<T> Tensor<T>::permute(const Shape &axes) const {
+  return view().permute(axes);
+}
+
+template <typename T>
+const MatrixView<T> Tensor<T>::matrix(size_t rowDims) const {
+  return view().matrix(rowDims);
+}
+
+template <typename T> Matrix<T> Tensor<T>::toMatrix(size_t rowDims) && {
+  const MatrixView<T> dims{matrix(rowDims)};
+  const size_t rows{dims.rows()};
+  const size_t cols{dims.cols()};
+
+  m_shape.clear();
+  m_strides.clear();
+
+  return Matrix<T>{rows, cols, std::move(m_data)};
+}
+} // namespace Math
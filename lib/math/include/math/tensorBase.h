@@ -0,0 +1,82 @@
+#pragma once
+
+#include "matrixView.h"
+
+#include <functional>
+#include <numeric>
+#include <stddef.h>
+#include <vector>
+
+namespace Math {
+
+template <typename T> class Tensor;
+
+template <typename T> class TensorView;
+
+// Dimensions of a tensor, outermost first (e.g. (batch, height, width,
+// channels))
+using Shape = std::vector<size_t>;
+
+// Returns the number of items in a tensor of the given shape
+inline size_t shapeSize(const Shape &shape) {
+  return std::accumulate(shape.begin(), shape.end(), 1uz,
+                         std::multiplies<size_t>{});
+}
+
+// Returns the strides of a contiguous (row-major) tensor of the given shape
+inline Shape contiguousStrides(const Shape &shape) {
+  Shape strides(shape.size());
+  size_t stride{1};
+  for (size_t i{shape.size()}; i > 0; --i) {
+    strides[i - 1] = stride;
+    stride *= shape[i - 1];
+  }
+  return strides;
+}
+
+// Base tensor class - pure virtual interface, can't be instantiated. only to
+// inherit for other classes
+template <typename T> class TensorBase {
+public:
+  virtual ~TensorBase() = default;
+
+  // Single item access - WITH BOUNDS CHECKING
+  // index - one position per dimension
+  virtual const T &at(const Shape &index) const = 0;
+
+  // Getters
+  virtual const Shape &shape() const = 0;
+  // Distance (in items) between consecutive positions of every dimension
+  virtual const Shape &strides() const = 0;
+
+  // Size of a single dimension
+  size_t shape(size_t dim) const { return shape()[dim]; }
+  // Number of dimensions
+  size_t rank() const { return shape().size(); }
+  // Number of items
+  size_t size() const { return shapeSize(shape()); }
+
+  // Is the data stored contiguously in row-major order
+  virtual bool isContiguous() const = 0;
+
+  // Return entire underlying data. Not necessarily from the start of the tensor
+  virtual const std::vector<T> &data() const = 0;
+
+  // Returns a view of the entire tensor
+  virtual const TensorView<T> view() const = 0;
+
+  // Returns a view of a range [start, end) of the outermost dimension
+  // Throws if end > shape(0) or start >= end.
+  virtual const TensorView<T> view(size_t start, size_t end) const = 0;
+
+  // Returns a view with the dimensions reordered, without copying. Dimension i
+  // of the result is dimension axes[i] of the current tensor.
+  // Throws if axes isn't a permutation of the tensor's dimensions
+  virtual const TensorView<T> permute(const Shape &axes) const = 0;
+
+  // Returns a matrix view of the tensor, where the first rowDims dimensions
+  // make up the rows and the rest make up the columns. No data is copied.
+  // Throws if the tensor isn't contiguous
+  virtual const MatrixView<T> matrix(size_t rowDims = 1) const = 0;
+};
+} // namespace Math
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "matrix.h"
+#include "matrixView.h"
+#include "tensorBase.h"
+
+#include <concepts>
+#include <optional>
+#include <vector>
+
+namespace Math {
+
+// Class which mimics Math::Tensor class, but holds a reference to a data vector
+// instead of the data itself. Hence, it has no ownership of the data it holds.
+// Views keep their own strides, so reshaped, sliced and permuted views all
+// share the data they were created from.
+template <typename T> class TensorView : public TensorBase<T> {
+public:
+  using TensorBase<T>::shape;
+  using TensorBase<T>::rank;
+  using TensorBase<T>::size;
+
+  // Create TensorView which points at nothing
+  TensorView() = default;
+
+  // Create a view of a matrix with the given shape
+  // Throws if shape doesn't contain exactly the matrix's items
+  TensorView(const Matrix<T> &m, Shape shape);
+  TensorView(const MatrixView<T> &m, Shape shape);
+
+  TensorView(const TensorView &other) = default;
+  TensorView(TensorView &&other) = default;
+
+  TensorView &operator=(const TensorView &other) = default;
+  TensorView &operator=(TensorView &&other) = default;
+
+  // Single item access - NO BOUNDS CHECKING
+  // Expects one index per dimension (e.g. t[batch, y, x, channel])
+  template <std::convertible_to<size_t>... Index>
+  const T &operator[](Index... index) const {
+    size_t offset{m_offset};
+    size_t dim{};
+    ((offset += static_cast<size_t>(index) * m_strides[dim++]), ...);
+    return (*m_data)[offset];
+  }
+
+  // Single item access - WITH BOUNDS CHECKING
+  const T &at(const Shape &index) const;
+
+  // Reshapes tensor view to given shape. Returns *this.
+  // Throws if the item count changes, or if the view isn't contiguous
+  TensorView &reshape(Shape shape);
+
+  // Getters
+  const Shape &shape() const { return m_shape; }
+  const Shape &strides() const { return m_strides; }
+
+  bool isContiguous() const;
+
+  // Return entire underlying data. Not necessarily from the start of the view
+  const std::vector<T> &data() const { return *m_data; }
+
+  // Returns a view of the entire tensor
+  const TensorView<T> view() const { return *this; }
+
+  // Returns a view of a range [start, end) of the outermost dimension
+  // Throws if end > shape(0) or start >= end.
+  const TensorView<T> view(size_t start, size_t end) const;
+
+  // Returns a view with the dimensions reordered, without copying. Dimension i
+  // of the result is dimension axes[i] of the current tensor.
+  // Throws if axes isn't a permutation of the tensor's dimensions
+  const TensorView<T> permute(const Shape &axes) const;
+
+  // Returns a matrix view of the tensor, where the first rowDims dimensions
+  // make up the rows and the rest make up the columns. No data is copied.
+  // Throws if the view isn't contiguous
+  const MatrixView<T> matrix(size_t rowDims = 1) const;
+
+  // Copies the view into a new contiguous tensor
+  // parallelize - should copying be parallized. If provided empty, will
+  //               parallelize automatically as seen needed
+  Tensor<T> contiguous(std::optional<bool> parallelize = std::nullopt) const;
+
+  friend Tensor<T>;
+
+private:
+  TensorView(size_t offset, Shape shape, Shape strides,
+             const std::vector<T> &data)
+      : m_data{&data}, m_offset{offset}, m_shape{std::move(shape)},
+        m_strides{std::move(strides)} {}
+
+  const std::vector<T> *m_data{nullptr};
+  size_t m_offset{};
+  Shape m_shape{};
+  Shape m_strides{};
+};
+} // namespace Math
+
+#include "tensorView.tpp"
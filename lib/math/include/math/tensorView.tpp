@@ -0,0 +1,161 @@
+#pragma once
+
+#include "tensorView.h"
+
+#include "exception.h"
+#include "tensor.h"
+#include "utils/exceptions.h"
+
+#include "utils/parallel.h"
+
+#include <algorithm>
+
+namespace Math {
+
+template <typename T>
+TensorView<T>::TensorView(const Matrix<T> &m, Shape shape)
+    : m_data{&m.data()}, m_offset{}, m_shape{std::move(shape)},
+      m_strides{contiguousStrides(m_shape)} {
+  if (shapeSize(m_shape) != m.rows() * m.cols())
+    throw Math::Exception{CURRENT_FUNCTION,
+                          "Shape doesn't match the matrix's item count"};
+}
+
+template <typename T>
+TensorView<T>::TensorView(const MatrixView<T> &m, Shape shape)
+    : m_data{&m.data()}, m_offset{m.m_start}, m_shape{std::move(shape)},
+      m_strides{contiguousStrides(m_shape)} {
+  if (shapeSize(m_shape) != m.rows() * m.cols())
+    throw Math::Exception{CURRENT_FUNCTION,
+                          "Shape doesn't match the matrix's item count"};
+}
+
+template <typename T> const T &TensorView<T>::at(const Shape &index) const {
+  if (index.size() != rank())
+    throw Math::Exception{CURRENT_FUNCTION,
+                          "Index rank doesn't match the tensor's rank"};
+
+  size_t offset{m_offset};
+  for (size_t i{}; i < index.size(); ++i) {
+    if (index[i] >= m_shape[i])
+      throw Math::Exception{CURRENT_FUNCTION, "Index out of bounds"};
+    offset += index[i] * m_strides[i];
+  }
+
+  return (*m_data)[offset];
+}
+
+template <typename T> TensorView<T> &TensorView<T>::reshape(Shape shape) {
+  if (shapeSize(shape) != size())
+    throw Math::Exception{CURRENT_FUNCTION, "Reshape dimension mismatch"};
+  if (!isContiguous())
+    throw Math::Exception{CURRENT_FUNCTION,
+                          "Can't reshape a non-contiguous tensor view"};
+
+  m_shape = std::move(shape);
+  m_strides = contiguousStrides(m_shape);
+
+  return *this;
+}
+
+template <typename T> bool TensorView<T>::isContiguous() const {
+  size_t stride{1};
+  for (size_t i{rank()}; i > 0; --i) {
+    // Strides of single-item dimensions are never used
+    if (m_shape[i - 1] != 1 && m_strides[i - 1] != stride)
+      return false;
+    stride *= m_shape[i - 1];
+  }
+  return true;
+}
+
+template <typename T>
+const TensorView<T> TensorView<T>::view(size_t start, size_t end) const {
+  if (rank() == 0)
+    throw Math::Exception{CURRENT_FUNCTION, "Can't slice a 0-rank tensor"};
+  if (start >= end)
+    throw Math::Exception{CURRENT_FUNCTION, "Start ahead of the end"};
+  if (end > m_shape[0])
+    throw Math::Exception{CURRENT_FUNCTION,
+                          "End is outside the tensor's bound"};
+
+  Shape shape{m_shape};
+  shape[0] = end - start;
+
+  return TensorView<T>{m_offset + start * m_strides[0], std::move(shape),
+                       m_strides, *m_data};
+}
+
+template <typename T>
+const TensorView<T> TensorView<T>::permute(const Shape &axes) const {
+  if (axes.size() != rank())
+    throw Math::Exception{CURRENT_FUNCTION,
+                          "Permutation rank doesn't match the tensor's rank"};
+
+  Shape shape(rank());
+  Shape strides(rank());
+  std::vector<bool> used(rank());
+  for (size_t i{}; i < axes.size(); ++i) {
+    if (axes[i] >= rank() || used[axes[i]])
+      throw Math::Exception{CURRENT_FUNCTION,
+                            "Given axes aren't a permutation"};
+    used[axes[i]] = true;
+    shape[i] = m_shape[axes[i]];
+    strides[i] = m_strides[axes[i]];
+  }
+
+  return TensorView<T>{m_offset, std::move(shape), std::move(strides),
+                       *m_data};
+}
+
+template <typename T>
+const MatrixView<T> TensorView<T>::matrix(size_t rowDims) const {
+  if (rowDims > rank())
+    throw Math::Exception{CURRENT_FUNCTION,
+                          "Row dimension count exceeds the tensor's rank"};
+  if (!isContiguous())
+    throw Math::Exception{
+        CURRENT_FUNCTION,
+        "Can't view a non-contiguous tensor as a matrix. Use contiguous()"};
+
+  const size_t rows{shapeSize(Shape{m_shape.begin(),
+                                    m_shape.begin() +
+                                        static_cast<std::ptrdiff_t>(rowDims)})};
+
+  return MatrixView<T>{m_offset, rows, rows == 0 ? 0 : size() / rows,
+                       *m_data};
+}
+
+template <typename T>
+Tensor<T> TensorView<T>::contiguous(std::optional<bool> parallelize) const {
+  Tensor<T> result{m_shape};
+  if (rank() == 0) {
+    result.m_data[0] = (*m_data)[m_offset];
+    return result;
+  }
+
+  // Rows are runs of the innermost dimension
+  const size_t rowSize{m_shape.back()};
+  const size_t rowCount{rowSize == 0 ? 0 : size() / rowSize};
+
+  auto copyRow{[this, &result, rowSize](size_t row) {
+    // Unravel the row number into the position of its first item
+    size_t offset{m_offset};
+    size_t rest{row};
+    for (size_t i{rank() - 1}; i > 0; --i) {
+      offset += (rest % m_shape[i - 1]) * m_strides[i - 1];
+      rest /= m_shape[i - 1];
+    }
+
+    const size_t innerStride{m_strides.back()};
+    T *out{result.m_data.data() + row * rowSize};
+    for (size_t i{}; i < rowSize; ++i)
+      out[i] = (*m_data)[offset + i * innerStride];
+  }};
+
+  Utils::Parallel::dynamicParallelFor(rowSize + rank(), rowCount, copyRow,
+                                      parallelize);
+
+  return result;
+}
+} // namespace Math
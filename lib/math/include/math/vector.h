@@ -75,6 +75,13 @@ public:
   // Throws if end > size or start >= end
   const VectorView<T> view(size_t start, size_t end) const;
 
+  // Resizes vector to given size, filled with 0s. Returns *this.
+  // Storage is kept while it can hold size items (see Matrix::resize())
+  Vector &resize(size_t size);
+
+  // Makes storage hold at least size items without changing the vector
+  void reserve(size_t size) { m_data.reserve(size); }
+
   // Getters
   size_t size() const { return m_data.size(); }
   std::vector<T> &data() { return m_data; }
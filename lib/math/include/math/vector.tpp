@@ -98,6 +98,11 @@ template <typename T> const T &Vector<T>::at(size_t index) const {
   return m_data[index];
 }
 
+template <typename T> Vector<T> &Vector<T>::resize(size_t size) {
+  m_data.assign(size, T{});
+  return *this;
+}
+
 template <typename T> const VectorView<T> Vector<T>::view() const {
   return VectorView<T>{0, size(), m_data};
 }
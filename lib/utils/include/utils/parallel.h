@@ -1,10 +1,19 @@
 #pragma once
 
+#include <cstddef>
 #include <functional>
+#include <optional>
 
 namespace Utils {
 namespace Parallel {
 
+// Number of threads parallelFor() spreads a loop over when no thread count is
+// passed in. It's the hardware concurrency on threads parallelFor() didn't
+// start, and threads it starts split their parent's budget evenly, so nested
+// loops (e.g. kernels run by each data-parallel replica) stay on their share of
+// the cores instead of oversubscribing them
+size_t threadBudget();
+
 // Runs a loop evenly between available threads (or passed in value if non-zero)
 // loopLength - length of loop needed to be parallelized
 // innerLoop - code to be ran in every loop iteration. Passed in value is the
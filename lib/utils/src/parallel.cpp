@@ -1,21 +1,39 @@
+#include "utils/parallel.h"
+
 #include <algorithm>
 #include <functional>
 #include <thread>
 
 namespace Utils {
 namespace Parallel {
+// Budget of the current thread, if it was started by parallelFor()
+static thread_local size_t t_threadBudget{};
+
+size_t threadBudget() {
+  if (t_threadBudget > 0)
+    return t_threadBudget;
+  return std::max<size_t>(
+      static_cast<size_t>(std::thread::hardware_concurrency()), 1);
+}
 
 void parallelFor(size_t loopLength, std::function<void(size_t)> innerLoop,
                  size_t threadCount) {
   if (loopLength == 0)
     return;
 
-  size_t availableThreads{
-      (threadCount > 0)
-          ? threadCount
-          : std::clamp<size_t>(
-                static_cast<size_t>(std::thread::hardware_concurrency()), 1,
-                loopLength)};
+  size_t availableThreads{(threadCount > 0)
+                              ? threadCount
+                              : std::min(threadBudget(), loopLength)};
+  // A single thread (e.g. inside a nested loop) runs the loop itself
+  if (availableThreads == 1) {
+    for (size_t i{}; i < loopLength; ++i)
+      innerLoop(i);
+    return;
+  }
+
+  // Budget of every started thread, for its own nested loops
+  const size_t childBudget{std::max<size_t>(threadBudget() / availableThreads,
+                                            1)};
   size_t chunkBaseSize{loopLength / availableThreads};
   size_t numChunkSizeIncrements{loopLength -
                                 (chunkBaseSize * availableThreads)};
@@ -29,10 +47,12 @@ void parallelFor(size_t loopLength, std::function<void(size_t)> innerLoop,
                               ((thread < numChunkSizeIncrements) ? 1 : 0),
                           loopLength);
 
-    threads.emplace_back(std::jthread([currentStart, currentEnd, &innerLoop]() {
-      for (size_t i{currentStart}; i < currentEnd; ++i)
-        innerLoop(i);
-    }));
+    threads.emplace_back(
+        std::jthread([currentStart, currentEnd, childBudget, &innerLoop]() {
+          t_threadBudget = childBudget;
+          for (size_t i{currentStart}; i < currentEnd; ++i)
+            innerLoop(i);
+        }));
 
     currentStart = currentEnd;
   }
@@ -22,8 +22,8 @@ const Math::Matrix<float> &
 LeakyReLU::forward(const Math::MatrixBase<float> &inputs) {
   // If m_output's size doesn't match inputs' size, resize all matrices
   if (m_output.rows() != inputs.rows() || m_output.cols() != inputs.cols()) {
-    m_output = Math::Matrix<float>{inputs.rows(), inputs.cols()};
-    m_dinputs = Math::Matrix<float>{inputs.rows(), inputs.cols()};
+    m_output.resize(inputs.rows(), inputs.cols());
+    m_dinputs.resize(inputs.rows(), inputs.cols());
   }
 
   m_output.transform(
@@ -38,7 +38,15 @@ LeakyReLU::forward(const Math::MatrixBase<float> &inputs) {
 
 Math::Matrix<float>
 LeakyReLU::predict(const Math::MatrixBase<float> &inputs) const {
-  Math::Matrix<float> output{inputs.rows(), inputs.cols()};
+  Math::Matrix<float> output{};
+  predict(inputs, output);
+  return output;
+}
+
+void LeakyReLU::predict(const Math::MatrixBase<float> &inputs,
+                        Math::Matrix<float> &output) const {
+  if (output.rows() != inputs.rows() || output.cols() != inputs.cols())
+    output.resize(inputs.rows(), inputs.cols());
 
   output.transform(
       inputs,
@@ -46,8 +54,6 @@ LeakyReLU::predict(const Math::MatrixBase<float> &inputs) const {
         *out = (*in > 0) ? *in : (alpha * *in);
       },
       std::nullopt, 2);
-
-  return output;
 }
 
 const Math::Matrix<float> &
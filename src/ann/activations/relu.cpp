@@ -22,8 +22,8 @@ const Math::Matrix<float> &
 ReLU::forward(const Math::MatrixBase<float> &inputs) {
   // If m_output's size doesn't match inputs' size, resize all matrices
   if (m_output.rows() != inputs.rows() || m_output.cols() != inputs.cols()) {
-    m_output = Math::Matrix<float>{inputs.rows(), inputs.cols()};
-    m_dinputs = Math::Matrix<float>{inputs.rows(), inputs.cols()};
+    m_output.resize(inputs.rows(), inputs.cols());
+    m_dinputs.resize(inputs.rows(), inputs.cols());
   }
 
   m_output.transform(
@@ -34,13 +34,19 @@ ReLU::forward(const Math::MatrixBase<float> &inputs) {
 }
 
 Math::Matrix<float> ReLU::predict(const Math::MatrixBase<float> &inputs) const {
-  Math::Matrix<float> output{inputs.rows(), inputs.cols()};
+  Math::Matrix<float> output{};
+  predict(inputs, output);
+  return output;
+}
+
+void ReLU::predict(const Math::MatrixBase<float> &inputs,
+                   Math::Matrix<float> &output) const {
+  if (output.rows() != inputs.rows() || output.cols() != inputs.cols())
+    output.resize(inputs.rows(), inputs.cols());
 
   output.transform(
       inputs, [](float *out, const float *in) { *out = std::max(0.0f, *in); },
       std::nullopt, 1);
-
-  return output;
 }
 
 const Math::Matrix<float> &
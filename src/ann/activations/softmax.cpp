@@ -1,5 +1,6 @@
 #include "ann/activations/softmax.h"
 
+#include "math/softmax.h"
 #include "utils/parallel.h"
 
 #include <cmath>
@@ -24,70 +25,23 @@ const Math::Matrix<float> &
 Softmax::forward(const Math::MatrixBase<float> &inputs) {
   // If m_output's size doesn't match inputs' size, resize all matrices
   if (m_output.rows() != inputs.rows() || m_output.cols() != inputs.cols()) {
-    m_output = Math::Matrix<float>{inputs.rows(), inputs.cols()};
-    m_dinputs = Math::Matrix<float>{inputs.rows(), inputs.cols()};
+    m_output.resize(inputs.rows(), inputs.cols());
+    m_dinputs.resize(inputs.rows(), inputs.cols());
   }
 
-  // An estimation of all the operations in a single iteration
-  size_t cost{55 * inputs.cols()};
-
-  auto calculateBatch{[&inputs, &output = m_output](size_t batch) {
-    // max value in batch (for exponentiated values to not explode)
-    float maxValue = inputs[batch, 0];
-    for (size_t i{1}; i < inputs.cols(); ++i)
-      if (inputs[batch, i] > maxValue)
-        maxValue = inputs[batch, i];
-
-    // sum of exponentiated inputs
-    float normalBase{};
-
-    for (size_t i{}; i < inputs.cols(); ++i) {
-      output[batch, i] =
-          std::exp(static_cast<float>(inputs[batch, i] - maxValue));
-      normalBase += output[batch, i];
-    }
-
-    // Normalize values
-    for (size_t i{}; i < inputs.cols(); ++i)
-      output[batch, i] /= normalBase;
-  }};
-
-  Utils::Parallel::dynamicParallelFor(cost, m_output.rows(), calculateBatch);
+  Math::softmax(inputs, m_output);
 
   return m_output;
 }
 
 Math::Matrix<float>
 Softmax::predict(const Math::MatrixBase<float> &inputs) const {
-  Math::Matrix<float> output{inputs.rows(), inputs.cols()};
-
-  // An estimation of all the operations in a single iteration
-  size_t cost{55 * inputs.cols()};
-
-  auto calculateBatch{[&inputs, &output](size_t batch) {
-    // max value in batch (for exponentiated values to not explode)
-    float maxValue = inputs[batch, 0];
-    for (size_t i{1}; i < inputs.cols(); ++i)
-      if (inputs[batch, i] > maxValue)
-        maxValue = inputs[batch, i];
-
-    // sum of exponentiated inputs
-    float normalBase{};
-
-    for (size_t i{}; i < inputs.cols(); ++i) {
-      output[batch, i] =
-          std::exp(static_cast<float>(inputs[batch, i] - maxValue));
-      normalBase += output[batch, i];
-    }
-
-    // Normalize values
-    for (size_t i{}; i < inputs.cols(); ++i)
-      output[batch, i] /= normalBase;
-  }};
-
-  Utils::Parallel::dynamicParallelFor(cost, output.rows(), calculateBatch);
+  return Math::softmax(inputs);
+}
 
-  return output;
+void Softmax::predict(const Math::MatrixBase<float> &inputs,
+                      Math::Matrix<float> &output) const {
+  Math::softmax(inputs, output);
 }
 
 const Math::Matrix<float> &
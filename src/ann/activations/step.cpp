@@ -18,24 +18,31 @@ Step &Step::operator=(Step &&other) noexcept {
 
 const Math::Matrix<float> &
 Step::forward(const Math::MatrixBase<float> &inputs) {
-  m_output = predict(inputs);
+  predict(inputs, m_output);
   return m_output;
 }
 
 Math::Matrix<float> Step::predict(const Math::MatrixBase<float> &inputs) const {
-  Math::Matrix<float> output{inputs.rows(), inputs.cols()};
+  Math::Matrix<float> output{};
+  predict(inputs, output);
+  return output;
+}
+
+void Step::predict(const Math::MatrixBase<float> &inputs,
+                   Math::Matrix<float> &output) const {
+  if (output.rows() != inputs.rows() || output.cols() != inputs.cols())
+    output.resize(inputs.rows(), inputs.cols());
+
   output.transform(
       inputs,
       [](float *out, const float *in) { *out = ((*in > 0) ? 1.0f : 0.0f); },
       std::nullopt, 1);
-
-  return output;
 }
 
 const Math::Matrix<float> &
 Step::backward(const Math::MatrixBase<float> &dvalues) {
   if (dvalues.rows() != m_dinputs.rows() || dvalues.cols() != m_dinputs.cols())
-    m_dinputs = Math::Matrix<float>(dvalues.rows(), dvalues.cols());
+    m_dinputs.resize(dvalues.rows(), dvalues.cols());
 
   // Auto initialized to 0 - no calculation needed
   return m_dinputs;
@@ -4,6 +4,7 @@
 #include "ann/loss/categorical.h"
 #include "ann/loss/categoricalSoftmax.h"
 #include "ann/loss/loss.h"
+#include "ann/loss/sampledSoftmax.h"
 #include "ann/modelDescriptors.h"
 
 #include "ann/activations/leakyRelu.h"
@@ -12,26 +13,40 @@
 #include "ann/activations/softmax.h"
 #include "ann/activations/step.h"
 
+#include "ann/layers/avgPool2d.h"
+#include "ann/layers/batchNorm.h"
+#include "ann/layers/conv2d.h"
 #include "ann/layers/dense.h"
 #include "ann/layers/dropout.h"
+#include "ann/layers/embedding.h"
+#include "ann/layers/gru.h"
+#include "ann/layers/lstm.h"
+#include "ann/layers/maxPool2d.h"
+#include "ann/layers/multiHeadAttention.h"
 
 #include "ann/optimizers/adagrad.h"
 #include "ann/optimizers/adam.h"
+#include "ann/optimizers/lamb.h"
+#include "ann/optimizers/lars.h"
 #include "ann/optimizers/rmsprop.h"
 #include "ann/optimizers/sgd.h"
 
 #include "math/random.h"
 #include "utils/exceptions.h"
+#include "utils/parallel.h"
 #include "utils/timer.h"
 #include "utils/variants.h"
 
 #include <algorithm>
+#include <array>
 #include <cassert>
+#include <cmath>
 #include <cstring>
 #include <fstream>
-#include <iomanip>
-#include <iostream>
+#include <iterator>
 #include <numeric>
+#include <span>
+#include <type_traits>
 #include <variant>
 
 namespace ANN {
@@ -55,17 +70,23 @@ void FeedForwardModel::configure(ModelDesc modelDescriptor) {
             std::to_string(modelDescriptor.inputs)};
 
   m_inputs = modelDescriptor.inputs;
-  unsigned int currentInputs{m_inputs};
-  for (auto &layerVariant : modelDescriptor.layers)
+  // Kept for building data-parallel replicas
+  m_modelDescriptor = modelDescriptor;
+  m_replicas.clear();
+  // Per-sample shape of the current layer's inputs
+  Math::Shape currentShape{m_inputs};
+  for (auto &layerVariant : modelDescriptor.layers) {
     std::visit(Utils::overloaded{[](std::monostate &) {
                                    throw ANN::Exception{
                                        CURRENT_FUNCTION,
                                        "Empty layer provided."};
                                  },
-                                 [this, &currentInputs](auto &layer) {
-                                   addLayer(layer, currentInputs);
+                                 [this, &currentShape](auto &layer) {
+                                   addLayer(layer, currentShape);
                                  }},
                layerVariant);
+    currentShape = m_layers.back()->outputShape(currentShape);
+  }
 
   // Set that a model was loaded
   m_isModelLoaded = true;
@@ -76,6 +97,26 @@ void FeedForwardModel::configure(TrainDesc trainingDescriptor) {
     throw ANN::Exception{
         CURRENT_FUNCTION,
         "Can't configure model with non-positive batchSize or epoch number"};
+  if (trainingDescriptor.gradientAccumulationSteps == 0)
+    throw ANN::Exception{CURRENT_FUNCTION,
+                         "Can't configure model with 0 gradient accumulation "
+                         "steps"};
+  if (trainingDescriptor.logInterval == 0)
+    throw ANN::Exception{CURRENT_FUNCTION,
+                         "Can't configure model with a log interval of 0"};
+  if (trainingDescriptor.dataParallelReplicas == 0 ||
+      trainingDescriptor.batchSize % trainingDescriptor.dataParallelReplicas !=
+          0)
+    throw ANN::Exception{CURRENT_FUNCTION,
+                         "Can't configure model with data-parallel replicas "
+                         "which don't divide the batch size"};
+  // Sampled candidates are drawn for the whole batch
+  if (trainingDescriptor.dataParallelReplicas > 1 &&
+      std::holds_alternative<SampledCategoricalCrossEntropySoftmaxLoss>(
+          trainingDescriptor.loss))
+    throw ANN::Exception{CURRENT_FUNCTION,
+                         "Can't train sampled softmax with data-parallel "
+                         "replicas"};
   std::visit(Utils::overloaded{[](std::monostate &) {
                                  throw ANN::Exception{CURRENT_FUNCTION,
                                                       "Empty loss provided."};
@@ -89,12 +130,18 @@ void FeedForwardModel::configure(TrainDesc trainingDescriptor) {
                                },
                                [this](auto &opt) { setOptimizer(opt); }},
              trainingDescriptor.optimizer);
+  m_optimizer->setQuantizedState(trainingDescriptor.quantizedOptimizerState);
 
   m_batchSize = trainingDescriptor.batchSize;
   m_epochs = trainingDescriptor.epochs;
   m_trainValidationRate = trainingDescriptor.trainValidationRate;
   m_shuffleBatches = trainingDescriptor.shuffleBatches;
   m_verbose = trainingDescriptor.verbose;
+  m_logInterval = trainingDescriptor.logInterval;
+  m_gradientCheckpointing = trainingDescriptor.gradientCheckpointing;
+  m_gradientAccumulationSteps = trainingDescriptor.gradientAccumulationSteps;
+  m_dataParallelReplicas = trainingDescriptor.dataParallelReplicas;
+  m_replicas.clear();
 
   // Set that training configuration was loaded
   m_isTrainLoaded = true;
@@ -142,47 +189,76 @@ void FeedForwardModel::loadParams(const std::string &path) {
     layer->loadParams(file);
 }
 
+void FeedForwardModel::freeze() {
+  if (!m_isModelLoaded)
+    throw ANN::Exception{CURRENT_FUNCTION,
+                         "Can't freeze model while it isn't loaded"};
+
+  for (size_t i{1}; i < m_layers.size(); ++i) {
+    if (m_layers[i]->type() != Layer::Type::BatchNorm ||
+        m_layers[i - 1]->type() != Layer::Type::Dense)
+      continue;
+
+    dynamic_cast<Layers::BatchNorm &>(*m_layers[i])
+        .foldInto(dynamic_cast<Layers::Dense &>(*m_layers[i - 1]));
+    m_layers.erase(m_layers.begin() + static_cast<std::ptrdiff_t>(i));
+    --i;
+  }
+
+  // Remaining batch norms normalize with their running statistics
+  for (auto &layer : m_layers)
+    layer->setTraining(false);
+
+  m_isFrozen = true;
+}
+
 void FeedForwardModel::train(const Math::MatrixBase<float> &inputs,
                              const Math::MatrixBase<float> &correct,
                              const std::string &logPath) {
   if (!m_isModelLoaded || !m_isTrainLoaded)
     throw ANN::Exception{CURRENT_FUNCTION,
                          "Can't train while model isn't fully loaded"};
-
-  std::ofstream logFile{logPath};
-  if (!logFile && logPath != "") {
-    throw ANN::Exception{CURRENT_FUNCTION,
-                         "Unable to open provided log file in " + logPath};
-  }
+  if (m_isFrozen)
+    throw ANN::Exception{CURRENT_FUNCTION, "Can't train a frozen model"};
 
   // If loss is categorical, use more efficient route of converting correct from
   // begin 1-hot encoded to a vector of indices, and training on them
   if (std::holds_alternative<Loss::Categorical>(m_loss) ||
-      std::holds_alternative<Loss::CategoricalSoftmax>(m_loss)) {
-    auto correctVector{argmaxFloat(correct)};
-    train(inputs, correctVector);
+      std::holds_alternative<Loss::CategoricalSoftmax>(m_loss) ||
+      std::holds_alternative<Loss::SampledSoftmax>(m_loss)) {
+    auto correctVector{argmaxLabels(correct)};
+    train(inputs, correctVector, logPath);
     return;
   }
 
+  std::ofstream logFile{logPath};
+  if (!logFile && logPath != "") {
+    throw ANN::Exception{CURRENT_FUNCTION,
+                         "Unable to open provided log file in " + logPath};
+  }
+  // Messages are formatted and written by a background thread
+  TrainingLog log{m_verbose, std::move(logFile)};
+
   Utils::Timer epochTime{};   // Used to track time passed in each epoch
   Utils::Timer displayTime{}; // Used for displaying update messages
 
   const size_t validationNum{static_cast<size_t>(
-      std::ceil(inputs.rows() * (1 - m_trainValidationRate)))};
+      std::ceil(static_cast<double>(inputs.rows()) *
+                (1 - m_trainValidationRate)))};
 
   auto inputsTraining{inputs.view(0, validationNum)};
   auto correctTraining{correct.view(0, validationNum)};
 
   const size_t stepNum{inputsTraining.rows() / m_batchSize};
 
+  log.plannedMemory(planTraining(inputs.rows() - validationNum));
+
   for (size_t epoch{}; epoch < m_epochs; ++epoch) {
-    if (m_verbose)
-      std::cout << "\nEpoch " << epoch + 1 << ":\n";
-    if (logFile.is_open())
-      logFile << "\nEPOCH " << epoch + 1 << ":\n";
+    log.epoch(epoch + 1);
 
     // Set up batch sequence
     std::vector<size_t> batchSequence{createBatchSequence(stepNum)};
+    std::visit([](Loss::Loss &loss) { loss.resetMetrics(); }, m_loss);
 
     epochTime.reset();
     for (size_t batch{}; batch < stepNum; ++batch) {
@@ -193,105 +269,113 @@ void FeedForwardModel::train(const Math::MatrixBase<float> &inputs,
           correctTraining.view(batchSequence[batch] * m_batchSize,
                                (batchSequence[batch] + 1) * m_batchSize)};
 
-      forward(batchData);
-
-      Math::MatrixView<float> outputGradients{};
-      // Loss forward + backward
-      std::visit(
-          [&layers = m_layers, &batchCorrect,
-           &outputGradients](Loss::Loss &loss) {
-            loss.forward(layers.back()->output(), batchCorrect);
-            outputGradients = loss.backward().view();
-          },
-          m_loss);
-
-      optimize(outputGradients);
+      // Micro-batches only accumulate their gradients, except the last one of
+      // every step (and of the epoch), which updates the parameters
+      m_isStepEnd = (batch + 1) % m_gradientAccumulationSteps == 0 ||
+                    batch + 1 == stepNum;
+      if (m_replicas.empty()) {
+        forward(batchData);
+        optimize(lossGradients(batchData, batchCorrect));
+      } else
+        trainReplicas(batchData, batchCorrect);
 
       // Display information every about half second, or at the first/final
-      // batch, only if verbose is true
-      if (m_verbose && (displayTime.elapsed() >= 0.5 || batch + 1 == stepNum ||
-                        batch == 0)) {
-        std::cout << '\r'
-                  << getUpdateMsg(epochTime.elapsed(), batch, stepNum).str()
-                  << std::flush;
+      // batch, only if verbose is true. If log file is defined, write to it an
+      // update message every m_logInterval batches
+      const bool toConsole{log.isVerbose() &&
+                           (displayTime.elapsed() >= 0.5 ||
+                            batch + 1 == stepNum || batch == 0)};
+      const bool toFile{log.hasFile() && ((batch + 1) % m_logInterval == 0 ||
+                                          batch + 1 == stepNum)};
+      if (toConsole || toFile)
+        log.update(progress(epochTime.elapsed(), batch, stepNum), toConsole,
+                   toFile);
+      if (toConsole)
         displayTime.reset();
-      }
-
-      // If log file is defined, write to it every update message
-      if (logFile.is_open())
-        logFile << getUpdateMsg(epochTime.elapsed(), batch, stepNum).str()
-                << '\n';
     }
 
     // Perform validation
-    if (m_trainValidationRate > 0 && (m_verbose || logFile.is_open())) {
-      // forward validation
-      auto valInputs{inputs.view(validationNum, inputs.rows())};
-      auto valCorrect{correct.view(validationNum, inputs.rows())};
-      forward(valInputs, false);
+    if (m_trainValidationRate > 0 && (log.isVerbose() || log.hasFile())) {
+      evaluate(inputs.view(validationNum, inputs.rows()),
+               correct.view(validationNum, inputs.rows()));
       float valLoss{};
-      std::visit(
-          [&layers = m_layers, &valCorrect, &valLoss](Loss::Loss &loss) {
-            loss.forward(layers.back()->output(), valCorrect);
-            valLoss = loss.mean();
-          },
-          m_loss);
-
-      if (m_verbose)
-        std::cout << " - val loss: " << valLoss;
-      if (logFile.is_open())
-        logFile << "Validation loss: " << valLoss << '\n';
-
-      if (float valAccuracy{calculateAccuracy()}; valAccuracy != -1) {
-        if (m_verbose)
-          std::cout << " - val accuracy: " << valAccuracy;
-        if (logFile.is_open())
-          logFile << "Validation accuracy: " << valAccuracy << '\n';
-      }
+      calculateLoss(&valLoss);
+
+      log.validation(valLoss, calculateAccuracy());
     }
 
-    std::cout << '\n';
+    log.epochEnd();
   }
 }
 
 void FeedForwardModel::train(const Math::MatrixBase<float> &inputs,
                              const Math::VectorBase<float> &correct,
                              const std::string &logPath) {
+  trainLabels(inputs, correct, logPath);
+}
+
+void FeedForwardModel::train(const Math::MatrixBase<float> &inputs,
+                             const Math::VectorBase<uint16_t> &correct,
+                             const std::string &logPath) {
+  trainLabels(inputs, correct, logPath);
+}
+
+void FeedForwardModel::train(const Math::MatrixBase<float> &inputs,
+                             const Math::VectorBase<uint32_t> &correct,
+                             const std::string &logPath) {
+  trainLabels(inputs, correct, logPath);
+}
+
+template <typename Label>
+void FeedForwardModel::trainLabels(const Math::MatrixBase<float> &inputs,
+                                   const Math::VectorBase<Label> &correct,
+                                   const std::string &logPath) {
   if (!m_isModelLoaded || !m_isTrainLoaded)
     throw ANN::Exception{CURRENT_FUNCTION,
                          "Can't train while model isn't fully loaded"};
+  if (m_isFrozen)
+    throw ANN::Exception{CURRENT_FUNCTION, "Can't train a frozen model"};
 
+  // If loss isn't categorical, throw exception
+  if (!std::holds_alternative<Loss::Categorical>(m_loss) &&
+      !std::holds_alternative<Loss::CategoricalSoftmax>(m_loss) &&
+      !std::holds_alternative<Loss::SampledSoftmax>(m_loss))
+    throw ANN::Exception{CURRENT_FUNCTION,
+                         "Can't train on vector when loss isn't categorical"};
+  if (std::holds_alternative<Loss::SampledSoftmax>(m_loss) &&
+      m_layers.back()->type() != Layer::Type::Dense)
+    throw ANN::Exception{CURRENT_FUNCTION,
+                         "Sampled softmax needs the last layer to be Dense"};
+
+  // The log file is opened (and truncated) only once the call is valid
   std::ofstream logFile{logPath};
   if (!logFile && logPath != "") {
     throw ANN::Exception{CURRENT_FUNCTION,
                          "Unable to open provided log file in " + logPath};
   }
-
-  // If loss isn't categorical, throw exception
-  if (!std::holds_alternative<Loss::Categorical>(m_loss) &&
-      !std::holds_alternative<Loss::CategoricalSoftmax>(m_loss))
-    throw ANN::Exception{CURRENT_FUNCTION,
-                         "Can't train on vector when loss isn't categorical"};
+  // Messages are formatted and written by a background thread
+  TrainingLog log{m_verbose, std::move(logFile)};
 
   Utils::Timer epochTime{};   // Used to track time passed in each epoch
   Utils::Timer displayTime{}; // Used for displaying update messages
 
   const size_t validationNum{static_cast<size_t>(
-      std::ceil(inputs.rows() * (1 - m_trainValidationRate)))};
+      std::ceil(static_cast<double>(inputs.rows()) *
+                (1 - m_trainValidationRate)))};
 
   auto inputsTraining{inputs.view(0, validationNum)};
   auto correctTraining{correct.view(0, validationNum)};
 
   const size_t stepNum{inputsTraining.rows() / m_batchSize};
 
+  log.plannedMemory(planTraining(inputs.rows() - validationNum));
+
   for (size_t epoch{}; epoch < m_epochs; ++epoch) {
-    if (m_verbose)
-      std::cout << "\nEpoch " << epoch + 1 << ":\n";
-    if (logFile.is_open())
-      logFile << "\nEPOCH " << epoch + 1 << ":\n";
+    log.epoch(epoch + 1);
 
     // Set up batch sequence
     std::vector<size_t> batchSequence{createBatchSequence(stepNum)};
+    std::visit([](Loss::Loss &loss) { loss.resetMetrics(); }, m_loss);
 
     epochTime.reset();
     for (size_t batch{}; batch < stepNum; ++batch) {
@@ -302,123 +386,67 @@ void FeedForwardModel::train(const Math::MatrixBase<float> &inputs,
           correct.view(batchSequence[batch] * m_batchSize,
                        (batchSequence[batch] + 1) * m_batchSize)};
 
-      forward(batchData);
-
-      Math::MatrixView<float> outputGradients{};
-      // Loss forward + backward
-      std::visit(Utils::overloaded{
-                     [&layers = m_layers, &batchCorrect,
-                      &outputGradients](Loss::Categorical &loss) {
-                       loss.forward(layers.back()->output(), batchCorrect);
-                       outputGradients = loss.backward().view();
-                     },
-                     [&layers = m_layers, &batchCorrect,
-                      &outputGradients](Loss::CategoricalSoftmax &loss) {
-                       loss.forward(layers.back()->output(), batchCorrect);
-                       outputGradients = loss.backward().view();
-                     },
-                     [](auto &) { assert(false); }},
-                 m_loss);
-
-      optimize(outputGradients);
+      // Micro-batches only accumulate their gradients, except the last one of
+      // every step (and of the epoch), which updates the parameters
+      m_isStepEnd = (batch + 1) % m_gradientAccumulationSteps == 0 ||
+                    batch + 1 == stepNum;
+      if (m_replicas.empty()) {
+        forward(batchData);
+        optimize(lossGradients(batchData, batchCorrect));
+      } else
+        trainReplicas(batchData, batchCorrect);
 
       // Display information every about half second, or at the first/final
-      // batch, only if verbose is true
-      if (m_verbose && (displayTime.elapsed() >= 0.5 || batch + 1 == stepNum ||
-                        batch == 0)) {
-        std::cout << '\r'
-                  << getUpdateMsg(epochTime.elapsed(), batch, stepNum).str()
-                  << std::flush;
+      // batch, only if verbose is true. If log file is defined, write to it an
+      // update message every m_logInterval batches
+      const bool toConsole{log.isVerbose() &&
+                           (displayTime.elapsed() >= 0.5 ||
+                            batch + 1 == stepNum || batch == 0)};
+      const bool toFile{log.hasFile() && ((batch + 1) % m_logInterval == 0 ||
+                                          batch + 1 == stepNum)};
+      if (toConsole || toFile)
+        log.update(progress(epochTime.elapsed(), batch, stepNum), toConsole,
+                   toFile);
+      if (toConsole)
         displayTime.reset();
-      }
-
-      // If log file is defined, write to it every update message
-      if (logFile.is_open())
-        logFile << getUpdateMsg(epochTime.elapsed(), batch, stepNum).str()
-                << '\n';
     }
 
     // Perform validation
-    if (m_trainValidationRate > 0 && (m_verbose || logFile.is_open())) {
-      // forward validation
-      auto valInputs{inputs.view(validationNum, inputs.rows())};
-      auto valCorrect{correct.view(validationNum, inputs.rows())};
-      forward(valInputs);
+    if (m_trainValidationRate > 0 && (log.isVerbose() || log.hasFile())) {
+      evaluate(inputs.view(validationNum, inputs.rows()),
+               correct.view(validationNum, inputs.rows()));
       float valLoss{};
-      std::visit(
-          Utils::overloaded{[&layers = m_layers, &valCorrect,
-                             &valLoss](Loss::Categorical &loss) {
-                              loss.forward(layers.back()->output(), valCorrect);
-                              valLoss = loss.mean();
-                            },
-                            [&layers = m_layers, &valCorrect,
-                             &valLoss](Loss::CategoricalSoftmax &loss) {
-                              loss.forward(layers.back()->output(), valCorrect);
-                              valLoss = loss.mean();
-                            },
-                            [](auto &) { assert(false); }},
-          m_loss);
-
-      if (m_verbose)
-        std::cout << " - val loss: " << valLoss;
-      if (logFile.is_open())
-        logFile << "Validation loss: " << valLoss << '\n';
-
-      if (float valAccuracy{calculateAccuracy()}; valAccuracy != -1) {
-        if (m_verbose)
-          std::cout << " - val accuracy: " << valAccuracy;
-        if (logFile.is_open())
-          logFile << "Validation accuracy: " << valAccuracy << '\n';
-      }
+      calculateLoss(&valLoss);
+
+      log.validation(valLoss, calculateAccuracy());
     }
 
-    std::cout << '\n';
+    log.epochEnd();
   }
 }
 
 Math::Vector<float>
 FeedForwardModel::evaluate(const Math::MatrixBase<float> &inputs,
                            const Math::MatrixBase<float> &correct) {
-  Math::Vector<float> averageLoss{};
-  // Layer forward
-  forward(inputs.view(), false);
-  // Loss forward
-  std::visit(
-      [&layers = m_layers, &correct, &averageLoss](Loss::Loss &loss) {
-        averageLoss = loss.forward(layers.back()->output(), correct.view());
-      },
-      m_loss);
-
-  return averageLoss;
+  return evaluateChunks(inputs, correct);
 }
 
 Math::Vector<float>
 FeedForwardModel::evaluate(const Math::MatrixBase<float> &inputs,
                            const Math::VectorBase<float> &correct) {
-  // If loss isn't categorical, throw exception
-  if (!std::holds_alternative<Loss::Categorical>(m_loss) &&
-      !std::holds_alternative<Loss::CategoricalSoftmax>(m_loss))
-    throw ANN::Exception{CURRENT_FUNCTION,
-                         "Can't evalute on vector when loss isn't categorical"};
-
-  Math::Vector<float> averageLoss{};
-  // Layer forward
-  forward(inputs.view(), false);
-  // Loss forward
-  std::visit(Utils::overloaded{[&layers = m_layers, &correct,
-                                &averageLoss](Loss::Categorical &loss) {
-                                 averageLoss = loss.forward(
-                                     layers.back()->output(), correct.view());
-                               },
-                               [&layers = m_layers, &correct,
-                                &averageLoss](Loss::CategoricalSoftmax &loss) {
-                                 averageLoss = loss.forward(
-                                     layers.back()->output(), correct.view());
-                               },
-                               [](auto &) { assert(false); }},
-             m_loss);
+  return evaluateChunks(inputs, correct);
+}
 
-  return averageLoss;
+Math::Vector<float>
+FeedForwardModel::evaluate(const Math::MatrixBase<float> &inputs,
+                           const Math::VectorBase<uint16_t> &correct) {
+  return evaluateChunks(inputs, correct);
+}
+
+Math::Vector<float>
+FeedForwardModel::evaluate(const Math::MatrixBase<float> &inputs,
+                           const Math::VectorBase<uint32_t> &correct) {
+  return evaluateChunks(inputs, correct);
 }
 
 Math::Vector<float>
@@ -430,17 +458,15 @@ FeedForwardModel::predict(const Math::VectorBase<float> &inputs) const {
 
 Math::Matrix<float>
 FeedForwardModel::predict(const Math::MatrixBase<float> &inputs) const {
-  Math::Matrix<float> output{inputs};
-  for (size_t i{}; i < m_layers.size(); ++i) {
-    // Skip dropout layers
-    if (m_layers[i]->type() == Layer::Type::Dropout)
-      continue;
-
-    output = m_layers[i]->predict(output);
-  }
+  InferenceWorkspace workspace{};
+  Math::Matrix<float> output{std::move(predictOutputs(inputs, workspace))};
 
   if (auto loss = std::get_if<Loss::CategoricalSoftmax>(&m_loss))
     return loss->predictSoftmax(output);
+  if (auto loss = std::get_if<Loss::SampledSoftmax>(&m_loss))
+    return loss->predictSoftmax(output);
+  if (auto loss = std::get_if<Loss::BinarySigmoid>(&m_loss))
+    return loss->predictSigmoid(output);
   return output;
 }
 
@@ -451,7 +477,7 @@ void FeedForwardModel::calculateLoss(float *dataLoss,
        &layers = m_layers](const Loss::Loss &loss) {
         // Calculate data loss
         if (dataLoss)
-          *dataLoss = loss.mean();
+          *dataLoss = loss.runningMean();
         // Sum all regularization losses into the single variable
         // i-- in condition because i is size_t, thus will wrap to max if
         // negative
@@ -475,53 +501,161 @@ void FeedForwardModel::calculateLoss(float *dataLoss,
 }
 
 float FeedForwardModel::calculateAccuracy() const {
-  float accuracy{-1};
-  std::visit(
-      Utils::overloaded{
-          [&accuracy](const Loss::Categorical &l) { accuracy = l.accuracy(); },
-          [&accuracy](const Loss::CategoricalSoftmax &l) {
-            accuracy = l.accuracy();
-          },
-          [&accuracy](const Loss::Binary &l) { accuracy = l.accuracy(); },
-          [](const auto &) {}},
-      m_loss);
-  return accuracy;
+  return std::visit(
+      [](const Loss::Loss &loss) { return loss.runningAccuracy(); }, m_loss);
 }
 
-void FeedForwardModel::addLayer(Dense &dense, unsigned int &inputs) {
+void FeedForwardModel::addLayer(Dense &dense, const Math::Shape &inputShape) {
   m_layers.push_back(std::make_unique<Layers::Dense>(
-      inputs, dense.neurons, dense.initMethod, dense.l1Weight, dense.l1Bias,
-      dense.l2Weight, dense.l2Bias));
-  inputs = dense.neurons; // Update inputs for later layers
+      static_cast<unsigned int>(Math::shapeSize(inputShape)), dense.neurons,
+      dense.initMethod, dense.l1Weight, dense.l1Bias, dense.l2Weight,
+      dense.l2Bias));
 }
-void FeedForwardModel::addLayer(Dropout &dropout, unsigned int &) {
+void FeedForwardModel::addLayer(Dropout &dropout, const Math::Shape &) {
   m_layers.push_back(std::make_unique<Layers::Dropout>(dropout.dropRate));
 }
-void FeedForwardModel::addLayer(Step &, unsigned int &) {
+void FeedForwardModel::addLayer(Conv2D &conv, const Math::Shape &inputShape) {
+  const auto [height, width, channels]{
+      imageShape(conv.inputHeight, conv.inputWidth, conv.inputChannels,
+                 inputShape, "Conv2D")};
+
+  m_layers.push_back(std::make_unique<Layers::Conv2D>(
+      height, width, channels, conv.filters, conv.kernelSize, conv.stride,
+      conv.padding, conv.initMethod));
+}
+void FeedForwardModel::addLayer(Embedding &embedding, const Math::Shape &) {
+  m_layers.push_back(std::make_unique<Layers::Embedding>(
+      embedding.vocabularySize, embedding.dimensions, embedding.initMethod));
+}
+void FeedForwardModel::addLayer(LSTM &lstm, const Math::Shape &inputShape) {
+  m_layers.push_back(std::make_unique<Layers::LSTM>(
+      sequenceInputSize(lstm.inputSize, inputShape, "LSTM"), lstm.units,
+      lstm.returnSequences, lstm.initMethod));
+}
+void FeedForwardModel::addLayer(GRU &gru, const Math::Shape &inputShape) {
+  m_layers.push_back(std::make_unique<Layers::GRU>(
+      sequenceInputSize(gru.inputSize, inputShape, "GRU"), gru.units,
+      gru.returnSequences, gru.initMethod));
+}
+void FeedForwardModel::addLayer(MultiHeadAttention &attention,
+                                const Math::Shape &inputShape) {
+  m_layers.push_back(std::make_unique<Layers::MultiHeadAttention>(
+      sequenceInputSize(attention.inputSize, inputShape, "MultiHeadAttention"),
+      attention.heads, attention.initMethod));
+}
+void FeedForwardModel::addLayer(BatchNorm &batchNorm,
+                                const Math::Shape &inputShape) {
+  m_layers.push_back(std::make_unique<Layers::BatchNorm>(
+      static_cast<unsigned int>(Math::shapeSize(inputShape)),
+      batchNorm.momentum, batchNorm.epsilon));
+}
+void FeedForwardModel::addLayer(MaxPool2D &pool,
+                                const Math::Shape &inputShape) {
+  const auto [height, width, channels]{
+      imageShape(pool.inputHeight, pool.inputWidth, pool.inputChannels,
+                 inputShape, "MaxPool2D")};
+
+  m_layers.push_back(std::make_unique<Layers::MaxPool2D>(
+      height, width, channels, pool.poolSize, pool.stride));
+}
+void FeedForwardModel::addLayer(AvgPool2D &pool,
+                                const Math::Shape &inputShape) {
+  const auto [height, width, channels]{
+      imageShape(pool.inputHeight, pool.inputWidth, pool.inputChannels,
+                 inputShape, "AvgPool2D")};
+
+  m_layers.push_back(std::make_unique<Layers::AvgPool2D>(
+      height, width, channels, pool.poolSize, pool.stride));
+}
+void FeedForwardModel::addLayer(Step &, const Math::Shape &) {
   m_layers.push_back(std::make_unique<Activation::Step>());
 }
-void FeedForwardModel::addLayer(ReLU &, unsigned int &) {
+void FeedForwardModel::addLayer(ReLU &, const Math::Shape &) {
   m_layers.push_back(std::make_unique<Activation::ReLU>());
 }
-void FeedForwardModel::addLayer(LeakyReLU &lrelu, unsigned int &) {
+void FeedForwardModel::addLayer(LeakyReLU &lrelu, const Math::Shape &) {
   m_layers.push_back(std::make_unique<Activation::LeakyReLU>(lrelu.alpha));
 }
-void FeedForwardModel::addLayer(Sigmoid &, unsigned int &) {
+void FeedForwardModel::addLayer(Sigmoid &, const Math::Shape &) {
   m_layers.push_back(std::make_unique<Activation::Sigmoid>());
 }
-void FeedForwardModel::addLayer(Softmax &, unsigned int &) {
+void FeedForwardModel::addLayer(Softmax &, const Math::Shape &) {
   m_layers.push_back(std::make_unique<Activation::Softmax>());
 }
 
+std::array<unsigned int, 3>
+FeedForwardModel::imageShape(unsigned int height, unsigned int width,
+                             unsigned int channels,
+                             const Math::Shape &inputShape,
+                             std::string_view layerName) {
+  const size_t inputs{Math::shapeSize(inputShape)};
+
+  // Take missing dimensions from previous image layers
+  if (inputShape.size() == 3) {
+    if (channels == 0)
+      channels = static_cast<unsigned int>(inputShape[2]);
+    if (height == 0 && width == 0) {
+      height = static_cast<unsigned int>(inputShape[0]);
+      width = static_cast<unsigned int>(inputShape[1]);
+    }
+  }
+  if (channels == 0)
+    channels = 1;
+
+  // Infer square image side if dimensions weren't given
+  if (height == 0 && width == 0 && inputs % channels == 0) {
+    height = static_cast<unsigned int>(
+        std::lround(std::sqrt(static_cast<double>(inputs / channels))));
+    width = height;
+  }
+
+  if (static_cast<size_t>(height) * width * channels != inputs)
+    throw ANN::Exception{CURRENT_FUNCTION,
+                         std::string{layerName} +
+                             " input dimensions (height * width * channels) "
+                             "don't match the previous layer's " +
+                             std::to_string(inputs) + " outputs"};
+
+  return {height, width, channels};
+}
+
+unsigned int
+FeedForwardModel::sequenceInputSize(unsigned int inputSize,
+                                    const Math::Shape &inputShape,
+                                    std::string_view layerName) {
+  const size_t inputs{Math::shapeSize(inputShape)};
+
+  // Take missing input size from previous sequence layers
+  if (inputSize == 0)
+    inputSize =
+        inputShape.size() == 2 ? static_cast<unsigned int>(inputShape[1]) : 1;
+
+  if (inputs % inputSize != 0)
+    throw ANN::Exception{CURRENT_FUNCTION,
+                         std::string{layerName} + " input size " +
+                             std::to_string(inputSize) +
+                             " doesn't divide the previous layer's " +
+                             std::to_string(inputs) + " outputs"};
+
+  return inputSize;
+}
+
 void FeedForwardModel::setLoss(CategoricalCrossEntropyLoss &) {
   m_loss = Loss::Categorical{};
 }
 void FeedForwardModel::setLoss(CategoricalCrossEntropySoftmaxLoss &) {
   m_loss = Loss::CategoricalSoftmax{};
 }
+void FeedForwardModel::setLoss(
+    SampledCategoricalCrossEntropySoftmaxLoss &sampled) {
+  m_loss = Loss::SampledSoftmax{sampled.samples, sampled.logUniform};
+}
 void FeedForwardModel::setLoss(BinaryCrossEntropyLoss &) {
   m_loss = Loss::Binary{};
 }
+void FeedForwardModel::setLoss(BinaryCrossEntropySigmoidLoss &) {
+  m_loss = Loss::BinarySigmoid{};
+}
 void FeedForwardModel::setLoss(MeanSquaredErrorLoss &) { m_loss = Loss::MSE{}; }
 void FeedForwardModel::setLoss(MeanAbsoluteErrorLoss &) {
   m_loss = Loss::MAE{};
@@ -543,6 +677,16 @@ void FeedForwardModel::setOptimizer(Adam &adam) {
   m_optimizer = std::make_unique<Optimizers::Adam>(
       adam.learningRate, adam.decay, adam.epsilon, adam.beta1, adam.beta2);
 }
+void FeedForwardModel::setOptimizer(LAMB &lamb) {
+  m_optimizer = std::make_unique<Optimizers::LAMB>(
+      lamb.learningRate, lamb.decay, lamb.epsilon, lamb.beta1, lamb.beta2,
+      lamb.weightDecay);
+}
+void FeedForwardModel::setOptimizer(LARS &lars) {
+  m_optimizer = std::make_unique<Optimizers::LARS>(
+      lars.learningRate, lars.decay, lars.momentum, lars.weightDecay,
+      lars.trustCoefficient);
+}
 
 std::vector<size_t>
 FeedForwardModel::createBatchSequence(size_t stepNum) const {
@@ -555,93 +699,492 @@ FeedForwardModel::createBatchSequence(size_t stepNum) const {
 
 void FeedForwardModel::forward(const Math::MatrixBase<float> &batchData,
                                bool training) {
+  const bool isCheckpointing{training && m_gradientCheckpointing};
+  if (isCheckpointing)
+    m_batchInputs = batchData.view();
+
   auto layerInputs{batchData.view()};
-  for (size_t i{}; i < m_layers.size(); ++i) {
+  const size_t layers{training ? trainedLayers() : m_layers.size()};
+  for (size_t i{}; i < layers; ++i) {
     // If not training, skip dropout layers
     if (!training && m_layers[i]->type() == Layer::Type::Dropout)
       continue;
 
+    m_layers[i]->setTraining(training);
     layerInputs = m_layers[i]->forward(layerInputs).view();
+
+    // The previous layer's outputs were just consumed
+    if (isCheckpointing && i > 0 && isRecomputed(i - 1))
+      m_layers[i - 1]->releaseActivations();
   }
 }
 
 void FeedForwardModel::optimize(
     const Math::MatrixBase<float> &outputGradients) {
-  m_optimizer->preUpdate();
+  backward(outputGradients);
+  updateParameters();
+}
+
+void FeedForwardModel::backward(
+    const Math::MatrixBase<float> &outputGradients) {
+  const size_t segment{segmentSize()};
 
   auto currentDValues{outputGradients.view()};
   // i-- in condition because i is size_t, thus will wrap to max if negative
-  for (size_t i{m_layers.size()}; i-- > 0;) {
+  for (size_t i{trainedLayers()}; i-- > 0;) {
+    // Recompute the released activations of the segment i ends
+    if (m_gradientCheckpointing && (i + 1) % segment == 0)
+      for (size_t j{i - i % segment}; j < i; ++j)
+        if (isRecomputed(j))
+          m_layers[j]->forward(j == 0 ? m_batchInputs
+                                      : m_layers[j - 1]->output().view());
+
     currentDValues = m_layers[i]->backward(currentDValues).view();
-    if (m_layers[i]->isTrainable())
-      switch (m_layers[i]->type()) {
-      case Layer::Type::Dense: {
-        m_optimizer->updateParams(dynamic_cast<Layers::Dense &>(*m_layers[i]));
-        break;
-      }
-      default:
-        break;
-      }
+
+    // Layers after i are done, so only a single segment is live at a time
+    if (isRecomputed(i))
+      m_layers[i]->releaseActivations();
+  }
+}
+
+void FeedForwardModel::updateParameters() {
+  collectParameters();
+
+  std::span<const Parameter> params{m_parameters};
+  if (!m_replicas.empty())
+    params = allReduce(params);
+  if (m_gradientAccumulationSteps > 1) {
+    m_accumulator.add(params);
+    if (!m_isStepEnd)
+      return;
+    params = m_accumulator.mean(params);
   }
+
+  m_optimizer->preUpdate();
+  m_optimizer->update(params);
   m_optimizer->postUpdate();
+
+  if (!m_replicas.empty())
+    broadcastParameters(params);
+}
+
+void FeedForwardModel::collectParameters() {
+  m_parameters.clear();
+  for (auto &layer : m_layers)
+    if (layer->isTrainable())
+      std::ranges::copy(layer->parameters(), std::back_inserter(m_parameters));
+}
+
+template <typename Correct>
+Math::MatrixView<float>
+FeedForwardModel::lossGradients(const Math::MatrixBase<float> &batchData,
+                                const Correct &batchCorrect) {
+  Math::MatrixView<float> outputGradients{};
+  if constexpr (std::is_base_of_v<Math::MatrixBase<float>, Correct>)
+    std::visit(
+        [this, &batchCorrect, &outputGradients](Loss::Loss &loss) {
+          loss.forward(outputs(), batchCorrect);
+          outputGradients = loss.backward().view();
+        },
+        m_loss);
+  else
+    std::visit(Utils::overloaded{
+                   [this, &batchCorrect,
+                    &outputGradients](Loss::Categorical &loss) {
+                     loss.forward(outputs(), batchCorrect);
+                     outputGradients = loss.backward().view();
+                   },
+                   [this, &batchCorrect,
+                    &outputGradients](Loss::CategoricalSoftmax &loss) {
+                     loss.forward(outputs(), batchCorrect);
+                     outputGradients = loss.backward().view();
+                   },
+                   [this, &batchData, &batchCorrect,
+                    &outputGradients](Loss::SampledSoftmax &loss) {
+                     // The last layer only computes the sampled logits
+                     auto &head{
+                         dynamic_cast<Layers::Dense &>(*m_layers.back())};
+                     const auto headInputs{
+                         m_layers.size() > 1
+                             ? m_layers[m_layers.size() - 2]->output().view()
+                             : batchData.view()};
+                     loss.forward(head, headInputs, batchCorrect);
+                     outputGradients =
+                         head.backwardSampled(loss.backwardSampled()).view();
+                   },
+                   [](auto &) { assert(false); }},
+               m_loss);
+
+  return outputGradients;
+}
+
+template <typename Correct>
+void FeedForwardModel::trainReplicas(const Math::MatrixBase<float> &batchData,
+                                     const Correct &batchCorrect) {
+  const size_t shard{batchData.rows() / m_dataParallelReplicas};
+
+  // The model itself is the first replica. Every replica runs its shard on a
+  // thread of its own, whose kernels split the remaining cores (see
+  // Utils::Parallel::threadBudget())
+  Utils::Parallel::parallelFor(
+      m_dataParallelReplicas,
+      [this, &batchData, &batchCorrect, shard](size_t replica) {
+        FeedForwardModel &model{replica == 0 ? *this
+                                             : *m_replicas[replica - 1]};
+        const auto shardData{
+            batchData.view(replica * shard, (replica + 1) * shard)};
+        const auto shardCorrect{
+            batchCorrect.view(replica * shard, (replica + 1) * shard)};
+
+        model.forward(shardData);
+        model.backward(model.lossGradients(shardData, shardCorrect));
+      },
+      m_dataParallelReplicas);
+
+  // The model's loss holds the metrics of every shard
+  for (auto &replica : m_replicas)
+    std::visit(
+        [this](Loss::Loss &part) {
+          std::visit([&part](Loss::Loss &total) { total.mergeMetrics(part); },
+                     m_loss);
+          part.resetMetrics();
+        },
+        replica->m_loss);
+
+  updateParameters();
+}
+
+std::span<const Parameter>
+FeedForwardModel::allReduce(std::span<const Parameter> params) {
+  // Shards are of the same size, so the mean of the replicas' gradients (each
+  // a mean over its shard) is the gradient of the whole batch. Sparse
+  // gradients are summed over the union of the rows touched by every replica
+  m_replicaGradients.add(params);
+  for (auto &replica : m_replicas) {
+    replica->collectParameters();
+    m_replicaGradients.add(replica->m_parameters);
+  }
+
+  return m_replicaGradients.mean(params);
+}
+
+void FeedForwardModel::broadcastParameters(std::span<const Parameter> params) {
+  size_t values{};
+  for (const Parameter &param : params)
+    values += param.values.size();
+
+  Utils::Parallel::dynamicParallelFor(
+      values, m_replicas.size(), [this, params](size_t replica) {
+        const auto &replicaParams{m_replicas[replica]->m_parameters};
+        for (size_t i{}; i < params.size(); ++i) {
+          const Parameter &param{params[i]};
+          float *values{replicaParams[i].values.data()};
+          if (!param.isSparse()) {
+            std::ranges::copy(param.values, values);
+            continue;
+          }
+
+          // Sparse parameters were only updated on their touched rows
+          for (size_t row : param.rows)
+            std::copy_n(&param.values[row * param.rowSize], param.rowSize,
+                        values + row * param.rowSize);
+        }
+      });
+}
+
+size_t FeedForwardModel::planTraining(size_t validationSamples) {
+  // Validation runs on the model itself
+  size_t bytes{validationSamples > 0
+                   ? planEvaluation(evaluationThreads(validationSamples))
+                   : 0};
+  if (m_dataParallelReplicas == 1)
+    return bytes + planMemory(m_batchSize);
+
+  if (m_replicas.size() != m_dataParallelReplicas - 1) {
+    m_replicas.clear();
+    for (size_t i{1}; i < m_dataParallelReplicas; ++i) {
+      auto replica{std::make_unique<FeedForwardModel>(m_modelDescriptor)};
+      replica->m_loss = evaluationLoss();
+      replica->m_gradientCheckpointing = m_gradientCheckpointing;
+      m_replicas.push_back(std::move(replica));
+    }
+  }
+
+  // Replicas start from the model's parameters (which may have been loaded or
+  // trained since they were built)
+  collectParameters();
+  for (auto &replica : m_replicas) {
+    replica->collectParameters();
+    for (size_t i{}; i < m_parameters.size(); ++i)
+      std::ranges::copy(m_parameters[i].values,
+                        replica->m_parameters[i].values.begin());
+  }
+
+  const size_t shard{m_batchSize / m_dataParallelReplicas};
+  bytes += planMemory(shard);
+  for (auto &replica : m_replicas)
+    bytes += replica->planMemory(shard);
+
+  return bytes;
+}
+
+size_t FeedForwardModel::evaluationThreads(size_t samples) {
+  const size_t chunks{(samples + evaluationChunkSize - 1) /
+                      evaluationChunkSize};
+  return std::clamp<size_t>(Utils::Parallel::threadBudget(), 1,
+                            std::max<size_t>(chunks, 1));
+}
+
+bool FeedForwardModel::isEvaluationPlanned(size_t threads) const {
+  if (m_evaluation.size() < threads)
+    return false;
+  for (size_t i{}; i < threads; ++i)
+    if (m_evaluation[i].lossKind != m_loss.index())
+      return false;
+  return true;
+}
+
+size_t FeedForwardModel::planEvaluation(size_t threads) {
+  if (m_evaluation.size() < threads)
+    m_evaluation.resize(threads);
+
+  Math::Shape shape{m_inputs};
+  for (const auto &layer : m_layers)
+    shape = layer->outputShape(shape);
+  const size_t outputs{Math::shapeSize(shape)};
+
+  size_t bytes{};
+  for (size_t i{}; i < threads; ++i) {
+    EvaluationWorkspace &workspace{m_evaluation[i]};
+    if (workspace.lossKind != m_loss.index()) {
+      workspace.loss = evaluationLoss();
+      workspace.lossKind = m_loss.index();
+    }
+
+    bytes += reserveWorkspace(workspace.inference, evaluationChunkSize);
+    bytes += std::visit(
+        [outputs](Loss::Loss &loss) {
+          return loss.reserve(evaluationChunkSize, outputs);
+        },
+        workspace.loss);
+  }
+
+  return bytes;
 }
 
-std::stringstream FeedForwardModel::getUpdateMsg(double epochTime,
-                                                 size_t currentBatch,
-                                                 size_t stepNum) const {
-  std::stringstream out{};
-  out << std::fixed << std::setprecision(4) << currentBatch + 1 << '/'
-      << stepNum << '\t' << static_cast<size_t>(epochTime) << "s "
-      << formatTime(epochTime / (static_cast<double>(currentBatch + 1)))
-      << "/step \t";
+size_t FeedForwardModel::segmentSize() const {
+  return std::max(1uz, static_cast<size_t>(std::ceil(std::sqrt(
+                           static_cast<double>(m_layers.size())))));
+}
 
-  // Calculate loss to be displayed (only if verbose is true)
-  float dataLoss{};
-  float regularizationLoss{};
-  calculateLoss(&dataLoss, &regularizationLoss);
+bool FeedForwardModel::isRecomputed(size_t layer) const {
+  const size_t segment{segmentSize()};
+  return m_gradientCheckpointing && m_layers[layer]->isRecomputable() &&
+         (layer + 1) % segment != 0 &&
+         layer / segment != (m_layers.size() - 1) / segment;
+}
 
-  // Get accuracy only for classification losses (no regression accuracy)
-  if (float val{calculateAccuracy()}; val != -1)
-    out << "accuracy: " << val << " - ";
+size_t FeedForwardModel::planMemory(size_t maxBatchSize) {
+  if (!m_isModelLoaded)
+    throw ANN::Exception{CURRENT_FUNCTION,
+                         "Can't plan memory while model isn't loaded"};
+
+  size_t bytes{};
+  Math::Shape shape{m_inputs};
+  for (size_t i{}; i < m_layers.size(); ++i) {
+    if (!isRecomputed(i))
+      bytes += m_layers[i]->reserve(maxBatchSize, shape);
+    shape = m_layers[i]->outputShape(shape);
+  }
 
-  out << "loss: " << dataLoss + regularizationLoss
-      << " (data loss: " << dataLoss << ", reg loss: " << regularizationLoss
-      << ") - lr: " << m_optimizer->learningRate();
+  return bytes + std::visit(
+                     [maxBatchSize, &shape](Loss::Loss &loss) {
+                       return loss.reserve(maxBatchSize,
+                                           Math::shapeSize(shape));
+                     },
+                     m_loss);
+}
 
-  return out;
+Math::MatrixView<float> FeedForwardModel::outputs() const {
+  return m_layers.back()->output().view();
 }
 
+Math::Matrix<float> &
+FeedForwardModel::predictOutputs(const Math::MatrixBase<float> &inputs,
+                                 InferenceWorkspace &workspace) const {
+  // Layers alternate between two buffers, reading the other one's outputs
+  if (workspace.buffers.size() < 2)
+    workspace.buffers.resize(2);
+
+  const Math::MatrixBase<float> *layerInputs{&inputs};
+  Math::Matrix<float> *outputs{};
+  for (size_t i{}; i < m_layers.size(); ++i) {
+    // Skip dropout layers
+    if (m_layers[i]->type() == Layer::Type::Dropout)
+      continue;
+
+    outputs = &workspace.buffers[outputs == &workspace.buffers[0] ? 1 : 0];
+    m_layers[i]->predict(*layerInputs, *outputs);
+    layerInputs = outputs;
+  }
+
+  // Dropout layers only, which pass the inputs through
+  if (!outputs) {
+    outputs = &workspace.buffers.front();
+    *outputs = Math::Matrix<float>{inputs};
+  }
+
+  return *outputs;
+}
+
+size_t FeedForwardModel::reserveWorkspace(InferenceWorkspace &workspace,
+                                          size_t maxBatchSize) const {
+  if (workspace.buffers.size() < 2)
+    workspace.buffers.resize(2);
+
+  // Both buffers hold up to the widest layer outputs
+  size_t cols{m_inputs};
+  Math::Shape shape{m_inputs};
+  for (const auto &layer : m_layers) {
+    shape = layer->outputShape(shape);
+    cols = std::max(cols, Math::shapeSize(shape));
+  }
+
+  for (auto &buffer : workspace.buffers)
+    buffer.reserve(maxBatchSize, cols);
+  return workspace.buffers.size() * maxBatchSize * cols * sizeof(float);
+}
+
+template <typename Correct>
 Math::Vector<float>
-FeedForwardModel::argmaxFloat(const Math::MatrixBase<float> &m) {
-  // Make a vector of the indices of the biggest values in each row
-  // i.e. the correct index in each batch
-  Math::Vector<float> max{m.rows()};
+FeedForwardModel::evaluateChunks(const Math::MatrixBase<float> &inputs,
+                                 const Correct &correct) {
+  // If loss isn't categorical, throw exception
+  if constexpr (!std::is_same_v<Correct, Math::MatrixBase<float>>)
+    if (!std::holds_alternative<Loss::Categorical>(m_loss) &&
+        !std::holds_alternative<Loss::CategoricalSoftmax>(m_loss) &&
+        !std::holds_alternative<Loss::SampledSoftmax>(m_loss))
+      throw ANN::Exception{
+          CURRENT_FUNCTION,
+          "Can't evaluate on vector when loss isn't categorical"};
+
+  const size_t chunks{(inputs.rows() + evaluationChunkSize - 1) /
+                      evaluationChunkSize};
+  // A single thread evaluates inline
+  const size_t threads{evaluationThreads(inputs.rows())};
+
+  // Workspaces are only built when the thread count or loss changes
+  if (!isEvaluationPlanned(threads))
+    planEvaluation(threads);
+  for (size_t i{}; i < threads; ++i)
+    std::visit([](Loss::Loss &loss) { loss.resetMetrics(); },
+               m_evaluation[i].loss);
+
+  // Every thread takes every threads-th chunk, and keeps its own workspace
+  // (with the loss' running metrics) across them
+  Math::Vector<float> sampleLosses{inputs.rows()};
+  Utils::Parallel::dynamicParallelFor(
+      0, threads,
+      [this, &inputs, &correct, &sampleLosses, chunks,
+       threads](size_t thread) {
+        EvaluationWorkspace &workspace{m_evaluation[thread]};
+        for (size_t chunk{thread}; chunk < chunks; chunk += threads) {
+          const size_t start{chunk * evaluationChunkSize};
+          const size_t end{
+              std::min(start + evaluationChunkSize, inputs.rows())};
+          const Math::Matrix<float> &outputs{
+              predictOutputs(inputs.view(start, end), workspace.inference)};
+          const auto chunkCorrect{correct.view(start, end)};
+
+          const Math::Vector<float> *chunkLosses{};
+          if constexpr (!std::is_same_v<Correct, Math::MatrixBase<float>>)
+            std::visit(Utils::overloaded{
+                           [&](Loss::Categorical &loss) {
+                             chunkLosses = &loss.forward(outputs, chunkCorrect);
+                           },
+                           [&](Loss::CategoricalSoftmax &loss) {
+                             chunkLosses = &loss.forward(outputs, chunkCorrect);
+                           },
+                           [](auto &) { assert(false); }},
+                       workspace.loss);
+          else
+            std::visit(
+                [&](Loss::Loss &loss) {
+                  chunkLosses = &loss.forward(outputs, chunkCorrect);
+                },
+                workspace.loss);
+
+          std::ranges::copy(chunkLosses->data(),
+                            sampleLosses.data().begin() +
+                                static_cast<std::ptrdiff_t>(start));
+        }
+      },
+      threads > 1);
 
-  for (size_t i{}; i < m.rows(); ++i)
-    for (size_t j{}; j < m.cols(); ++j)
-      if (m[i, static_cast<size_t>(max[i])] < m[i, j])
-        max[i] = static_cast<float>(j);
+  // The model's loss holds the metrics of the whole evaluation
+  std::visit(
+      [this, threads](Loss::Loss &total) {
+        total.resetMetrics();
+        for (size_t i{}; i < threads; ++i)
+          std::visit(
+              [&total](const Loss::Loss &part) { total.mergeMetrics(part); },
+              m_evaluation[i].loss);
+      },
+      m_loss);
 
-  return max;
+  return sampleLosses;
 }
 
-std::string FeedForwardModel::formatTime(double seconds) {
-  if (seconds >= 1.0)
-    return std::to_string(static_cast<unsigned long long>(seconds)) + "s";
+FeedForwardModel::LossVariant FeedForwardModel::evaluationLoss() const {
+  return std::visit(
+      Utils::overloaded{
+          [](const Loss::SampledSoftmax &) -> LossVariant {
+            return Loss::CategoricalSoftmax{};
+          },
+          [](const auto &loss) -> LossVariant {
+            return std::remove_cvref_t<decltype(loss)>{};
+          }},
+      m_loss);
+}
 
-  const unsigned long long ns = static_cast<unsigned long long>(seconds * 1e9);
-  if (ns < 1000)
-    return std::to_string(ns) + "ns";
+size_t FeedForwardModel::trainedLayers() const {
+  return std::holds_alternative<Loss::SampledSoftmax>(m_loss)
+             ? m_layers.size() - 1
+             : m_layers.size();
+}
 
-  const unsigned long long us = ns / 1000;
-  if (us < 1000)
-    return std::to_string(us) + "us";
+TrainingLog::Update FeedForwardModel::progress(double epochTime,
+                                              size_t currentBatch,
+                                              size_t stepNum) const {
+  TrainingLog::Update update{.batch = currentBatch,
+                             .steps = stepNum,
+                             .epochTime = epochTime,
+                             .learningRate = m_optimizer->learningRate()};
 
-  const unsigned long long ms = us / 1000;
-  if (ms < 1000)
-    return std::to_string(ms) + "ms";
+  // Running averages over the epoch, and the regularization loss tracked by
+  // the optimizer, so nothing is recomputed here
+  std::visit(
+      [&update](const Loss::Loss &loss) {
+        update.dataLoss = loss.runningMean();
+        update.accuracy = loss.runningAccuracy();
+      },
+      m_loss);
+  calculateLoss(nullptr, &update.regularizationLoss);
 
-  // Fallback: round down to 0s
-  return "0s";
+  return update;
+}
+
+Math::Vector<uint32_t>
+FeedForwardModel::argmaxLabels(const Math::MatrixBase<float> &m) {
+  // Make a vector of the indices of the biggest values in each row
+  // i.e. the correct index in each batch
+  Math::Vector<uint32_t> max{m.rows()};
+
+  for (size_t i{}; i < m.rows(); ++i)
+    for (size_t j{}; j < m.cols(); ++j)
+      if (m[i, max[i]] < m[i, j])
+        max[i] = static_cast<uint32_t>(j);
+
+  return max;
 }
 } // namespace ANN
@@ -0,0 +1,90 @@
+#include "ann/gradientAccumulator.h"
+
+#include "utils/parallel.h"
+
+#include <algorithm>
+
+namespace ANN {
+// Gradient items summed by a single parallel iteration
+static constexpr size_t chunkSize{4096};
+
+void GradientAccumulator::add(std::span<const Parameter> params) {
+  const bool isFirst{m_count == 0};
+  m_buffers.resize(params.size());
+
+  for (size_t i{}; i < params.size(); ++i) {
+    const Parameter &param{params[i]};
+    Buffer &buffer{m_buffers[i]};
+
+    if (param.isSparse()) {
+      if (isFirst) {
+        for (size_t row : buffer.rows)
+          buffer.slots[row] = noSlot;
+        buffer.rows.clear();
+        buffer.gradients.clear();
+        buffer.slots.resize(param.values.size() / param.rowSize, noSlot);
+      }
+      addRows(param, buffer);
+      continue;
+    }
+
+    if (isFirst) {
+      buffer.gradients.assign(param.gradients.begin(), param.gradients.end());
+      continue;
+    }
+
+    const size_t size{param.gradients.size()};
+    Utils::Parallel::dynamicParallelFor(
+        chunkSize, (size + chunkSize - 1) / chunkSize,
+        [&param, &buffer, size](size_t chunk) {
+          const size_t start{chunk * chunkSize};
+          const size_t end{std::min(start + chunkSize, size)};
+          float *sums{buffer.gradients.data()};
+          const float *gradients{param.gradients.data()};
+          for (size_t j{start}; j < end; ++j)
+            sums[j] += gradients[j];
+        });
+  }
+
+  ++m_count;
+}
+
+std::span<const Parameter>
+GradientAccumulator::mean(std::span<const Parameter> params) {
+  if (m_count == 0)
+    return params;
+
+  const float scale{1.0f / static_cast<float>(m_count)};
+  m_mean.clear();
+  for (size_t i{}; i < params.size(); ++i) {
+    Buffer &buffer{m_buffers[i]};
+    for (float &gradient : buffer.gradients)
+      gradient *= scale;
+
+    Parameter &mean{m_mean.emplace_back(params[i])};
+    mean.gradients = buffer.gradients;
+    if (mean.isSparse())
+      mean.rows = buffer.rows;
+  }
+
+  m_count = 0;
+  return m_mean;
+}
+
+void GradientAccumulator::addRows(const Parameter &param, Buffer &buffer) {
+  const size_t rowSize{param.rowSize};
+  for (size_t i{}; i < param.rows.size(); ++i) {
+    size_t &slot{buffer.slots[param.rows[i]]};
+    if (slot == noSlot) {
+      slot = buffer.rows.size();
+      buffer.rows.push_back(param.rows[i]);
+      buffer.gradients.resize(buffer.gradients.size() + rowSize);
+    }
+
+    float *sums{&buffer.gradients[slot * rowSize]};
+    const float *gradients{&param.gradients[i * rowSize]};
+    for (size_t j{}; j < rowSize; ++j)
+      sums[j] += gradients[j];
+  }
+}
+} // namespace ANN
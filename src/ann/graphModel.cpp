@@ -0,0 +1,601 @@
+#include "ann/graphModel.h"
+#include "ann/exception.h"
+#include "ann/layer.h"
+#include "ann/modelDescriptors.h"
+
+#include "ann/layers/batchNorm.h"
+#include "ann/layers/dense.h"
+
+#include "utils/exceptions.h"
+#include "utils/variants.h"
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <string>
+#include <variant>
+
+namespace ANN {
+GraphModel::GraphModel(ModelDesc modelDescriptor) {
+  configure(modelDescriptor);
+}
+
+GraphModel::GraphModel(ModelDesc modelDescriptor,
+                       TrainDesc trainingDescriptor) {
+  configure(modelDescriptor, trainingDescriptor);
+}
+
+void GraphModel::configure(ModelDesc modelDescriptor) {
+  if (modelDescriptor.nodes.empty())
+    throw ANN::Exception{CURRENT_FUNCTION,
+                         "Can't configure model with an empty node array"};
+  if (modelDescriptor.inputs <= 0)
+    throw ANN::Exception{
+        CURRENT_FUNCTION,
+        "Can't configure model with a non-positive input number " +
+            std::to_string(modelDescriptor.inputs)};
+
+  auto &nodes{modelDescriptor.nodes};
+  const size_t nodeNum{nodes.size()};
+
+  // Validate node inputs. Inputs are in descriptor numbering (0 is the model
+  // inputs, n is the n-th node)
+  for (size_t i{}; i < nodeNum; ++i) {
+    auto &node{nodes[i]};
+    const std::string nodeStr{"Node " + std::to_string(i + 1)};
+
+    const bool isLayer{!std::holds_alternative<std::monostate>(node.layer)};
+    if (isLayer == (node.merge != Merge::None))
+      throw ANN::Exception{CURRENT_FUNCTION,
+                           nodeStr + " must be either a layer or a merge"};
+
+    // Default to the previous node
+    if (node.inputs.empty())
+      node.inputs.push_back(i);
+
+    if (isLayer && node.inputs.size() != 1)
+      throw ANN::Exception{CURRENT_FUNCTION,
+                           nodeStr + " is a layer, so it must receive a "
+                                     "single input"};
+    if (!isLayer && node.inputs.size() < 2)
+      throw ANN::Exception{CURRENT_FUNCTION,
+                           nodeStr + " is a merge, so it must receive at "
+                                     "least two inputs"};
+    for (size_t input : node.inputs)
+      if (input > nodeNum)
+        throw ANN::Exception{CURRENT_FUNCTION,
+                             nodeStr + " receives missing node " +
+                                 std::to_string(input)};
+  }
+
+  // Every node must lead to the last one (the model outputs)
+  std::vector<bool> leadsToOutputs(nodeNum);
+  std::vector<size_t> toVisit{nodeNum - 1};
+  leadsToOutputs.back() = true;
+  while (!toVisit.empty()) {
+    const size_t i{toVisit.back()};
+    toVisit.pop_back();
+    for (size_t input : nodes[i].inputs)
+      if (input != 0 && !leadsToOutputs[input - 1]) {
+        leadsToOutputs[input - 1] = true;
+        toVisit.push_back(input - 1);
+      }
+  }
+  if (auto it{std::ranges::find(leadsToOutputs, false)};
+      it != leadsToOutputs.end())
+    throw ANN::Exception{
+        CURRENT_FUNCTION,
+        "Node " + std::to_string(it - leadsToOutputs.begin() + 1) +
+            " doesn't lead to the model outputs (the last node)"};
+
+  // Schedule topologically (Kahn's algorithm). Ready nodes are taken in
+  // descriptor order, so a descriptor which is already ordered keeps its order
+  std::vector<size_t> pendingInputs(nodeNum);
+  std::vector<std::vector<size_t>> readers(nodeNum + 1);
+  for (size_t i{}; i < nodeNum; ++i)
+    for (size_t input : nodes[i].inputs)
+      if (input != 0) {
+        ++pendingInputs[i];
+        readers[input].push_back(i);
+      }
+
+  std::priority_queue<size_t, std::vector<size_t>, std::greater<>> ready{};
+  for (size_t i{}; i < nodeNum; ++i)
+    if (pendingInputs[i] == 0)
+      ready.push(i);
+
+  std::vector<size_t> order{};
+  while (!ready.empty()) {
+    const size_t i{ready.top()};
+    ready.pop();
+    order.push_back(i);
+    for (size_t reader : readers[i + 1])
+      if (--pendingInputs[reader] == 0)
+        ready.push(reader);
+  }
+  if (order.size() != nodeNum)
+    throw ANN::Exception{CURRENT_FUNCTION, "Can't configure model with nodes "
+                                           "that form a cycle"};
+
+  // Value of every descriptor node in the schedule
+  std::vector<size_t> valueOf(nodeNum + 1);
+  for (size_t k{}; k < nodeNum; ++k)
+    valueOf[order[k] + 1] = k + 1;
+
+  m_inputs = modelDescriptor.inputs;
+  m_layers.clear();
+  m_nodes.clear();
+
+  // Per-sample shape of every value
+  std::vector<Math::Shape> shapes{Math::Shape{m_inputs}};
+  for (size_t i : order) {
+    auto &descriptor{nodes[i]};
+    const std::string nodeStr{"Node " + std::to_string(i + 1)};
+
+    Node node{.merge = descriptor.merge};
+    for (size_t input : descriptor.inputs)
+      node.inputs.push_back(valueOf[input]);
+
+    const Math::Shape &inputShape{shapes[node.inputs.front()]};
+    switch (node.merge) {
+    case Merge::None:
+      node.layer = m_layers.size();
+      std::visit(Utils::overloaded{[](std::monostate &) {},
+                                   [this, &inputShape](auto &layer) {
+                                     addLayer(layer, inputShape);
+                                   }},
+                 descriptor.layer);
+      shapes.push_back(m_layers.back()->outputShape(inputShape));
+      break;
+    case Merge::Add:
+      for (size_t input : node.inputs)
+        if (Math::shapeSize(shapes[input]) != Math::shapeSize(inputShape))
+          throw ANN::Exception{CURRENT_FUNCTION,
+                               nodeStr + " adds inputs of different sizes"};
+      shapes.push_back(inputShape);
+      break;
+    case Merge::Concat: {
+      size_t size{};
+      for (size_t input : node.inputs)
+        size += Math::shapeSize(shapes[input]);
+      shapes.push_back(Math::Shape{size});
+      break;
+    }
+    }
+
+    m_nodes.push_back(std::move(node));
+  }
+
+  m_valueSizes.clear();
+  for (const auto &shape : shapes)
+    m_valueSizes.push_back(Math::shapeSize(shape));
+
+  planBuffers();
+
+  // Set that a model was loaded
+  m_isModelLoaded = true;
+}
+
+void GraphModel::configure(TrainDesc trainingDescriptor) {
+  // The sampled pass computes the logits of the last Dense layer from its
+  // inputs, which a graph doesn't single out
+  if (std::holds_alternative<SampledCategoricalCrossEntropySoftmaxLoss>(
+          trainingDescriptor.loss))
+    throw ANN::Exception{CURRENT_FUNCTION,
+                         "Graph models can't be trained with sampled softmax"};
+  // Replicas are built from feed forward model descriptors
+  if (trainingDescriptor.dataParallelReplicas > 1)
+    throw ANN::Exception{CURRENT_FUNCTION,
+                         "Graph models can't be trained with data-parallel "
+                         "replicas"};
+
+  FeedForwardModel::configure(trainingDescriptor);
+}
+
+void GraphModel::configure(ModelDesc modelDescriptor,
+                           TrainDesc trainingDescriptor) {
+  configure(modelDescriptor);
+  configure(trainingDescriptor);
+}
+
+void GraphModel::freeze() {
+  if (!m_isModelLoaded)
+    throw ANN::Exception{CURRENT_FUNCTION,
+                         "Can't freeze model while it isn't loaded"};
+
+  for (size_t k{}; k < m_nodes.size(); ++k) {
+    if (m_nodes[k].merge != Merge::None ||
+        m_layers[m_nodes[k].layer]->type() != Layer::Type::BatchNorm)
+      continue;
+
+    const size_t input{m_nodes[k].inputs.front()};
+    if (input == 0 || m_nodes[input - 1].merge != Merge::None ||
+        m_layers[m_nodes[input - 1].layer]->type() != Layer::Type::Dense)
+      continue;
+
+    // The dense outputs must be read by the batch norm only
+    size_t readers{};
+    for (const auto &node : m_nodes)
+      readers += static_cast<size_t>(std::ranges::count(node.inputs, input));
+    if (readers != 1)
+      continue;
+
+    const size_t removedValue{k + 1};
+    const size_t removedLayer{m_nodes[k].layer};
+    dynamic_cast<Layers::BatchNorm &>(*m_layers[removedLayer])
+        .foldInto(
+            dynamic_cast<Layers::Dense &>(*m_layers[m_nodes[input - 1].layer]));
+
+    // Readers of the batch norm read the dense outputs instead
+    m_nodes.erase(m_nodes.begin() + static_cast<std::ptrdiff_t>(k));
+    m_layers.erase(m_layers.begin() +
+                   static_cast<std::ptrdiff_t>(removedLayer));
+    m_valueSizes.erase(m_valueSizes.begin() +
+                       static_cast<std::ptrdiff_t>(removedValue));
+    for (auto &node : m_nodes) {
+      if (node.merge == Merge::None && node.layer > removedLayer)
+        --node.layer;
+      for (size_t &value : node.inputs)
+        if (value == removedValue)
+          value = input;
+        else if (value > removedValue)
+          --value;
+    }
+    --k;
+  }
+
+  // Remaining batch norms normalize with their running statistics
+  for (auto &layer : m_layers)
+    layer->setTraining(false);
+
+  planBuffers();
+  m_isFrozen = true;
+}
+
+Math::Matrix<float> &
+GraphModel::predictOutputs(const Math::MatrixBase<float> &inputs,
+                           InferenceWorkspace &workspace) const {
+  auto &buffers{workspace.buffers};
+  auto &values{workspace.values};
+  auto &mergeInputs{workspace.mergeInputs};
+  if (buffers.size() < std::max(m_activationBuffers, 1uz))
+    buffers.resize(std::max(m_activationBuffers, 1uz));
+  values.resize(m_nodes.size() + 1);
+
+  values[0] = inputs.view();
+  for (size_t k{}; k < m_nodes.size(); ++k) {
+    const Node &node{m_nodes[k]};
+    // Skip dropout layers
+    if (isDropout(node)) {
+      values[k + 1] = values[node.inputs.front()];
+      continue;
+    }
+
+    auto &output{buffers[m_activationBuffer[k + 1]]};
+    if (node.merge == Merge::None) {
+      m_layers[node.layer]->predict(values[node.inputs.front()], output);
+    } else {
+      mergeInputs.clear();
+      for (size_t input : node.inputs)
+        mergeInputs.push_back(values[input]);
+      merge(node, mergeInputs, output);
+    }
+    values[k + 1] = output.view();
+  }
+
+  // Without a buffer, the model outputs are its inputs passed through dropout
+  // nodes
+  const size_t outputBuffer{m_activationBuffer[m_inferenceValue.back()]};
+  if (outputBuffer == noBuffer) {
+    buffers.front() = Math::Matrix<float>{inputs};
+    return buffers.front();
+  }
+  return buffers[outputBuffer];
+}
+
+size_t GraphModel::reserveWorkspace(InferenceWorkspace &workspace,
+                                    size_t maxBatchSize) const {
+  // Without buffers, the single one holds the model inputs
+  std::vector<size_t> cols(std::max(m_activationBuffers, 1uz));
+  if (m_activationBuffers == 0)
+    cols.front() = m_valueSizes.front();
+  for (size_t value{1}; value < m_valueSizes.size(); ++value)
+    if (m_activationBuffer[value] != noBuffer)
+      cols[m_activationBuffer[value]] =
+          std::max(cols[m_activationBuffer[value]], m_valueSizes[value]);
+
+  if (workspace.buffers.size() < cols.size())
+    workspace.buffers.resize(cols.size());
+  workspace.values.reserve(m_nodes.size() + 1);
+  for (const Node &node : m_nodes)
+    if (node.merge != Merge::None)
+      workspace.mergeInputs.reserve(node.inputs.size());
+
+  size_t floats{};
+  for (size_t i{}; i < cols.size(); ++i) {
+    workspace.buffers[i].reserve(maxBatchSize, cols[i]);
+    floats += maxBatchSize * cols[i];
+  }
+  return floats * sizeof(float);
+}
+
+void GraphModel::forward(const Math::MatrixBase<float> &batchData,
+                         bool training) {
+  m_values[0] = batchData.view();
+  for (size_t k{}; k < m_nodes.size(); ++k) {
+    const Node &node{m_nodes[k]};
+    if (node.merge != Merge::None) {
+      m_mergeInputs.clear();
+      for (size_t input : node.inputs)
+        m_mergeInputs.push_back(m_values[input]);
+      merge(node, m_mergeInputs, m_mergeOutputs[k]);
+      m_values[k + 1] = m_mergeOutputs[k].view();
+      continue;
+    }
+
+    // If not training, skip dropout layers
+    if (!training && isDropout(node)) {
+      m_values[k + 1] = m_values[node.inputs.front()];
+      continue;
+    }
+
+    auto &layer{*m_layers[node.layer]};
+    layer.setTraining(training);
+    m_values[k + 1] = layer.forward(m_values[node.inputs.front()]).view();
+  }
+}
+
+void GraphModel::optimize(const Math::MatrixBase<float> &outputGradients) {
+  std::ranges::fill(m_contributions, 0);
+  m_dvalues.back() = outputGradients.view();
+  // k-- in condition because k is size_t, thus will wrap to max if negative
+  for (size_t k{m_nodes.size()}; k-- > 0;) {
+    const Node &node{m_nodes[k]};
+    const auto dvalues{m_dvalues[k + 1]};
+    switch (node.merge) {
+    case Merge::None: {
+      auto &layer{*m_layers[node.layer]};
+      accumulate(node.inputs.front(), layer.backward(dvalues));
+      break;
+    }
+    case Merge::Add:
+      for (size_t input : node.inputs)
+        accumulate(input, dvalues);
+      break;
+    case Merge::Concat: {
+      size_t colOffset{};
+      for (size_t input : node.inputs) {
+        accumulate(input, dvalues, colOffset);
+        colOffset += m_values[input].cols();
+      }
+      break;
+    }
+    }
+  }
+
+  updateParameters();
+}
+
+size_t GraphModel::planMemory(size_t maxBatchSize) {
+  if (!m_isModelLoaded)
+    throw ANN::Exception{CURRENT_FUNCTION,
+                         "Can't plan memory while model isn't loaded"};
+
+  size_t floats{};
+  for (size_t k{}; k < m_nodes.size(); ++k) {
+    const Node &node{m_nodes[k]};
+    if (node.merge != Merge::None) {
+      m_mergeOutputs[k].reserve(maxBatchSize, m_valueSizes[k + 1]);
+      floats += maxBatchSize * m_valueSizes[k + 1];
+    }
+  }
+
+  // Every pooled buffer holds gradients of a single per-sample size
+  std::vector<bool> isReserved(m_gradients.size());
+  for (size_t value{}; value < m_valueSizes.size(); ++value) {
+    const size_t buffer{m_gradientBuffer[value]};
+    if (buffer == noBuffer || isReserved[buffer])
+      continue;
+    m_gradients[buffer].reserve(maxBatchSize, m_valueSizes[value]);
+    floats += maxBatchSize * m_valueSizes[value];
+    isReserved[buffer] = true;
+  }
+
+  size_t bytes{floats * sizeof(float)};
+  for (const Node &node : m_nodes)
+    if (node.merge == Merge::None)
+      bytes += m_layers[node.layer]->reserve(
+          maxBatchSize, Math::Shape{m_valueSizes[node.inputs.front()]});
+
+  return bytes + std::visit(
+                     [this, maxBatchSize](Loss::Loss &loss) {
+                       return loss.reserve(maxBatchSize, m_valueSizes.back());
+                     },
+                     m_loss);
+}
+
+Math::MatrixView<float> GraphModel::outputs() const { return m_values.back(); }
+
+void GraphModel::planBuffers() {
+  const size_t valueNum{m_nodes.size() + 1};
+
+  std::vector<size_t> readers(valueNum);
+  for (const auto &node : m_nodes)
+    for (size_t input : node.inputs)
+      ++readers[input];
+
+  // Activations (predict). Dropout nodes pass their inputs through, so their
+  // readers keep the passed value alive.
+  m_inferenceValue.assign(valueNum, 0);
+  std::vector<size_t> lastRead(valueNum);
+  for (size_t k{}; k < m_nodes.size(); ++k) {
+    m_inferenceValue[k + 1] = isDropout(m_nodes[k])
+                                  ? m_inferenceValue[m_nodes[k].inputs.front()]
+                                  : k + 1;
+    for (size_t input : m_nodes[k].inputs)
+      lastRead[m_inferenceValue[input]] = k;
+  }
+  // The model outputs are never released
+  lastRead[m_inferenceValue.back()] = m_nodes.size();
+
+  // Any released buffer can be taken, so at most the largest live set of
+  // buffers exists at once
+  m_activationBuffer.assign(valueNum, noBuffer);
+  m_activationBuffers = 0;
+  std::vector<size_t> released{};
+  for (size_t k{}; k < m_nodes.size(); ++k) {
+    if (isDropout(m_nodes[k]))
+      continue;
+
+    if (released.empty()) {
+      m_activationBuffer[k + 1] = m_activationBuffers++;
+    } else {
+      m_activationBuffer[k + 1] = released.back();
+      released.pop_back();
+    }
+
+    // Release inputs read for the last time (after taking the output buffer,
+    // as they're read while it's written)
+    for (size_t input : m_nodes[k].inputs) {
+      const size_t value{m_inferenceValue[input]};
+      if (value != 0 && lastRead[value] == k) {
+        released.push_back(m_activationBuffer[value]);
+        // Inputs may repeat, release once
+        lastRead[value] = m_nodes.size();
+      }
+    }
+  }
+
+  // Gradients (backward pass, in reverse schedule). A value's gradients live
+  // from its last reader's backward pass until its own node's. Gradients read
+  // by a single layer are its input gradients, which stay valid until the
+  // layer's next backward pass, so they're passed as views. Add merges pass
+  // their gradients through to inputs read once, as long as those are stable
+  // too. Everything else is accumulated into a buffer.
+  std::vector<bool> isView(valueNum);
+  // The loss gradients stay valid through the backward pass as well
+  isView.back() = true;
+  m_gradientBuffer.assign(valueNum, noBuffer);
+  // Released buffers are only taken for values of the same per-sample size,
+  // so buffers aren't reallocated between batches
+  std::vector<size_t> gradientSizes{};
+  released.clear();
+  for (size_t k{m_nodes.size()}; k-- > 0;) {
+    const Node &node{m_nodes[k]};
+    for (size_t input : node.inputs) {
+      if (input == 0 || isView[input] ||
+          m_gradientBuffer[input] != noBuffer)
+        continue;
+
+      if (readers[input] == 1 &&
+          (node.merge == Merge::None ||
+           (node.merge == Merge::Add && isView[k + 1]))) {
+        isView[input] = true;
+        continue;
+      }
+
+      auto it{std::ranges::find_if(released, [&](size_t buffer) {
+        return gradientSizes[buffer] == m_valueSizes[input];
+      })};
+      if (it == released.end()) {
+        m_gradientBuffer[input] = gradientSizes.size();
+        gradientSizes.push_back(m_valueSizes[input]);
+      } else {
+        m_gradientBuffer[input] = *it;
+        released.erase(it);
+      }
+    }
+
+    if (m_gradientBuffer[k + 1] != noBuffer)
+      released.push_back(m_gradientBuffer[k + 1]);
+  }
+  m_gradients.resize(gradientSizes.size());
+
+  m_contributions.assign(valueNum, 0);
+  m_mergeOutputs.resize(m_nodes.size());
+  m_values.assign(valueNum, {});
+  m_dvalues.assign(valueNum, {});
+}
+
+bool GraphModel::isDropout(const Node &node) const {
+  return node.merge == Merge::None &&
+         m_layers[node.layer]->type() == Layer::Type::Dropout;
+}
+
+void GraphModel::merge(const Node &node,
+                       const std::vector<Math::MatrixView<float>> &inputs,
+                       Math::Matrix<float> &output) {
+  const size_t rows{inputs.front().rows()};
+  size_t cols{inputs.front().cols()};
+  if (node.merge == Merge::Concat) {
+    cols = 0;
+    for (const auto &input : inputs)
+      cols += input.cols();
+  }
+
+  if (output.rows() != rows || output.cols() != cols)
+    output.resize(rows, cols);
+  if (rows == 0 || cols == 0)
+    return;
+
+  float *out{&output[0, 0]};
+  if (node.merge == Merge::Add) {
+    const size_t size{rows * cols};
+    std::copy_n(&inputs.front()[0, 0], size, out);
+    for (size_t i{1}; i < inputs.size(); ++i) {
+      const float *in{&inputs[i][0, 0]};
+      for (size_t j{}; j < size; ++j)
+        out[j] += in[j];
+    }
+    return;
+  }
+
+  size_t colOffset{};
+  for (const auto &input : inputs) {
+    const size_t inputCols{input.cols()};
+    if (inputCols != 0) {
+      const float *in{&input[0, 0]};
+      for (size_t i{}; i < rows; ++i)
+        std::copy_n(in + i * inputCols, inputCols,
+                    out + i * cols + colOffset);
+    }
+    colOffset += inputCols;
+  }
+}
+
+void GraphModel::accumulate(size_t value,
+                            const Math::MatrixBase<float> &dvalues,
+                            size_t colOffset) {
+  // Gradients of the model inputs aren't needed
+  if (value == 0)
+    return;
+
+  const size_t buffer{m_gradientBuffer[value]};
+  if (buffer == noBuffer) {
+    m_dvalues[value] = dvalues.view();
+    return;
+  }
+
+  auto &gradients{m_gradients[buffer]};
+  const size_t rows{m_values[value].rows()};
+  const size_t cols{m_values[value].cols()};
+  const size_t stride{dvalues.cols()};
+  const bool isFirst{m_contributions[value]++ == 0};
+
+  if (gradients.rows() != rows || gradients.cols() != cols)
+    gradients.resize(rows, cols);
+  m_dvalues[value] = gradients.view();
+  if (rows == 0 || cols == 0)
+    return;
+
+  float *out{&gradients[0, 0]};
+  const float *in{&dvalues[0, 0] + colOffset};
+  for (size_t i{}; i < rows; ++i) {
+    if (isFirst)
+      std::copy_n(in + i * stride, cols, out + i * cols);
+    else
+      for (size_t j{}; j < cols; ++j)
+        out[i * cols + j] += in[i * stride + j];
+  }
+}
+} // namespace ANN
@@ -0,0 +1,61 @@
+#include "ann/layer.h"
+
+#include <algorithm>
+
+namespace ANN {
+// Returns batch dimension followed by the per-sample shape
+static Math::Shape batchShape(size_t batches, const Math::Shape &shape) {
+  Math::Shape result(shape.size() + 1);
+  result[0] = batches;
+  std::copy(shape.begin(), shape.end(), result.begin() + 1);
+  return result;
+}
+
+Math::TensorView<float> Layer::forward(const Math::TensorView<float> &inputs) {
+  Math::Shape sampleShape{inputs.shape().begin() + 1, inputs.shape().end()};
+  Math::Shape outputSampleShape{outputShape(sampleShape)};
+
+  const Math::Matrix<float> &output{forward(inputs.matrix())};
+  m_tensorInputShape = std::move(sampleShape);
+
+  return {output, batchShape(inputs.shape(0), outputSampleShape)};
+}
+
+void Layer::predict(const Math::MatrixBase<float> &inputs,
+                    Math::Matrix<float> &output) const {
+  output = predict(inputs);
+}
+
+Math::Tensor<float>
+Layer::predict(const Math::TensorView<float> &inputs) const {
+  const Math::Shape sampleShape{inputs.shape().begin() + 1,
+                                inputs.shape().end()};
+  Math::Shape shape{batchShape(inputs.shape(0), outputShape(sampleShape))};
+
+  // Layouts which can't be viewed as a matrix are copied first
+  Math::Matrix<float> output{
+      inputs.isContiguous() ? predict(inputs.matrix())
+                            : predict(inputs.contiguous().matrix())};
+
+  Math::Tensor<float> result{std::move(output)};
+  result.reshape(std::move(shape));
+
+  return result;
+}
+
+Math::TensorView<float>
+Layer::backward(const Math::TensorView<float> &dvalues) {
+  const Math::Matrix<float> &dinputs{backward(dvalues.matrix())};
+
+  return {dinputs, batchShape(dvalues.shape(0), m_tensorInputShape)};
+}
+
+size_t
+Layer::reserveBuffers(std::initializer_list<Math::Matrix<float> *> buffers,
+                      size_t rows, size_t cols) {
+  for (Math::Matrix<float> *buffer : buffers)
+    buffer->reserve(rows, cols);
+
+  return buffers.size() * rows * cols * sizeof(float);
+}
+} // namespace ANN
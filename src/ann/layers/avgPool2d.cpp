@@ -0,0 +1,174 @@
+#include "ann/layers/avgPool2d.h"
+
+#include "ann/exception.h"
+
+#include "math/convolution.h"
+#include "utils/exceptions.h"
+#include "utils/parallel.h"
+
+#include <algorithm>
+
+namespace ANN {
+namespace Layers {
+AvgPool2D::AvgPool2D(unsigned int inputHeight, unsigned int inputWidth,
+                     unsigned int channels, unsigned int poolSize,
+                     unsigned int stride)
+    : m_inputHeight{inputHeight}, m_inputWidth{inputWidth},
+      m_channels{channels}, m_poolSize{poolSize},
+      m_stride{(stride == 0) ? poolSize : stride} {
+  if (inputHeight == 0 || inputWidth == 0 || channels == 0)
+    throw ANN::Exception{CURRENT_FUNCTION,
+                         "AvgPool2D dimensions must be positive"};
+
+  // Throws if pool doesn't fit
+  m_outputHeight = static_cast<unsigned int>(
+      Math::convOutputSize(inputHeight, poolSize, m_stride, 0));
+  m_outputWidth = static_cast<unsigned int>(
+      Math::convOutputSize(inputWidth, poolSize, m_stride, 0));
+}
+
+AvgPool2D::AvgPool2D(AvgPool2D &&other) noexcept
+    : m_inputHeight{other.m_inputHeight}, m_inputWidth{other.m_inputWidth},
+      m_channels{other.m_channels}, m_poolSize{other.m_poolSize},
+      m_stride{other.m_stride}, m_outputHeight{other.m_outputHeight},
+      m_outputWidth{other.m_outputWidth}, m_output{std::move(other.m_output)},
+      m_dinputs{std::move(other.m_dinputs)} {}
+
+AvgPool2D &AvgPool2D::operator=(AvgPool2D &&other) noexcept {
+  if (&other != this) {
+    m_inputHeight = other.m_inputHeight;
+    m_inputWidth = other.m_inputWidth;
+    m_channels = other.m_channels;
+    m_poolSize = other.m_poolSize;
+    m_stride = other.m_stride;
+    m_outputHeight = other.m_outputHeight;
+    m_outputWidth = other.m_outputWidth;
+    m_output = std::move(other.m_output);
+    m_dinputs = std::move(other.m_dinputs);
+  }
+  return *this;
+}
+
+const Math::Matrix<float> &
+AvgPool2D::forward(const Math::MatrixBase<float> &inputs) {
+  const size_t outputCols{static_cast<size_t>(m_outputHeight) * m_outputWidth *
+                          m_channels};
+
+  // If m_output's size doesn't match inputs' size, resize all matrices
+  if (m_output.rows() != inputs.rows() || m_output.cols() != outputCols) {
+    m_output.resize(inputs.rows(), outputCols);
+    m_dinputs.resize(inputs.rows(), inputs.cols());
+  }
+
+  pool(inputs, m_output);
+
+  return m_output;
+}
+
+Math::Matrix<float>
+AvgPool2D::predict(const Math::MatrixBase<float> &inputs) const {
+  Math::Matrix<float> output{inputs.rows(), static_cast<size_t>(m_outputHeight) *
+                                                m_outputWidth * m_channels};
+
+  pool(inputs, output);
+
+  return output;
+}
+
+void AvgPool2D::pool(const Math::MatrixBase<float> &inputs,
+                     Math::Matrix<float> &output) const {
+  if (inputs.cols() !=
+      static_cast<size_t>(m_inputHeight) * m_inputWidth * m_channels)
+    throw ANN::Exception{CURRENT_FUNCTION,
+                         "Input's col number doesn't match the layer's input "
+                         "height * width * channels"};
+
+  const size_t channels{m_channels};
+  const float normalization{1.0f /
+                            static_cast<float>(m_poolSize * m_poolSize)};
+
+  auto poolBatch{[this, &inputs, &output, channels,
+                  normalization](size_t batch) {
+    const float *in{&inputs[batch, 0]};
+    float *out{&output[batch, 0]};
+
+    for (size_t outY{}; outY < m_outputHeight; ++outY)
+      for (size_t outX{}; outX < m_outputWidth; ++outX) {
+        float *outPos{out + (outY * m_outputWidth + outX) * channels};
+        std::fill(outPos, outPos + channels, 0.0f);
+
+        // Channels are contiguous, so every window position is summed across
+        // all channels in a single vectorizable loop
+        for (size_t ky{}; ky < m_poolSize; ++ky)
+          for (size_t kx{}; kx < m_poolSize; ++kx) {
+            const size_t col{((outY * m_stride + ky) * m_inputWidth +
+                              outX * m_stride + kx) *
+                             channels};
+            for (size_t c{}; c < channels; ++c)
+              outPos[c] += in[col + c];
+          }
+
+        for (size_t c{}; c < channels; ++c)
+          outPos[c] *= normalization;
+      }
+  }};
+
+  const size_t cost{output.cols() * m_poolSize * m_poolSize};
+
+  Utils::Parallel::dynamicParallelFor(cost, inputs.rows(), poolBatch);
+}
+
+const Math::Matrix<float> &
+AvgPool2D::backward(const Math::MatrixBase<float> &dvalues) {
+  std::fill(m_dinputs.data().begin(), m_dinputs.data().end(), 0.0f);
+
+  const size_t channels{m_channels};
+  const float normalization{1.0f /
+                            static_cast<float>(m_poolSize * m_poolSize)};
+
+  // Spread every gradient evenly across its window. Overlapping windows may
+  // share inputs, so each batch is handled serially
+  auto spreadBatch{[this, &dvalues, channels, normalization](size_t batch) {
+    const float *dval{&dvalues[batch, 0]};
+    float *din{&m_dinputs[batch, 0]};
+
+    for (size_t outY{}; outY < m_outputHeight; ++outY)
+      for (size_t outX{}; outX < m_outputWidth; ++outX) {
+        const float *dvalPos{dval + (outY * m_outputWidth + outX) * channels};
+
+        for (size_t ky{}; ky < m_poolSize; ++ky)
+          for (size_t kx{}; kx < m_poolSize; ++kx) {
+            const size_t col{((outY * m_stride + ky) * m_inputWidth +
+                              outX * m_stride + kx) *
+                             channels};
+            for (size_t c{}; c < channels; ++c)
+              din[col + c] += dvalPos[c] * normalization;
+          }
+      }
+  }};
+
+  const size_t cost{dvalues.cols() * m_poolSize * m_poolSize * 2};
+
+  Utils::Parallel::dynamicParallelFor(cost, dvalues.rows(), spreadBatch);
+
+  return m_dinputs;
+}
+
+Math::Shape AvgPool2D::outputShape(const Math::Shape &inputShape) const {
+  if (Math::shapeSize(inputShape) !=
+      static_cast<size_t>(m_inputHeight) * m_inputWidth * m_channels)
+    throw ANN::Exception{CURRENT_FUNCTION,
+                         "Input shape doesn't match the layer's input "
+                         "height * width * channels"};
+  return {m_outputHeight, m_outputWidth, m_channels};
+}
+
+size_t AvgPool2D::reserve(size_t batchSize, const Math::Shape &inputShape) {
+  return reserveBuffers({&m_output}, batchSize,
+                        static_cast<size_t>(m_outputHeight) * m_outputWidth *
+                            m_channels) +
+         reserveBuffers({&m_dinputs}, batchSize,
+                        Math::shapeSize(inputShape));
+}
+} // namespace Layers
+} // namespace ANN
@@ -0,0 +1,299 @@
+#include "ann/layers/batchNorm.h"
+
+#include "ann/exception.h"
+
+#include "math/matrix.h"
+#include "utils/exceptions.h"
+#include "utils/parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace ANN {
+namespace Layers {
+// Features are processed in chunks, so each chunk's statistics are
+// accumulated over contiguous (vectorizable) parts of the rows
+static constexpr size_t featureChunk{64};
+
+BatchNorm::BatchNorm(unsigned int features, float momentum, float epsilon)
+    : m_momentum{momentum}, m_epsilon{epsilon},
+      m_gamma{features, []() { return 1.0f; }}, m_beta{features},
+      m_runningMean{features},
+      m_runningVariance{features, []() { return 1.0f; }},
+      m_inverseStd{features} {
+  if (features == 0)
+    throw ANN::Exception{CURRENT_FUNCTION,
+                         "BatchNorm feature number must be positive"};
+  if (momentum < 0 || momentum > 1)
+    throw ANN::Exception{CURRENT_FUNCTION,
+                         "BatchNorm momentum must be between 0 and 1"};
+  if (epsilon <= 0)
+    throw ANN::Exception{CURRENT_FUNCTION,
+                         "BatchNorm epsilon must be positive"};
+}
+
+BatchNorm::BatchNorm(BatchNorm &&other) noexcept
+    : m_momentum{other.m_momentum}, m_epsilon{other.m_epsilon},
+      m_training{other.m_training}, m_gamma{std::move(other.m_gamma)},
+      m_beta{std::move(other.m_beta)},
+      m_runningMean{std::move(other.m_runningMean)},
+      m_runningVariance{std::move(other.m_runningVariance)},
+      m_normalized{std::move(other.m_normalized)},
+      m_inverseStd{std::move(other.m_inverseStd)},
+      m_output{std::move(other.m_output)},
+      m_dinputs{std::move(other.m_dinputs)},
+      m_dgamma{std::move(other.m_dgamma)}, m_dbeta{std::move(other.m_dbeta)} {}
+
+BatchNorm &BatchNorm::operator=(BatchNorm &&other) noexcept {
+  if (&other != this) {
+    m_momentum = other.m_momentum;
+    m_epsilon = other.m_epsilon;
+    m_training = other.m_training;
+    m_gamma = std::move(other.m_gamma);
+    m_beta = std::move(other.m_beta);
+    m_runningMean = std::move(other.m_runningMean);
+    m_runningVariance = std::move(other.m_runningVariance);
+    m_normalized = std::move(other.m_normalized);
+    m_inverseStd = std::move(other.m_inverseStd);
+    m_output = std::move(other.m_output);
+    m_dinputs = std::move(other.m_dinputs);
+    m_dgamma = std::move(other.m_dgamma);
+    m_dbeta = std::move(other.m_dbeta);
+  }
+  return *this;
+}
+
+const Math::Matrix<float> &
+BatchNorm::forward(const Math::MatrixBase<float> &inputs) {
+  if (inputs.cols() != m_gamma.size())
+    throw ANN::Exception{CURRENT_FUNCTION,
+                         "Input's col number doesn't match the layer's "
+                         "feature number"};
+
+  // If m_output's size doesn't match inputs' size, resize all matrices
+  if (m_output.rows() != inputs.rows() || m_output.cols() != inputs.cols()) {
+    m_output.resize(inputs.rows(), inputs.cols());
+    m_normalized.resize(inputs.rows(), inputs.cols());
+    m_dinputs.resize(inputs.rows(), inputs.cols());
+  }
+
+  if (!m_training) {
+    const auto [scale, shift]{inferenceAffine()};
+    applyAffine(inputs, scale, shift, m_output);
+    return m_output;
+  }
+
+  const size_t batches{inputs.rows()};
+  const size_t features{inputs.cols()};
+  const float batchNum{static_cast<float>(batches)};
+  // Running variance is updated with the unbiased estimate
+  const float varianceCorrection{
+      batches > 1 ? batchNum / static_cast<float>(batches - 1) : 1.0f};
+
+  auto normalizeChunk{[this, &inputs, batches, features, batchNum,
+                       varianceCorrection](size_t chunk) {
+    const size_t start{chunk * featureChunk};
+    const size_t end{std::min(start + featureChunk, features)};
+
+    float mean[featureChunk]{};
+    float variance[featureChunk]{};
+
+    for (size_t i{}; i < batches; ++i) {
+      const float *in{&inputs[i, start]};
+      for (size_t j{}; j < end - start; ++j)
+        mean[j] += in[j];
+    }
+    for (size_t j{}; j < end - start; ++j)
+      mean[j] /= batchNum;
+
+    for (size_t i{}; i < batches; ++i) {
+      const float *in{&inputs[i, start]};
+      for (size_t j{}; j < end - start; ++j)
+        variance[j] += (in[j] - mean[j]) * (in[j] - mean[j]);
+    }
+    for (size_t j{}; j < end - start; ++j) {
+      variance[j] /= batchNum;
+      m_inverseStd[start + j] = 1.0f / std::sqrt(variance[j] + m_epsilon);
+
+      m_runningMean[start + j] = m_momentum * m_runningMean[start + j] +
+                                 (1 - m_momentum) * mean[j];
+      m_runningVariance[start + j] =
+          m_momentum * m_runningVariance[start + j] +
+          (1 - m_momentum) * variance[j] * varianceCorrection;
+    }
+
+    const float *inverseStd{&m_inverseStd[start]};
+    const float *gamma{&m_gamma[start]};
+    const float *beta{&m_beta[start]};
+    for (size_t i{}; i < batches; ++i) {
+      const float *in{&inputs[i, start]};
+      float *normalized{&m_normalized[i, start]};
+      float *out{&m_output[i, start]};
+      for (size_t j{}; j < end - start; ++j) {
+        normalized[j] = (in[j] - mean[j]) * inverseStd[j];
+        out[j] = normalized[j] * gamma[j] + beta[j];
+      }
+    }
+  }};
+
+  // Three reads and a few operations per chunk value
+  Utils::Parallel::dynamicParallelFor(batches * featureChunk * 8,
+                                      (features + featureChunk - 1) /
+                                          featureChunk,
+                                      normalizeChunk);
+
+  return m_output;
+}
+
+Math::Matrix<float>
+BatchNorm::predict(const Math::MatrixBase<float> &inputs) const {
+  Math::Matrix<float> output{};
+  predict(inputs, output);
+  return output;
+}
+
+void BatchNorm::predict(const Math::MatrixBase<float> &inputs,
+                        Math::Matrix<float> &output) const {
+  if (inputs.cols() != m_gamma.size())
+    throw ANN::Exception{CURRENT_FUNCTION,
+                         "Input's col number doesn't match the layer's "
+                         "feature number"};
+
+  if (output.rows() != inputs.rows() || output.cols() != inputs.cols())
+    output.resize(inputs.rows(), inputs.cols());
+  const auto [scale, shift]{inferenceAffine()};
+  applyAffine(inputs, scale, shift, output);
+}
+
+const Math::Matrix<float> &
+BatchNorm::backward(const Math::MatrixBase<float> &dvalues) {
+  const size_t batches{dvalues.rows()};
+  const size_t features{dvalues.cols()};
+  const float batchNum{static_cast<float>(batches)};
+
+  // Parameter gradients are allocated by the first backward pass
+  if (m_dgamma.size() != features) {
+    m_dgamma.resize(features);
+    m_dbeta.resize(features);
+  }
+
+  auto backwardChunk{[this, &dvalues, batches, features,
+                      batchNum](size_t chunk) {
+    const size_t start{chunk * featureChunk};
+    const size_t end{std::min(start + featureChunk, features)};
+
+    float *dgamma{&m_dgamma[start]};
+    float *dbeta{&m_dbeta[start]};
+    std::fill(dgamma, dgamma + (end - start), 0.0f);
+    std::fill(dbeta, dbeta + (end - start), 0.0f);
+
+    for (size_t i{}; i < batches; ++i) {
+      const float *dval{&dvalues[i, start]};
+      const float *normalized{&m_normalized[i, start]};
+      for (size_t j{}; j < end - start; ++j) {
+        dgamma[j] += dval[j] * normalized[j];
+        dbeta[j] += dval[j];
+      }
+    }
+
+    // dx = gamma * inverseStd / N * (N * dy - dbeta - x_hat * dgamma)
+    float factor[featureChunk]{};
+    for (size_t j{}; j < end - start; ++j)
+      factor[j] = m_gamma[start + j] * m_inverseStd[start + j] / batchNum;
+
+    for (size_t i{}; i < batches; ++i) {
+      const float *dval{&dvalues[i, start]};
+      const float *normalized{&m_normalized[i, start]};
+      float *din{&m_dinputs[i, start]};
+      for (size_t j{}; j < end - start; ++j)
+        din[j] = factor[j] * (batchNum * dval[j] - dbeta[j] -
+                              normalized[j] * dgamma[j]);
+    }
+  }};
+
+  Utils::Parallel::dynamicParallelFor(batches * featureChunk * 8,
+                                      (features + featureChunk - 1) /
+                                          featureChunk,
+                                      backwardChunk);
+
+  return m_dinputs;
+}
+
+void BatchNorm::foldInto(Dense &dense) const {
+  if (dense.weights().cols() != m_gamma.size())
+    throw ANN::Exception{CURRENT_FUNCTION,
+                         "Dense layer's neuron number doesn't match the "
+                         "BatchNorm feature number"};
+
+  const auto [scale, shift]{inferenceAffine()};
+
+  // (x * W + b) * scale + shift = x * (W * scale) + (b * scale + shift)
+  Math::Matrix<float> weights{dense.weights()};
+  Utils::Parallel::dynamicParallelFor(
+      weights.cols(), weights.rows(), [&weights, &scale](size_t i) {
+        for (size_t j{}; j < weights.cols(); ++j)
+          weights[i, j] *= scale[j];
+      });
+
+  Math::Vector<float> biases{dense.biases()};
+  for (size_t j{}; j < biases.size(); ++j)
+    biases[j] = biases[j] * scale[j] + shift[j];
+
+  dense.loadWeights(weights);
+  dense.loadBiases(biases);
+}
+
+std::vector<Parameter> BatchNorm::parameters() {
+  return {{m_gamma.data(), m_dgamma.data()},
+          {m_beta.data(), m_dbeta.data()}};
+}
+
+std::pair<Math::Vector<float>, Math::Vector<float>>
+BatchNorm::inferenceAffine() const {
+  Math::Vector<float> scale{m_gamma.size()};
+  Math::Vector<float> shift{m_gamma.size()};
+  for (size_t j{}; j < m_gamma.size(); ++j) {
+    scale[j] = m_gamma[j] / std::sqrt(m_runningVariance[j] + m_epsilon);
+    shift[j] = m_beta[j] - m_runningMean[j] * scale[j];
+  }
+  return {std::move(scale), std::move(shift)};
+}
+
+void BatchNorm::applyAffine(const Math::MatrixBase<float> &inputs,
+                            const Math::Vector<float> &scale,
+                            const Math::Vector<float> &shift,
+                            Math::Matrix<float> &output) {
+  Utils::Parallel::dynamicParallelFor(
+      inputs.cols() * 2, inputs.rows(),
+      [&inputs, &scale, &shift, &output](size_t i) {
+        const float *in{&inputs[i, 0]};
+        float *out{&output[i, 0]};
+        for (size_t j{}; j < inputs.cols(); ++j)
+          out[j] = in[j] * scale[j] + shift[j];
+      });
+}
+
+void BatchNorm::saveParams(std::ofstream &file) const {
+  for (const auto *params :
+       {&m_gamma, &m_beta, &m_runningMean, &m_runningVariance})
+    for (const float &param : params->data())
+      if (!file.write(reinterpret_cast<const char *>(&param), sizeof(param)))
+        throw ANN::Exception{CURRENT_FUNCTION,
+                             "Error while saving batch norm parameters"};
+}
+
+void BatchNorm::loadParams(std::ifstream &file) {
+  for (auto *params : {&m_gamma, &m_beta, &m_runningMean, &m_runningVariance})
+    for (float &param : params->data())
+      if (!file.read(reinterpret_cast<char *>(&param), sizeof(param)))
+        throw ANN::Exception{CURRENT_FUNCTION,
+                             "Error while reading batch norm parameters"};
+}
+
+size_t BatchNorm::reserve(size_t batchSize, const Math::Shape &inputShape) {
+  return reserveBuffers({&m_normalized, &m_output, &m_dinputs}, batchSize,
+                        Math::shapeSize(inputShape));
+}
+} // namespace Layers
+} // namespace ANN
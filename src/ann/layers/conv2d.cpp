@@ -0,0 +1,218 @@
+#include "ann/layers/conv2d.h"
+
+#include "ann/exception.h"
+
+#include "math/convolution.h"
+#include "math/dot.h"
+#include "math/linear.h"
+#include "math/matrix.h"
+#include "math/random.h"
+#include "utils/exceptions.h"
+#include "utils/parallel.h"
+
+#include <cmath>
+#include <fstream>
+
+namespace ANN {
+namespace Layers {
+Conv2D::Conv2D(unsigned int inputHeight, unsigned int inputWidth,
+               unsigned int inputChannels, unsigned int filters,
+               unsigned int kernelSize, unsigned int stride,
+               unsigned int padding, WeightInit initMethod)
+    : m_inputHeight{inputHeight}, m_inputWidth{inputWidth},
+      m_inputChannels{inputChannels}, m_filters{filters},
+      m_kernelSize{kernelSize}, m_stride{stride}, m_padding{padding},
+      m_biases{filters} {
+  if (inputHeight == 0 || inputWidth == 0 || inputChannels == 0 ||
+      filters == 0)
+    throw ANN::Exception{CURRENT_FUNCTION,
+                         "Conv2D dimensions must be positive"};
+
+  // Throws if kernel doesn't fit
+  m_outputHeight = static_cast<unsigned int>(
+      Math::convOutputSize(inputHeight, kernelSize, stride, padding));
+  m_outputWidth = static_cast<unsigned int>(
+      Math::convOutputSize(inputWidth, kernelSize, stride, padding));
+
+  const unsigned int fanIn{kernelSize * kernelSize * inputChannels};
+  const unsigned int fanOut{kernelSize * kernelSize * filters};
+
+  switch (initMethod) {
+  case WeightInit::Xavier:
+    m_weights = Math::Matrix<float>{
+        fanIn, filters, [fanIn, fanOut]() -> float {
+          return static_cast<float>(std::sqrt(2.0 / (fanIn + fanOut)) *
+                                    Math::Random::getNormal());
+        }};
+    break;
+  case WeightInit::He:
+    m_weights = Math::Matrix<float>{fanIn, filters, [fanIn]() -> float {
+                                      return static_cast<float>(
+                                          std::sqrt(2.0 / fanIn) *
+                                          Math::Random::getNormal());
+                                    }};
+    break;
+  case WeightInit::Random:
+    m_weights = Math::Matrix<float>{fanIn, filters, []() -> float {
+                                      return static_cast<float>(
+                                          0.01 * Math::Random::getNormal());
+                                    }};
+    break;
+  }
+}
+
+Conv2D::Conv2D(Conv2D &&other) noexcept
+    : m_inputHeight{other.m_inputHeight}, m_inputWidth{other.m_inputWidth},
+      m_inputChannels{other.m_inputChannels}, m_filters{other.m_filters},
+      m_kernelSize{other.m_kernelSize}, m_stride{other.m_stride},
+      m_padding{other.m_padding}, m_outputHeight{other.m_outputHeight},
+      m_outputWidth{other.m_outputWidth}, m_cols{std::move(other.m_cols)},
+      m_weights{std::move(other.m_weights)},
+      m_biases{std::move(other.m_biases)}, m_output{std::move(other.m_output)},
+      m_dweights{std::move(other.m_dweights)},
+      m_dcols{std::move(other.m_dcols)}, m_dinputs{std::move(other.m_dinputs)},
+      m_dbiases{std::move(other.m_dbiases)} {}
+
+Conv2D &Conv2D::operator=(Conv2D &&other) noexcept {
+  if (&other != this) {
+    m_inputHeight = other.m_inputHeight;
+    m_inputWidth = other.m_inputWidth;
+    m_inputChannels = other.m_inputChannels;
+    m_filters = other.m_filters;
+    m_kernelSize = other.m_kernelSize;
+    m_stride = other.m_stride;
+    m_padding = other.m_padding;
+    m_outputHeight = other.m_outputHeight;
+    m_outputWidth = other.m_outputWidth;
+    m_cols = std::move(other.m_cols);
+    m_weights = std::move(other.m_weights);
+    m_biases = std::move(other.m_biases);
+    m_output = std::move(other.m_output);
+    m_dweights = std::move(other.m_dweights);
+    m_dcols = std::move(other.m_dcols);
+    m_dinputs = std::move(other.m_dinputs);
+    m_dbiases = std::move(other.m_dbiases);
+  }
+  return *this;
+}
+
+const Math::Matrix<float> &
+Conv2D::forward(const Math::MatrixBase<float> &inputs) {
+  // Store unfolded inputs for later use by backward pass
+  Math::im2col(inputs, m_inputHeight, m_inputWidth, m_inputChannels,
+               m_kernelSize, m_stride, m_padding, m_cols);
+  convolve(m_cols, inputs.rows(), m_output);
+
+  return m_output;
+}
+
+Math::Matrix<float>
+Conv2D::predict(const Math::MatrixBase<float> &inputs) const {
+  Math::Matrix<float> cols{};
+  Math::im2col(inputs, m_inputHeight, m_inputWidth, m_inputChannels,
+               m_kernelSize, m_stride, m_padding, cols);
+  Math::Matrix<float> output{};
+  convolve(cols, inputs.rows(), output);
+
+  return output;
+}
+
+void Conv2D::convolve(const Math::Matrix<float> &cols, size_t batches,
+                      Math::Matrix<float> &output) const {
+  // Undo the previous call's reshape, so the product doesn't resize output
+  if (output.rows() * output.cols() == cols.rows() * m_filters)
+    output.reshape(cols.rows(), m_filters);
+  Math::dot(cols, m_weights, output);
+
+  const size_t filters{m_filters};
+  const float *biases{m_biases.data().data()};
+  Utils::Parallel::dynamicParallelFor(
+      filters, output.rows(), [&output, filters, biases](size_t i) {
+        float *row{&output[i, 0]};
+        for (size_t j{}; j < filters; ++j)
+          row[j] += biases[j];
+      });
+
+  // Each row of the result is a single output position with all its filters,
+  // so a reshape gives (batch_num, output_height * output_width * filters)
+  output.reshape(batches, output.rows() * output.cols() / batches);
+}
+
+const Math::Matrix<float> &
+Conv2D::backward(const Math::MatrixBase<float> &dvalues) {
+  // Match dvalues to the unfolded position-per-row layout
+  auto positionDValues{dvalues.view()};
+  positionDValues.reshape(m_cols.rows(), m_filters);
+
+  // Parameter gradients are allocated by the first backward pass
+  Math::dotTA(m_cols, positionDValues, m_dweights);
+  if (m_dbiases.size() != m_filters)
+    m_dbiases.resize(m_filters);
+
+  // Sum each filter's gradients over all positions of all batches
+  Utils::Parallel::dynamicParallelFor(
+      positionDValues.rows(), m_filters,
+      [&positionDValues, &dbiases = m_dbiases](size_t filter) {
+        float sum{};
+        for (size_t i{}; i < positionDValues.rows(); ++i)
+          sum += positionDValues[i, filter];
+        dbiases[filter] = sum;
+      });
+
+  Math::dotTB(positionDValues, m_weights, m_dcols);
+  Math::col2im(m_dcols, dvalues.rows(), m_inputHeight, m_inputWidth,
+               m_inputChannels, m_kernelSize, m_stride, m_padding, m_dinputs);
+
+  return m_dinputs;
+}
+
+std::vector<Parameter> Conv2D::parameters() {
+  return {{m_weights.data(), m_dweights.data()},
+          {m_biases.data(), m_dbiases.data()}};
+}
+
+Math::Shape Conv2D::outputShape(const Math::Shape &inputShape) const {
+  if (Math::shapeSize(inputShape) !=
+      static_cast<size_t>(m_inputHeight) * m_inputWidth * m_inputChannels)
+    throw ANN::Exception{CURRENT_FUNCTION,
+                         "Input shape doesn't match the layer's input "
+                         "height * width * channels"};
+  return {m_outputHeight, m_outputWidth, m_filters};
+}
+
+void Conv2D::saveParams(std::ofstream &file) const {
+  for (const float &weight : m_weights.data())
+    if (!file.write(reinterpret_cast<const char *>(&weight), sizeof(weight)))
+      throw ANN::Exception{CURRENT_FUNCTION, "Error while saving weights"};
+
+  for (const float &bias : m_biases.data())
+    if (!file.write(reinterpret_cast<const char *>(&bias), sizeof(bias)))
+      throw ANN::Exception{CURRENT_FUNCTION, "Error while saving biases"};
+}
+
+void Conv2D::loadParams(std::ifstream &file) {
+  m_weights.fill(
+      [&file](float *f) {
+        if (!file.read(reinterpret_cast<char *>(f), sizeof(*f)))
+          throw ANN::Exception{CURRENT_FUNCTION, "Error while reading weights"};
+      },
+      false);
+
+  m_biases.fill(
+      [&file](float *f) {
+        if (!file.read(reinterpret_cast<char *>(f), sizeof(*f)))
+          throw ANN::Exception{CURRENT_FUNCTION, "Error while reading biases"};
+      },
+      false);
+}
+
+size_t Conv2D::reserve(size_t batchSize, const Math::Shape &inputShape) {
+  const size_t positions{static_cast<size_t>(m_outputHeight) * m_outputWidth};
+  return reserveBuffers({&m_cols, &m_dcols}, batchSize * positions,
+                        m_weights.rows()) +
+         reserveBuffers({&m_output}, batchSize, positions * m_filters) +
+         reserveBuffers({&m_dinputs}, batchSize,
+                        Math::shapeSize(inputShape));
+}
+} // namespace Layers
+} // namespace ANN
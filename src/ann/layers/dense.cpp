@@ -15,10 +15,7 @@ namespace Layers {
 Dense::Dense(unsigned int inputNum, unsigned int neuronNum,
              WeightInit initMethod, float l1Weight, float l1Bias,
              float l2Weight, float l2Bias)
-    : m_biases{neuronNum}, m_dweights{inputNum, neuronNum},
-      m_dbiases{neuronNum}, m_weightCache{inputNum, neuronNum},
-      m_weightMomentums{inputNum, neuronNum}, m_biasCache{neuronNum},
-      m_biasMomentums{neuronNum}, m_l1Weight{l1Weight}, m_l1Bias{l1Bias},
+    : m_biases{neuronNum}, m_l1Weight{l1Weight}, m_l1Bias{l1Bias},
       m_l2Weight{l2Weight}, m_l2Bias{l2Bias} {
   switch (initMethod) {
   case WeightInit::Xavier:
@@ -42,12 +39,22 @@ Dense::Dense(unsigned int inputNum, unsigned int neuronNum,
                                     }};
     break;
   }
+
+  resetPenalties();
 };
 
 Dense::Dense(Dense &&other)
     : m_input{std::move(other.m_input)}, m_weights{std::move(other.m_weights)},
       m_biases{std::move(other.m_biases)}, m_output{std::move(other.m_output)},
-      m_dweights{std::move(other.m_dweights)} {};
+      m_dweights{std::move(other.m_dweights)},
+      m_dinputs{std::move(other.m_dinputs)},
+      m_dbiases{std::move(other.m_dbiases)}, m_isSampled{other.m_isSampled},
+      m_sampledClasses{other.m_sampledClasses},
+      m_sampledWeights{std::move(other.m_sampledWeights)},
+      m_l1Weight{other.m_l1Weight},
+      m_l1Bias{other.m_l1Bias}, m_l2Weight{other.m_l2Weight},
+      m_l2Bias{other.m_l2Bias}, m_weightsPenalty{other.m_weightsPenalty},
+      m_biasesPenalty{other.m_biasesPenalty} {};
 
 Dense &Dense::operator=(Dense &&other) {
   if (&other != this) {
@@ -56,6 +63,18 @@ Dense &Dense::operator=(Dense &&other) {
     m_weights = std::move(other.m_weights);
     m_biases = std::move(other.m_biases);
     m_output = std::move(other.m_output);
+    m_dweights = std::move(other.m_dweights);
+    m_dinputs = std::move(other.m_dinputs);
+    m_dbiases = std::move(other.m_dbiases);
+    m_isSampled = other.m_isSampled;
+    m_sampledClasses = other.m_sampledClasses;
+    m_sampledWeights = std::move(other.m_sampledWeights);
+    m_l1Weight = other.m_l1Weight;
+    m_l1Bias = other.m_l1Bias;
+    m_l2Weight = other.m_l2Weight;
+    m_l2Bias = other.m_l2Bias;
+    m_weightsPenalty = other.m_weightsPenalty;
+    m_biasesPenalty = other.m_biasesPenalty;
   }
   return *this;
 }
@@ -63,60 +82,112 @@ Dense &Dense::operator=(Dense &&other) {
 const Math::Matrix<float> &
 Dense::forward(const Math::MatrixBase<float> &inputs) {
   m_input = inputs.view(); // Store input for later use by backward pass
-  m_output = predict(inputs);
+  run(inputs, m_output);
 
   return m_output;
 }
 
 Math::Matrix<float>
 Dense::predict(const Math::MatrixBase<float> &inputs) const {
-  return Math::dot(inputs, m_weights, true, true) + m_biases;
+  Math::Matrix<float> output{};
+  run(inputs, output);
+  return output;
+}
+
+void Dense::predict(const Math::MatrixBase<float> &inputs,
+                    Math::Matrix<float> &output) const {
+  run(inputs, output);
+}
+
+void Dense::run(const Math::MatrixBase<float> &inputs,
+                Math::Matrix<float> &output) const {
+  Math::dot(inputs, m_weights, output);
+
+  const size_t neurons{m_biases.size()};
+  const float *biases{m_biases.data().data()};
+  Utils::Parallel::dynamicParallelFor(
+      neurons, output.rows(), [&output, neurons, biases](size_t i) {
+        float *row{&output[i, 0]};
+        for (size_t j{}; j < neurons; ++j)
+          row[j] += biases[j];
+      });
 }
 
 const Math::Matrix<float> &
 Dense::backward(const Math::MatrixBase<float> &dvalues) {
   // Regular backprop
-  m_dweights = Math::dotTA<float>(m_input, dvalues, true, true);
-  m_dinputs = Math::dotTB<float>(dvalues, m_weights, true);
+  // Parameter gradients are allocated by the first backward pass, so models
+  // which are never trained don't hold them
+  Math::dotTA(m_input, dvalues, m_dweights);
+  Math::dotTB(dvalues, m_weights, m_dinputs);
+  m_isSampled = false;
+
+  if (m_dbiases.size() != m_biases.size())
+    m_dbiases.resize(m_biases.size());
+
+  Utils::Parallel::dynamicParallelFor(
+      dvalues.rows(), dvalues.cols(),
+      [&dvalues, &dbiases = m_dbiases](size_t j) {
+        float sum{};
+        for (size_t i{}; i < dvalues.rows(); ++i)
+          sum += dvalues[i, j];
+        dbiases[j] = sum;
+      });
+
+  // Regularization is applied by the optimizer (see parameters())
+
+  return m_dinputs;
+}
+
+void Dense::forwardSampled(const Math::MatrixBase<float> &inputs,
+                           std::span<const size_t> classes,
+                           Math::Matrix<float> &output) {
+  m_input = inputs.view();
+  m_sampledClasses = classes;
+
+  // Every sampled neuron's weights are gathered into a row, so the outputs
+  // are a single product over the sampled neurons only
+  const size_t inputNum{m_weights.rows()};
+  m_sampledWeights.resize(classes.size(), inputNum);
+  Utils::Parallel::dynamicParallelFor(
+      inputNum, classes.size(),
+      [&weights = m_weights, &sampled = m_sampledWeights, classes,
+       inputNum](size_t k) {
+        float *row{&sampled[k, 0]};
+        for (size_t i{}; i < inputNum; ++i)
+          row[i] = weights[i, classes[k]];
+      });
+
+  Math::dotTB(inputs, m_sampledWeights, output);
 
+  const float *biases{m_biases.data().data()};
   Utils::Parallel::dynamicParallelFor(
-      dvalues.cols(), dvalues.rows(),
-      [&dvalues, &dbiases = m_dbiases](size_t i) {
-        for (size_t j{}; j < dvalues.cols(); ++j)
-          dbiases[j] += dvalues[i, j];
+      classes.size(), output.rows(), [&output, classes, biases](size_t i) {
+        float *row{&output[i, 0]};
+        for (size_t k{}; k < classes.size(); ++k)
+          row[k] += biases[classes[k]];
       });
+}
+
+const Math::Matrix<float> &
+Dense::backwardSampled(const Math::MatrixBase<float> &dvalues) {
+  // Gradients of the sampled neurons' weights, one neuron per row (the layout
+  // of column-sparse parameters, see parameters())
+  Math::dotTA(dvalues, m_input, m_dweights);
+  Math::dot(dvalues, m_sampledWeights, m_dinputs);
+  m_isSampled = true;
 
-  // Regularization backprop
-
-  // L1 backprop (absolute value derivative)
-  if (m_l1Weight > 0)
-    Utils::Parallel::dynamicParallelFor(
-        m_weights.cols() * 4, m_weights.rows(),
-        [&weights = m_weights, regularizer = m_l1Weight](size_t i) {
-          for (size_t j{}; j < weights.cols(); ++j)
-            weights[i, j] += regularizer * ((weights[i, j] >= 0) ? 1 : -1);
-        });
-  if (m_l1Bias > 0)
-    Utils::Parallel::dynamicParallelFor(
-        4, m_biases.size(),
-        [&biases = m_biases, regularizer = m_l1Bias](size_t i) {
-          biases[i] += regularizer * ((biases[i] >= 0) ? 1 : -1);
-        });
-
-  // L2 backprop (squared value derivative)
-  if (m_l2Weight > 0)
-    Utils::Parallel::dynamicParallelFor(
-        m_weights.cols() * 5, m_weights.rows(),
-        [&weights = m_weights, regularizer = m_l2Weight](size_t i) {
-          for (size_t j{}; j < weights.cols(); ++j)
-            weights[i, j] += regularizer * 2 * weights[i, j];
-        });
-  if (m_l2Bias > 0)
-    Utils::Parallel::dynamicParallelFor(
-        5, m_biases.size(),
-        [&biases = m_biases, regularizer = m_l2Bias](size_t i) {
-          biases[i] += regularizer * 2 * biases[i];
-        });
+  if (m_dbiases.size() != dvalues.cols())
+    m_dbiases.resize(dvalues.cols());
+
+  Utils::Parallel::dynamicParallelFor(
+      dvalues.rows(), dvalues.cols(),
+      [&dvalues, &dbiases = m_dbiases](size_t k) {
+        float sum{};
+        for (size_t i{}; i < dvalues.rows(); ++i)
+          sum += dvalues[i, k];
+        dbiases[k] = sum;
+      });
 
   return m_dinputs;
 }
@@ -127,6 +198,7 @@ void Dense::loadWeights(Math::Matrix<float> &weights) {
                          "Given weights don't match saved weights' dimensions"};
 
   m_weights = std::move(weights);
+  resetPenalties();
 }
 
 void Dense::loadBiases(Math::Vector<float> &biases) {
@@ -135,6 +207,36 @@ void Dense::loadBiases(Math::Vector<float> &biases) {
                          "Given biases don't match saved biases' size"};
 
   m_biases = std::move(biases);
+  resetPenalties();
+}
+
+std::vector<Parameter> Dense::parameters() {
+  // After a sampled backward pass, only the sampled neurons (columns of the
+  // weights, and single biases) have gradients
+  if (m_isSampled)
+    return {{m_weights.data(), m_dweights.data(), m_sampledClasses,
+             m_weights.rows(), m_l1Weight, m_l2Weight, &m_weightsPenalty,
+             true},
+            {m_biases.data(), m_dbiases.data(), m_sampledClasses, 1, m_l1Bias,
+             m_l2Bias, &m_biasesPenalty}};
+
+  return {{m_weights.data(), m_dweights.data(), {}, 0, m_l1Weight, m_l2Weight,
+           &m_weightsPenalty},
+          {m_biases.data(), m_dbiases.data(), {}, 0, m_l1Bias, m_l2Bias,
+           &m_biasesPenalty}};
+}
+
+void Dense::resetPenalties() {
+  m_weightsPenalty = regularizationLoss(m_weights.data(), m_l1Weight,
+                                        m_l2Weight);
+  m_biasesPenalty = regularizationLoss(m_biases.data(), m_l1Bias, m_l2Bias);
+}
+
+Math::Shape Dense::outputShape(const Math::Shape &inputShape) const {
+  if (Math::shapeSize(inputShape) != m_weights.rows())
+    throw ANN::Exception{CURRENT_FUNCTION,
+                         "Input shape doesn't match the layer's input number"};
+  return {m_weights.cols()};
 }
 
 void Dense::saveParams(std::ofstream &file) const {
@@ -161,6 +263,13 @@ void Dense::loadParams(std::ifstream &file) {
           throw ANN::Exception{CURRENT_FUNCTION, "Error while reading biases"};
       },
       false);
+
+  resetPenalties();
+}
+
+size_t Dense::reserve(size_t batchSize, const Math::Shape &) {
+  return reserveBuffers({&m_output}, batchSize, m_weights.cols()) +
+         reserveBuffers({&m_dinputs}, batchSize, m_weights.rows());
 }
 } // namespace Layers
 } // namespace ANN
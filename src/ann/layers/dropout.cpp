@@ -27,9 +27,9 @@ const Math::Matrix<float> &
 Dropout::forward(const Math::MatrixBase<float> &inputs) {
   // If mask's size doesn't match, resize (via recreation) all the matrices
   if (m_mask.rows() != inputs.rows() || m_mask.cols() != inputs.cols()) {
-    m_mask = Math::Matrix<float>(inputs.rows(), inputs.cols());
-    m_output = Math::Matrix<float>(inputs.rows(), inputs.cols());
-    m_dinputs = Math::Matrix<float>(inputs.rows(), inputs.cols());
+    m_mask.resize(inputs.rows(), inputs.cols());
+    m_output.resize(inputs.rows(), inputs.cols());
+    m_dinputs.resize(inputs.rows(), inputs.cols());
   }
 
   auto dropoutBatch{[&inputs, &output = m_output, &mask = m_mask,
@@ -76,5 +76,10 @@ Dropout::backward(const Math::MatrixBase<float> &dvalues) {
 
   return m_dinputs;
 }
+
+size_t Dropout::reserve(size_t batchSize, const Math::Shape &inputShape) {
+  return reserveBuffers({&m_output, &m_mask, &m_dinputs}, batchSize,
+                        Math::shapeSize(inputShape));
+}
 } // namespace Layers
 } // namespace ANN
@@ -0,0 +1,205 @@
+#include "ann/layers/embedding.h"
+
+#include "ann/exception.h"
+
+#include "math/random.h"
+#include "utils/exceptions.h"
+#include "utils/parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <numeric>
+
+namespace ANN {
+namespace Layers {
+Embedding::Embedding(unsigned int vocabularySize, unsigned int dimensions,
+                     WeightInit initMethod) {
+  if (vocabularySize == 0 || dimensions == 0)
+    throw ANN::Exception{CURRENT_FUNCTION,
+                         "Embedding dimensions must be positive"};
+
+  switch (initMethod) {
+  case WeightInit::Xavier:
+    m_table = Math::Matrix<float>{
+        vocabularySize, dimensions, [vocabularySize, dimensions]() -> float {
+          return static_cast<float>(
+              std::sqrt(2.0 / (vocabularySize + dimensions)) *
+              Math::Random::getNormal());
+        }};
+    break;
+  case WeightInit::He:
+    // Every output has a single (one-hot) input
+    m_table = Math::Matrix<float>{
+        vocabularySize, dimensions, []() -> float {
+          return static_cast<float>(std::sqrt(2.0) * Math::Random::getNormal());
+        }};
+    break;
+  case WeightInit::Random:
+    m_table = Math::Matrix<float>{vocabularySize, dimensions, []() -> float {
+                                    return static_cast<float>(
+                                        0.01 * Math::Random::getNormal());
+                                  }};
+    break;
+  }
+}
+
+Embedding::Embedding(Embedding &&other) noexcept
+    : m_table{std::move(other.m_table)}, m_output{std::move(other.m_output)},
+      m_indices{std::move(other.m_indices)},
+      m_dinputs{std::move(other.m_dinputs)}, m_order{std::move(other.m_order)},
+      m_groupStarts{std::move(other.m_groupStarts)},
+      m_touchedRows{std::move(other.m_touchedRows)},
+      m_dtable{std::move(other.m_dtable)} {}
+
+Embedding &Embedding::operator=(Embedding &&other) noexcept {
+  if (&other != this) {
+    m_table = std::move(other.m_table);
+    m_output = std::move(other.m_output);
+    m_indices = std::move(other.m_indices);
+    m_dinputs = std::move(other.m_dinputs);
+    m_order = std::move(other.m_order);
+    m_groupStarts = std::move(other.m_groupStarts);
+    m_touchedRows = std::move(other.m_touchedRows);
+    m_dtable = std::move(other.m_dtable);
+  }
+  return *this;
+}
+
+const Math::Matrix<float> &
+Embedding::forward(const Math::MatrixBase<float> &inputs) {
+  const size_t outputCols{inputs.cols() * m_table.cols()};
+
+  // If m_output's size doesn't match inputs' size, resize all matrices
+  if (m_output.rows() != inputs.rows() || m_output.cols() != outputCols) {
+    m_output.resize(inputs.rows(), outputCols);
+    m_dinputs.resize(inputs.rows(), inputs.cols());
+  }
+
+  toIndices(inputs, m_indices);
+  lookup(m_indices, m_output);
+
+  return m_output;
+}
+
+Math::Matrix<float>
+Embedding::predict(const Math::MatrixBase<float> &inputs) const {
+  Math::Matrix<float> output{inputs.rows(), inputs.cols() * m_table.cols()};
+  std::vector<size_t> indices{};
+  toIndices(inputs, indices);
+  lookup(indices, output);
+
+  return output;
+}
+
+void Embedding::toIndices(const Math::MatrixBase<float> &inputs,
+                          std::vector<size_t> &indices) const {
+  indices.resize(inputs.rows() * inputs.cols());
+  const float vocabularySize{static_cast<float>(m_table.rows())};
+
+  for (size_t i{}; i < inputs.rows(); ++i)
+    for (size_t j{}; j < inputs.cols(); ++j) {
+      const float index{inputs[i, j]};
+      if (!(index >= 0 && index < vocabularySize) ||
+          index != std::floor(index))
+        throw ANN::Exception{CURRENT_FUNCTION,
+                             "Embedding input " + std::to_string(index) +
+                                 " isn't an index in the vocabulary"};
+      indices[i * inputs.cols() + j] = static_cast<size_t>(index);
+    }
+}
+
+void Embedding::lookup(const std::vector<size_t> &indices,
+                       Math::Matrix<float> &output) const {
+  const size_t dimensions{m_table.cols()};
+  const float *table{m_table.data().data()};
+  float *out{output.data().data()};
+
+  Utils::Parallel::dynamicParallelFor(
+      dimensions, indices.size(), [&indices, dimensions, table, out](size_t i) {
+        std::copy_n(table + indices[i] * dimensions, dimensions,
+                    out + i * dimensions);
+      });
+}
+
+const Math::Matrix<float> &
+Embedding::backward(const Math::MatrixBase<float> &dvalues) {
+  const size_t dimensions{m_table.cols()};
+
+  // Group the batch's positions by table row, so every touched row's gradient
+  // is summed by a single iteration
+  std::vector<size_t> &order{m_order};
+  order.resize(m_indices.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+    return m_indices[a] < m_indices[b];
+  });
+
+  std::vector<size_t> &groupStarts{m_groupStarts};
+  groupStarts.clear();
+  m_touchedRows.clear();
+  for (size_t i{}; i < order.size(); ++i)
+    if (i == 0 || m_indices[order[i]] != m_indices[order[i - 1]]) {
+      groupStarts.push_back(i);
+      m_touchedRows.push_back(m_indices[order[i]]);
+    }
+  groupStarts.push_back(order.size());
+
+  m_dtable.assign(m_touchedRows.size() * dimensions, 0.0f);
+
+  // Position i of the flattened inputs is (i / index_num, i % index_num)
+  const size_t indexNum{dvalues.cols() / dimensions};
+  auto sumGroup{[&](size_t group) {
+    float *dtable{m_dtable.data() + group * dimensions};
+    for (size_t i{groupStarts[group]}; i < groupStarts[group + 1]; ++i) {
+      const size_t position{order[i]};
+      const float *dval{&dvalues[position / indexNum,
+                                 (position % indexNum) * dimensions]};
+      for (size_t d{}; d < dimensions; ++d)
+        dtable[d] += dval[d];
+    }
+  }};
+
+  Utils::Parallel::dynamicParallelFor(
+      dimensions * (order.size() / std::max(m_touchedRows.size(), 1uz)),
+      m_touchedRows.size(), sumGroup);
+
+  return m_dinputs;
+}
+
+std::vector<Parameter> Embedding::parameters() {
+  return {{m_table.data(), m_dtable, m_touchedRows, m_table.cols()}};
+}
+
+Math::Shape Embedding::outputShape(const Math::Shape &inputShape) const {
+  return {Math::shapeSize(inputShape), m_table.cols()};
+}
+
+void Embedding::saveParams(std::ofstream &file) const {
+  for (const float &value : m_table.data())
+    if (!file.write(reinterpret_cast<const char *>(&value), sizeof(value)))
+      throw ANN::Exception{CURRENT_FUNCTION,
+                           "Error while saving embedding table"};
+}
+
+void Embedding::loadParams(std::ifstream &file) {
+  m_table.fill(
+      [&file](float *f) {
+        if (!file.read(reinterpret_cast<char *>(f), sizeof(*f)))
+          throw ANN::Exception{CURRENT_FUNCTION,
+                               "Error while reading embedding table"};
+      },
+      false);
+}
+
+size_t Embedding::reserve(size_t batchSize, const Math::Shape &inputShape) {
+  const size_t indexNum{Math::shapeSize(inputShape)};
+  m_indices.reserve(batchSize * indexNum);
+  m_order.reserve(batchSize * indexNum);
+  m_groupStarts.reserve(batchSize * indexNum + 1);
+  return 3 * batchSize * indexNum * sizeof(size_t) +
+         reserveBuffers({&m_output}, batchSize, indexNum * m_table.cols()) +
+         reserveBuffers({&m_dinputs}, batchSize, indexNum);
+}
+} // namespace Layers
+} // namespace ANN
@@ -0,0 +1,364 @@
+#include "ann/layers/lstm.h"
+
+#include "ann/exception.h"
+
+#include "math/dot.h"
+#include "math/matrix.h"
+#include "math/random.h"
+#include "utils/exceptions.h"
+#include "utils/parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace ANN {
+namespace Layers {
+// Gates computed per unit (input, forget, cell, output)
+static constexpr size_t gateNum{4};
+
+static Math::Matrix<float> initWeights(size_t rows, size_t cols,
+                                       WeightInit initMethod) {
+  // Every gate row has cols inputs and feeds a single unit
+  const double fanIn{static_cast<double>(cols)};
+  const double fanOut{static_cast<double>(rows / gateNum)};
+  switch (initMethod) {
+  case WeightInit::Xavier:
+    return {rows, cols, [fanIn, fanOut]() -> float {
+              return static_cast<float>(std::sqrt(2.0 / (fanIn + fanOut)) *
+                                        Math::Random::getNormal());
+            }};
+  case WeightInit::He:
+    return {rows, cols, [fanIn]() -> float {
+              return static_cast<float>(std::sqrt(2.0 / fanIn) *
+                                        Math::Random::getNormal());
+            }};
+  case WeightInit::Random:
+    break;
+  }
+  return {rows, cols, []() -> float {
+            return static_cast<float>(0.01 * Math::Random::getNormal());
+          }};
+}
+
+static float sigmoid(float x) { return 1.0f / (1.0f + std::exp(-x)); }
+
+LSTM::LSTM(unsigned int inputSize, unsigned int units, bool returnSequences,
+           WeightInit initMethod)
+    : m_inputSize{inputSize}, m_units{units},
+      m_returnSequences{returnSequences}, m_biases{gateNum * units} {
+  if (inputSize == 0 || units == 0)
+    throw ANN::Exception{CURRENT_FUNCTION, "LSTM dimensions must be positive"};
+
+  m_inputWeights = initWeights(gateNum * units, inputSize, initMethod);
+  m_recurrentWeights = initWeights(gateNum * units, units, initMethod);
+
+  // Start by remembering, so gradients flow through the cell state early on
+  for (size_t j{}; j < units; ++j)
+    m_biases[units + j] = 1.0f;
+}
+
+LSTM::LSTM(LSTM &&other) noexcept
+    : m_inputSize{other.m_inputSize}, m_units{other.m_units},
+      m_returnSequences{other.m_returnSequences},
+      m_input{std::move(other.m_input)},
+      m_inputWeights{std::move(other.m_inputWeights)},
+      m_recurrentWeights{std::move(other.m_recurrentWeights)},
+      m_biases{std::move(other.m_biases)}, m_output{std::move(other.m_output)},
+      m_state{std::move(other.m_state)}, m_dgates{std::move(other.m_dgates)},
+      m_stepDGates{std::move(other.m_stepDGates)},
+      m_dhidden{std::move(other.m_dhidden)},
+      m_dcell{std::move(other.m_dcell)},
+      m_recurrentWeightsT{std::move(other.m_recurrentWeightsT)},
+      m_dinputWeights{std::move(other.m_dinputWeights)},
+      m_drecurrentWeights{std::move(other.m_drecurrentWeights)},
+      m_dbiases{std::move(other.m_dbiases)},
+      m_dinputs{std::move(other.m_dinputs)} {}
+
+LSTM &LSTM::operator=(LSTM &&other) noexcept {
+  if (&other != this) {
+    m_inputSize = other.m_inputSize;
+    m_units = other.m_units;
+    m_returnSequences = other.m_returnSequences;
+    m_input = std::move(other.m_input);
+    m_inputWeights = std::move(other.m_inputWeights);
+    m_recurrentWeights = std::move(other.m_recurrentWeights);
+    m_biases = std::move(other.m_biases);
+    m_output = std::move(other.m_output);
+    m_state = std::move(other.m_state);
+    m_dgates = std::move(other.m_dgates);
+    m_stepDGates = std::move(other.m_stepDGates);
+    m_dhidden = std::move(other.m_dhidden);
+    m_dcell = std::move(other.m_dcell);
+    m_recurrentWeightsT = std::move(other.m_recurrentWeightsT);
+    m_dinputWeights = std::move(other.m_dinputWeights);
+    m_drecurrentWeights = std::move(other.m_drecurrentWeights);
+    m_dbiases = std::move(other.m_dbiases);
+    m_dinputs = std::move(other.m_dinputs);
+  }
+  return *this;
+}
+
+const Math::Matrix<float> &
+LSTM::forward(const Math::MatrixBase<float> &inputs) {
+  m_input = inputs.view(); // Store input for later use by backward pass
+  run(inputs, m_state, m_output);
+  return m_output;
+}
+
+Math::Matrix<float> LSTM::predict(const Math::MatrixBase<float> &inputs) const {
+  State state{};
+  Math::Matrix<float> output{};
+  run(inputs, state, output);
+  return output;
+}
+
+size_t LSTM::timesteps(const Math::MatrixBase<float> &inputs) const {
+  if (inputs.cols() == 0 || inputs.cols() % m_inputSize != 0)
+    throw ANN::Exception{CURRENT_FUNCTION,
+                         "Input's col number isn't a multiple of the layer's "
+                         "input size"};
+  return inputs.cols() / m_inputSize;
+}
+
+void LSTM::run(const Math::MatrixBase<float> &inputs, State &state,
+               Math::Matrix<float> &output) const {
+  const size_t batches{inputs.rows()};
+  const size_t steps{timesteps(inputs)};
+  const size_t units{m_units};
+  const size_t gateCols{gateNum * units};
+  const size_t outputCols{m_returnSequences ? steps * units : units};
+
+  if (state.cells.rows() != batches || state.cells.cols() != steps * units) {
+    state.gates.resize(batches * steps, gateCols);
+    state.cells.resize(batches, steps * units);
+    state.prevHiddens.resize(batches, steps * units);
+    state.stepGates.resize(batches, gateCols);
+    state.hidden.resize(batches, units);
+    state.cell.resize(batches, units);
+  } else {
+    std::fill(state.hidden.data().begin(), state.hidden.data().end(), 0.0f);
+    std::fill(state.cell.data().begin(), state.cell.data().end(), 0.0f);
+  }
+  if (output.rows() != batches || output.cols() != outputCols)
+    output.resize(batches, outputCols);
+
+  // Every timestep of every sample as its own row, so the input projections of
+  // the whole sequence are a single GEMM
+  auto stepInputs{inputs.view()};
+  stepInputs.reshape(batches * steps, m_inputSize);
+  Math::dotTB(stepInputs, m_inputWeights, state.projections);
+
+  for (size_t t{}; t < steps; ++t) {
+    // All gates of all units at once
+    Math::dotTB(state.hidden, m_recurrentWeights, state.stepGates);
+
+    const auto updateSample{[&, t](size_t i) {
+      const size_t row{i * steps + t};
+      const float *projection{&state.projections[row, 0]};
+      const float *recurrent{&state.stepGates[i, 0]};
+      const float *bias{&m_biases[0]};
+      float *gates{&state.gates[row, 0]};
+      float *hidden{&state.hidden[i, 0]};
+      float *cell{&state.cell[i, 0]};
+      float *prevHidden{&state.prevHiddens[i, t * units]};
+      float *cells{&state.cells[i, t * units]};
+      float *out{&output[i, m_returnSequences ? t * units : 0]};
+
+      std::copy_n(hidden, units, prevHidden);
+      for (size_t j{}; j < units; ++j) {
+        const float inputGate{sigmoid(projection[j] + recurrent[j] + bias[j])};
+        const float forgetGate{sigmoid(projection[units + j] +
+                                       recurrent[units + j] + bias[units + j])};
+        const float cellGate{std::tanh(projection[2 * units + j] +
+                                       recurrent[2 * units + j] +
+                                       bias[2 * units + j])};
+        const float outputGate{sigmoid(projection[3 * units + j] +
+                                       recurrent[3 * units + j] +
+                                       bias[3 * units + j])};
+        const float c{forgetGate * cell[j] + inputGate * cellGate};
+
+        gates[j] = inputGate;
+        gates[units + j] = forgetGate;
+        gates[2 * units + j] = cellGate;
+        gates[3 * units + j] = outputGate;
+        cell[j] = c;
+        cells[j] = c;
+        hidden[j] = outputGate * std::tanh(c);
+      }
+      if (m_returnSequences || t + 1 == steps)
+        std::copy_n(hidden, units, out);
+    }};
+
+    // Operation cost per iteration (gate activations and cell update per unit)
+    const size_t cost{units * 16};
+
+    Utils::Parallel::dynamicParallelFor(cost, batches, updateSample);
+  }
+}
+
+const Math::Matrix<float> &
+LSTM::backward(const Math::MatrixBase<float> &dvalues) {
+  const size_t batches{m_input.rows()};
+  const size_t steps{m_state.cells.cols() / m_units};
+  const size_t units{m_units};
+  const size_t gateCols{gateNum * units};
+
+  if (dvalues.rows() != m_output.rows() || dvalues.cols() != m_output.cols())
+    throw ANN::Exception{CURRENT_FUNCTION,
+                         "dvalues' dimensions don't match the layer's last "
+                         "outputs"};
+
+  if (m_dgates.rows() != batches * steps || m_dgates.cols() != gateCols) {
+    m_dgates.resize(batches * steps, gateCols);
+    m_stepDGates.resize(batches, gateCols);
+    m_dhidden.resize(batches, units);
+    m_dcell.resize(batches, units);
+  } else {
+    std::fill(m_dhidden.data().begin(), m_dhidden.data().end(), 0.0f);
+    std::fill(m_dcell.data().begin(), m_dcell.data().end(), 0.0f);
+  }
+
+  // Transposed once, so every timestep's hidden gradients are a dotTB
+  m_recurrentWeights.transpose(m_recurrentWeightsT);
+
+  for (size_t t{steps}; t-- > 0;) {
+    const auto backwardSample{[&, t](size_t i) {
+      const size_t row{i * steps + t};
+      const float *gates{&m_state.gates[row, 0]};
+      const float *cells{&m_state.cells[i, t * units]};
+      const float *prevCells{t > 0 ? &m_state.cells[i, (t - 1) * units]
+                                   : nullptr};
+      float *dgates{&m_dgates[row, 0]};
+      float *stepDGates{&m_stepDGates[i, 0]};
+      float *dhidden{&m_dhidden[i, 0]};
+      float *dcell{&m_dcell[i, 0]};
+
+      const bool hasDValues{m_returnSequences || t + 1 == steps};
+      const float *dout{
+          hasDValues ? &dvalues[i, m_returnSequences ? t * units : 0] : nullptr};
+
+      for (size_t j{}; j < units; ++j) {
+        const float inputGate{gates[j]};
+        const float forgetGate{gates[units + j]};
+        const float cellGate{gates[2 * units + j]};
+        const float outputGate{gates[3 * units + j]};
+        const float prevCell{prevCells ? prevCells[j] : 0.0f};
+        const float cellTanh{std::tanh(cells[j])};
+
+        const float dh{dhidden[j] + (hasDValues ? dout[j] : 0.0f)};
+        const float dc{dcell[j] +
+                       dh * outputGate * (1.0f - cellTanh * cellTanh)};
+
+        const float dinput{dc * cellGate * inputGate * (1.0f - inputGate)};
+        const float dforget{dc * prevCell * forgetGate * (1.0f - forgetGate)};
+        const float dcellGate{dc * inputGate * (1.0f - cellGate * cellGate)};
+        const float doutput{dh * cellTanh * outputGate * (1.0f - outputGate)};
+
+        dgates[j] = stepDGates[j] = dinput;
+        dgates[units + j] = stepDGates[units + j] = dforget;
+        dgates[2 * units + j] = stepDGates[2 * units + j] = dcellGate;
+        dgates[3 * units + j] = stepDGates[3 * units + j] = doutput;
+        dcell[j] = dc * forgetGate;
+      }
+    }};
+
+    // Operation cost per iteration (gate derivatives per unit)
+    const size_t cost{units * 24};
+
+    Utils::Parallel::dynamicParallelFor(cost, batches, backwardSample);
+
+    // Gradients flowing into the previous timestep's hidden state
+    Math::dotTB(m_stepDGates, m_recurrentWeightsT, m_dhidden);
+  }
+
+  // Parameter and input gradients of all timesteps, each as a single GEMM
+  auto stepInputs{m_input.view()};
+  stepInputs.reshape(batches * steps, m_inputSize);
+  auto prevHiddens{m_state.prevHiddens.view()};
+  prevHiddens.reshape(batches * steps, units);
+
+  Math::dotTA(m_dgates, stepInputs, m_dinputWeights);
+  Math::dotTA(m_dgates, prevHiddens, m_drecurrentWeights);
+
+  // Parameter gradients are allocated by the first backward pass
+  if (m_dbiases.size() != gateCols)
+    m_dbiases.resize(gateCols);
+  Utils::Parallel::dynamicParallelFor(
+      m_dgates.rows(), gateCols, [this](size_t gate) {
+        float sum{};
+        for (size_t i{}; i < m_dgates.rows(); ++i)
+          sum += m_dgates[i, gate];
+        m_dbiases[gate] = sum;
+      });
+
+  Math::dot(m_dgates, m_inputWeights, m_dinputs);
+  m_dinputs.reshape(batches, steps * m_inputSize);
+
+  return m_dinputs;
+}
+
+std::vector<Parameter> LSTM::parameters() {
+  return {{m_inputWeights.data(), m_dinputWeights.data()},
+          {m_recurrentWeights.data(), m_drecurrentWeights.data()},
+          {m_biases.data(), m_dbiases.data()}};
+}
+
+Math::Shape LSTM::outputShape(const Math::Shape &inputShape) const {
+  const size_t inputs{Math::shapeSize(inputShape)};
+  if (inputs == 0 || inputs % m_inputSize != 0)
+    throw ANN::Exception{CURRENT_FUNCTION,
+                         "Input shape's item count isn't a multiple of the "
+                         "layer's input size"};
+  if (m_returnSequences)
+    return {inputs / m_inputSize, m_units};
+  return {m_units};
+}
+
+void LSTM::saveParams(std::ofstream &file) const {
+  for (const auto *weights : {&m_inputWeights, &m_recurrentWeights})
+    for (const float &weight : weights->data())
+      if (!file.write(reinterpret_cast<const char *>(&weight), sizeof(weight)))
+        throw ANN::Exception{CURRENT_FUNCTION, "Error while saving weights"};
+
+  for (const float &bias : m_biases.data())
+    if (!file.write(reinterpret_cast<const char *>(&bias), sizeof(bias)))
+      throw ANN::Exception{CURRENT_FUNCTION, "Error while saving biases"};
+}
+
+void LSTM::loadParams(std::ifstream &file) {
+  for (auto *weights : {&m_inputWeights, &m_recurrentWeights})
+    weights->fill(
+        [&file](float *f) {
+          if (!file.read(reinterpret_cast<char *>(f), sizeof(*f)))
+            throw ANN::Exception{CURRENT_FUNCTION,
+                                 "Error while reading weights"};
+        },
+        false);
+
+  m_biases.fill(
+      [&file](float *f) {
+        if (!file.read(reinterpret_cast<char *>(f), sizeof(*f)))
+          throw ANN::Exception{CURRENT_FUNCTION, "Error while reading biases"};
+      },
+      false);
+}
+
+size_t LSTM::reserve(size_t batchSize, const Math::Shape &inputShape) {
+  const size_t steps{Math::shapeSize(inputShape) / m_inputSize};
+  const size_t units{m_units};
+  const size_t gateCols{gateNum * units};
+  return reserveBuffers({&m_state.projections, &m_state.gates, &m_dgates},
+                        batchSize * steps, gateCols) +
+         reserveBuffers({&m_state.cells, &m_state.prevHiddens}, batchSize,
+                        steps * units) +
+         reserveBuffers({&m_state.stepGates, &m_stepDGates}, batchSize,
+                        gateCols) +
+         reserveBuffers({&m_state.hidden, &m_state.cell, &m_dhidden, &m_dcell},
+                        batchSize, units) +
+         reserveBuffers({&m_output}, batchSize,
+                        m_returnSequences ? steps * units : units) +
+         reserveBuffers({&m_dinputs}, batchSize * steps, m_inputSize);
+}
+} // namespace Layers
+} // namespace ANN
@@ -0,0 +1,183 @@
+#include "ann/layers/maxPool2d.h"
+
+#include "ann/exception.h"
+
+#include "math/convolution.h"
+#include "utils/exceptions.h"
+#include "utils/parallel.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace ANN {
+namespace Layers {
+MaxPool2D::MaxPool2D(unsigned int inputHeight, unsigned int inputWidth,
+                     unsigned int channels, unsigned int poolSize,
+                     unsigned int stride)
+    : m_inputHeight{inputHeight}, m_inputWidth{inputWidth},
+      m_channels{channels}, m_poolSize{poolSize},
+      m_stride{(stride == 0) ? poolSize : stride} {
+  if (inputHeight == 0 || inputWidth == 0 || channels == 0)
+    throw ANN::Exception{CURRENT_FUNCTION,
+                         "MaxPool2D dimensions must be positive"};
+  // Indices of maximums are stored as 32 bit integers
+  if (static_cast<size_t>(inputHeight) * inputWidth * channels >
+      std::numeric_limits<std::uint32_t>::max())
+    throw ANN::Exception{CURRENT_FUNCTION, "MaxPool2D input is too big"};
+
+  // Throws if pool doesn't fit
+  m_outputHeight = static_cast<unsigned int>(
+      Math::convOutputSize(inputHeight, poolSize, m_stride, 0));
+  m_outputWidth = static_cast<unsigned int>(
+      Math::convOutputSize(inputWidth, poolSize, m_stride, 0));
+}
+
+MaxPool2D::MaxPool2D(MaxPool2D &&other) noexcept
+    : m_inputHeight{other.m_inputHeight}, m_inputWidth{other.m_inputWidth},
+      m_channels{other.m_channels}, m_poolSize{other.m_poolSize},
+      m_stride{other.m_stride}, m_outputHeight{other.m_outputHeight},
+      m_outputWidth{other.m_outputWidth}, m_output{std::move(other.m_output)},
+      m_argmax{std::move(other.m_argmax)},
+      m_dinputs{std::move(other.m_dinputs)} {}
+
+MaxPool2D &MaxPool2D::operator=(MaxPool2D &&other) noexcept {
+  if (&other != this) {
+    m_inputHeight = other.m_inputHeight;
+    m_inputWidth = other.m_inputWidth;
+    m_channels = other.m_channels;
+    m_poolSize = other.m_poolSize;
+    m_stride = other.m_stride;
+    m_outputHeight = other.m_outputHeight;
+    m_outputWidth = other.m_outputWidth;
+    m_output = std::move(other.m_output);
+    m_argmax = std::move(other.m_argmax);
+    m_dinputs = std::move(other.m_dinputs);
+  }
+  return *this;
+}
+
+const Math::Matrix<float> &
+MaxPool2D::forward(const Math::MatrixBase<float> &inputs) {
+  const size_t outputCols{static_cast<size_t>(m_outputHeight) * m_outputWidth *
+                          m_channels};
+
+  // If m_output's size doesn't match inputs' size, resize all matrices
+  if (m_output.rows() != inputs.rows() || m_output.cols() != outputCols) {
+    m_output.resize(inputs.rows(), outputCols);
+    m_dinputs.resize(inputs.rows(), inputs.cols());
+    m_argmax.resize(inputs.rows() * outputCols);
+  }
+
+  pool(inputs, m_output, m_argmax);
+
+  return m_output;
+}
+
+Math::Matrix<float>
+MaxPool2D::predict(const Math::MatrixBase<float> &inputs) const {
+  Math::Matrix<float> output{inputs.rows(), static_cast<size_t>(m_outputHeight) *
+                                                m_outputWidth * m_channels};
+  std::vector<std::uint32_t> argmax(output.rows() * output.cols());
+
+  pool(inputs, output, argmax);
+
+  return output;
+}
+
+void MaxPool2D::pool(const Math::MatrixBase<float> &inputs,
+                     Math::Matrix<float> &output,
+                     std::vector<std::uint32_t> &argmax) const {
+  if (inputs.cols() !=
+      static_cast<size_t>(m_inputHeight) * m_inputWidth * m_channels)
+    throw ANN::Exception{CURRENT_FUNCTION,
+                         "Input's col number doesn't match the layer's input "
+                         "height * width * channels"};
+
+  const size_t channels{m_channels};
+  const size_t outputCols{output.cols()};
+
+  auto poolBatch{[this, &inputs, &output, &argmax, channels,
+                  outputCols](size_t batch) {
+    const float *in{&inputs[batch, 0]};
+    float *out{&output[batch, 0]};
+    std::uint32_t *indices{argmax.data() + batch * outputCols};
+
+    for (size_t outY{}; outY < m_outputHeight; ++outY)
+      for (size_t outX{}; outX < m_outputWidth; ++outX) {
+        float *outPos{out + (outY * m_outputWidth + outX) * channels};
+        std::uint32_t *indexPos{indices +
+                                (outY * m_outputWidth + outX) * channels};
+
+        // Channels are contiguous, so every window position is reduced across
+        // all channels in a single vectorizable loop
+        for (size_t ky{}; ky < m_poolSize; ++ky)
+          for (size_t kx{}; kx < m_poolSize; ++kx) {
+            const size_t col{((outY * m_stride + ky) * m_inputWidth +
+                              outX * m_stride + kx) *
+                             channels};
+            if (ky == 0 && kx == 0) {
+              for (size_t c{}; c < channels; ++c) {
+                outPos[c] = in[col + c];
+                indexPos[c] = static_cast<std::uint32_t>(col + c);
+              }
+              continue;
+            }
+            for (size_t c{}; c < channels; ++c) {
+              const bool isBigger{in[col + c] > outPos[c]};
+              outPos[c] = isBigger ? in[col + c] : outPos[c];
+              indexPos[c] =
+                  isBigger ? static_cast<std::uint32_t>(col + c) : indexPos[c];
+            }
+          }
+      }
+  }};
+
+  // A comparison and two selections per window value
+  const size_t cost{outputCols * m_poolSize * m_poolSize * 3};
+
+  Utils::Parallel::dynamicParallelFor(cost, inputs.rows(), poolBatch);
+}
+
+const Math::Matrix<float> &
+MaxPool2D::backward(const Math::MatrixBase<float> &dvalues) {
+  std::fill(m_dinputs.data().begin(), m_dinputs.data().end(), 0.0f);
+
+  const size_t outputCols{dvalues.cols()};
+
+  // Route every gradient to the input which was chosen as the maximum.
+  // Overlapping windows may share inputs, so each batch is scattered serially
+  auto scatterBatch{[&dvalues, &dinputs = m_dinputs, &argmax = m_argmax,
+                     outputCols](size_t batch) {
+    const float *dval{&dvalues[batch, 0]};
+    float *din{&dinputs[batch, 0]};
+    const std::uint32_t *indices{argmax.data() + batch * outputCols};
+    for (size_t i{}; i < outputCols; ++i)
+      din[indices[i]] += dval[i];
+  }};
+
+  Utils::Parallel::dynamicParallelFor(outputCols * 2, dvalues.rows(),
+                                      scatterBatch);
+
+  return m_dinputs;
+}
+
+Math::Shape MaxPool2D::outputShape(const Math::Shape &inputShape) const {
+  if (Math::shapeSize(inputShape) !=
+      static_cast<size_t>(m_inputHeight) * m_inputWidth * m_channels)
+    throw ANN::Exception{CURRENT_FUNCTION,
+                         "Input shape doesn't match the layer's input "
+                         "height * width * channels"};
+  return {m_outputHeight, m_outputWidth, m_channels};
+}
+
+size_t MaxPool2D::reserve(size_t batchSize, const Math::Shape &inputShape) {
+  const size_t outputCols{static_cast<size_t>(m_outputHeight) * m_outputWidth *
+                          m_channels};
+  m_argmax.reserve(batchSize * outputCols);
+  return batchSize * outputCols * sizeof(std::uint32_t) +
+         reserveBuffers({&m_output}, batchSize, outputCols) +
+         reserveBuffers({&m_dinputs}, batchSize,
+                        Math::shapeSize(inputShape));
+}
+} // namespace Layers
+} // namespace ANN
@@ -0,0 +1,519 @@
+#include "ann/layers/multiHeadAttention.h"
+
+#include "ann/exception.h"
+
+#include "math/dot.h"
+#include "math/matrix.h"
+#include "math/random.h"
+#include "utils/exceptions.h"
+#include "utils/parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+
+namespace ANN {
+namespace Layers {
+// Queries and keys per attention tile. A tile's scores, (tileSize, tileSize),
+// are all that's kept of the score matrix at any time
+static constexpr size_t tileSize{64};
+
+static Math::Matrix<float> initWeights(size_t rows, size_t cols,
+                                       WeightInit initMethod) {
+  const double fanIn{static_cast<double>(cols)};
+  const double fanOut{static_cast<double>(cols)};
+  switch (initMethod) {
+  case WeightInit::Xavier:
+    return {rows, cols, [fanIn, fanOut]() -> float {
+              return static_cast<float>(std::sqrt(2.0 / (fanIn + fanOut)) *
+                                        Math::Random::getNormal());
+            }};
+  case WeightInit::He:
+    return {rows, cols, [fanIn]() -> float {
+              return static_cast<float>(std::sqrt(2.0 / fanIn) *
+                                        Math::Random::getNormal());
+            }};
+  case WeightInit::Random:
+    break;
+  }
+  return {rows, cols, []() -> float {
+            return static_cast<float>(0.01 * Math::Random::getNormal());
+          }};
+}
+
+// Sums every column of the given matrix into sums (resized to the column
+// number if needed)
+static void sumColumns(const Math::MatrixBase<float> &m,
+                       Math::Vector<float> &sums) {
+  if (sums.size() != m.cols())
+    sums.resize(m.cols());
+  Utils::Parallel::dynamicParallelFor(m.rows(), m.cols(),
+                                      [&m, &sums](size_t col) {
+                                        float sum{};
+                                        for (size_t i{}; i < m.rows(); ++i)
+                                          sum += m[i, col];
+                                        sums[col] = sum;
+                                      });
+}
+
+// Reshapes matrix to (rows, cols) if it holds that many items, so in-place
+// products writing into it won't reallocate
+static void reuseAs(Math::Matrix<float> &m, size_t rows, size_t cols) {
+  if (m.rows() * m.cols() == rows * cols)
+    m.reshape(rows, cols);
+}
+
+MultiHeadAttention::MultiHeadAttention(unsigned int features,
+                                       unsigned int heads,
+                                       WeightInit initMethod)
+    : m_features{features}, m_heads{heads}, m_inputBiases{3 * features},
+      m_outputBiases{features} {
+  if (features == 0 || heads == 0)
+    throw ANN::Exception{CURRENT_FUNCTION,
+                         "MultiHeadAttention dimensions must be positive"};
+  if (features % heads != 0)
+    throw ANN::Exception{CURRENT_FUNCTION,
+                         "MultiHeadAttention head number must divide the "
+                         "feature number"};
+
+  m_inputWeights = initWeights(3 * features, features, initMethod);
+  m_outputWeights = initWeights(features, features, initMethod);
+}
+
+MultiHeadAttention::MultiHeadAttention(MultiHeadAttention &&other) noexcept
+    : m_features{other.m_features}, m_heads{other.m_heads},
+      m_input{std::move(other.m_input)},
+      m_inputWeights{std::move(other.m_inputWeights)},
+      m_inputBiases{std::move(other.m_inputBiases)},
+      m_outputWeights{std::move(other.m_outputWeights)},
+      m_outputBiases{std::move(other.m_outputBiases)},
+      m_output{std::move(other.m_output)}, m_state{std::move(other.m_state)},
+      m_dconcatenated{std::move(other.m_dconcatenated)},
+      m_dattention{std::move(other.m_dattention)},
+      m_dqueryHeads{std::move(other.m_dqueryHeads)},
+      m_dkeyHeads{std::move(other.m_dkeyHeads)},
+      m_dvalueHeads{std::move(other.m_dvalueHeads)},
+      m_dprojections{std::move(other.m_dprojections)},
+      m_dinputWeights{std::move(other.m_dinputWeights)},
+      m_dinputBiases{std::move(other.m_dinputBiases)},
+      m_doutputWeights{std::move(other.m_doutputWeights)},
+      m_doutputBiases{std::move(other.m_doutputBiases)},
+      m_dinputs{std::move(other.m_dinputs)} {}
+
+MultiHeadAttention &
+MultiHeadAttention::operator=(MultiHeadAttention &&other) noexcept {
+  if (&other != this) {
+    m_features = other.m_features;
+    m_heads = other.m_heads;
+    m_input = std::move(other.m_input);
+    m_inputWeights = std::move(other.m_inputWeights);
+    m_inputBiases = std::move(other.m_inputBiases);
+    m_outputWeights = std::move(other.m_outputWeights);
+    m_outputBiases = std::move(other.m_outputBiases);
+    m_output = std::move(other.m_output);
+    m_state = std::move(other.m_state);
+    m_dconcatenated = std::move(other.m_dconcatenated);
+    m_dattention = std::move(other.m_dattention);
+    m_dqueryHeads = std::move(other.m_dqueryHeads);
+    m_dkeyHeads = std::move(other.m_dkeyHeads);
+    m_dvalueHeads = std::move(other.m_dvalueHeads);
+    m_dprojections = std::move(other.m_dprojections);
+    m_dinputWeights = std::move(other.m_dinputWeights);
+    m_dinputBiases = std::move(other.m_dinputBiases);
+    m_doutputWeights = std::move(other.m_doutputWeights);
+    m_doutputBiases = std::move(other.m_doutputBiases);
+    m_dinputs = std::move(other.m_dinputs);
+  }
+  return *this;
+}
+
+const Math::Matrix<float> &
+MultiHeadAttention::forward(const Math::MatrixBase<float> &inputs) {
+  m_input = inputs.view(); // Store input for later use by backward pass
+  run(inputs, m_state, m_output);
+  return m_output;
+}
+
+Math::Matrix<float>
+MultiHeadAttention::predict(const Math::MatrixBase<float> &inputs) const {
+  State state{};
+  Math::Matrix<float> output{};
+  run(inputs, state, output);
+  return output;
+}
+
+size_t MultiHeadAttention::timesteps(
+    const Math::MatrixBase<float> &inputs) const {
+  if (inputs.cols() == 0 || inputs.cols() % m_features != 0)
+    throw ANN::Exception{CURRENT_FUNCTION,
+                         "Input's col number isn't a multiple of the layer's "
+                         "feature number"};
+  return inputs.cols() / m_features;
+}
+
+void MultiHeadAttention::run(const Math::MatrixBase<float> &inputs,
+                             State &state, Math::Matrix<float> &output) const {
+  const size_t batches{inputs.rows()};
+  const size_t steps{timesteps(inputs)};
+  const size_t features{m_features};
+  const size_t heads{m_heads};
+  const size_t headSize{features / heads};
+  const size_t headRows{batches * heads * steps};
+  // Folded into the queries, so scores come out of the GEMM already scaled
+  const float scale{1.0f / std::sqrt(static_cast<float>(headSize))};
+
+  if (state.queries.rows() != headRows || state.queries.cols() != headSize) {
+    state.queries.resize(headRows, headSize);
+    state.keys.resize(headRows, headSize);
+    state.values.resize(headRows, headSize);
+    state.attention.resize(headRows, headSize);
+    state.logSums.assign(headRows, 0.0f);
+    state.concatenated.resize(batches * steps, features);
+  }
+
+  // Query, key and value projections of every timestep as a single GEMM
+  auto stepInputs{inputs.view()};
+  stepInputs.reshape(batches * steps, features);
+  Math::dotTB(stepInputs, m_inputWeights, state.projections);
+
+  // Split projections into heads (and add biases)
+  Utils::Parallel::dynamicParallelFor(
+      3 * features, batches * steps, [&](size_t row) {
+        const size_t batch{row / steps};
+        const size_t step{row % steps};
+        const float *projection{&state.projections[row, 0]};
+        for (size_t head{}; head < heads; ++head) {
+          const size_t headRow{(batch * heads + head) * steps + step};
+          const size_t start{head * headSize};
+          float *query{&state.queries[headRow, 0]};
+          float *key{&state.keys[headRow, 0]};
+          float *value{&state.values[headRow, 0]};
+          for (size_t c{}; c < headSize; ++c) {
+            query[c] =
+                (projection[start + c] + m_inputBiases[start + c]) * scale;
+            key[c] = projection[features + start + c] +
+                     m_inputBiases[features + start + c];
+            value[c] = projection[2 * features + start + c] +
+                       m_inputBiases[2 * features + start + c];
+          }
+        }
+      });
+
+  // Attention of a single query tile of a single head, streamed over key tiles
+  const size_t queryTiles{(steps + tileSize - 1) / tileSize};
+  const auto attendTile{[&](size_t item) {
+    const size_t base{item / queryTiles * steps};
+    const size_t queryStart{item % queryTiles * tileSize};
+    const size_t queryEnd{std::min(queryStart + tileSize, steps)};
+    const size_t queryNum{queryEnd - queryStart};
+    const auto queries{
+        state.queries.view(base + queryStart, base + queryEnd)};
+
+    float rowMax[tileSize];
+    float rowSum[tileSize]{};
+    std::fill_n(rowMax, queryNum, -std::numeric_limits<float>::infinity());
+    for (size_t q{}; q < queryNum; ++q)
+      std::fill_n(&state.attention[base + queryStart + q, 0], headSize, 0.0f);
+
+    Math::Matrix<float> scores{};
+    Math::Matrix<float> partial{};
+    for (size_t keyStart{}; keyStart < steps; keyStart += tileSize) {
+      const size_t keyEnd{std::min(keyStart + tileSize, steps)};
+      const size_t keyNum{keyEnd - keyStart};
+      Math::dotTB(queries, state.keys.view(base + keyStart, base + keyEnd),
+                  scores, false);
+
+      // Online softmax: exponentiate against the new running max, and rescale
+      // everything accumulated against the old one
+      for (size_t q{}; q < queryNum; ++q) {
+        float *score{&scores[q, 0]};
+        const float tileMax{*std::max_element(score, score + keyNum)};
+        const float newMax{std::max(rowMax[q], tileMax)};
+        const float correction{std::exp(rowMax[q] - newMax)};
+        float sum{};
+        for (size_t k{}; k < keyNum; ++k) {
+          score[k] = std::exp(score[k] - newMax);
+          sum += score[k];
+        }
+        rowSum[q] = rowSum[q] * correction + sum;
+        rowMax[q] = newMax;
+
+        float *out{&state.attention[base + queryStart + q, 0]};
+        for (size_t c{}; c < headSize; ++c)
+          out[c] *= correction;
+      }
+
+      Math::dot(scores, state.values.view(base + keyStart, base + keyEnd),
+                partial, false);
+      for (size_t q{}; q < queryNum; ++q) {
+        float *out{&state.attention[base + queryStart + q, 0]};
+        const float *add{&partial[q, 0]};
+        for (size_t c{}; c < headSize; ++c)
+          out[c] += add[c];
+      }
+    }
+
+    for (size_t q{}; q < queryNum; ++q) {
+      float *out{&state.attention[base + queryStart + q, 0]};
+      const float inverseSum{1.0f / rowSum[q]};
+      for (size_t c{}; c < headSize; ++c)
+        out[c] *= inverseSum;
+      state.logSums[base + queryStart + q] = rowMax[q] + std::log(rowSum[q]);
+    }
+  }};
+
+  // Operation cost per iteration (scores and weighted values of a tile)
+  const size_t cost{4 * tileSize * steps * headSize};
+
+  Utils::Parallel::dynamicParallelFor(cost, batches * heads * queryTiles,
+                                      attendTile);
+
+  // Concatenate heads back into timesteps
+  Utils::Parallel::dynamicParallelFor(
+      features, batches * steps, [&](size_t row) {
+        const size_t batch{row / steps};
+        const size_t step{row % steps};
+        for (size_t head{}; head < heads; ++head)
+          std::copy_n(
+              &state.attention[(batch * heads + head) * steps + step, 0],
+              headSize, &state.concatenated[row, head * headSize]);
+      });
+
+  reuseAs(output, batches * steps, features);
+  Math::dotTB(state.concatenated, m_outputWeights, output);
+  Utils::Parallel::dynamicParallelFor(features, output.rows(),
+                                      [this, &output](size_t row) {
+                                        float *out{&output[row, 0]};
+                                        for (size_t j{}; j < m_features; ++j)
+                                          out[j] += m_outputBiases[j];
+                                      });
+  output.reshape(batches, steps * features);
+}
+
+const Math::Matrix<float> &
+MultiHeadAttention::backward(const Math::MatrixBase<float> &dvalues) {
+  const size_t batches{m_input.rows()};
+  const size_t features{m_features};
+  const size_t steps{m_input.cols() / features};
+  const size_t heads{m_heads};
+  const size_t headSize{features / heads};
+  const size_t headRows{batches * heads * steps};
+  const float scale{1.0f / std::sqrt(static_cast<float>(headSize))};
+
+  if (dvalues.rows() != m_output.rows() || dvalues.cols() != m_output.cols())
+    throw ANN::Exception{CURRENT_FUNCTION,
+                         "dvalues' dimensions don't match the layer's last "
+                         "outputs"};
+
+  if (m_dattention.rows() != headRows || m_dattention.cols() != headSize) {
+    m_dattention.resize(headRows, headSize);
+    m_dqueryHeads.resize(headRows, headSize);
+    m_dkeyHeads.resize(headRows, headSize);
+    m_dvalueHeads.resize(headRows, headSize);
+    m_dprojections.resize(batches * steps, 3 * features);
+  }
+
+  // Output projection
+  auto stepDValues{dvalues.view()};
+  stepDValues.reshape(batches * steps, features);
+  Math::dotTA(stepDValues, m_state.concatenated, m_doutputWeights);
+  sumColumns(stepDValues, m_doutputBiases);
+  Math::dot(stepDValues, m_outputWeights, m_dconcatenated);
+
+  // Split into heads
+  Utils::Parallel::dynamicParallelFor(
+      features, batches * steps, [&](size_t row) {
+        const size_t batch{row / steps};
+        const size_t step{row % steps};
+        for (size_t head{}; head < heads; ++head)
+          std::copy_n(&m_dconcatenated[row, head * headSize], headSize,
+                      &m_dattention[(batch * heads + head) * steps + step, 0]);
+      });
+
+  // Attention of a single head. Key tiles are the outer loop so their
+  // gradients are accumulated in a tile buffer, while the query gradients are
+  // accumulated in place (every head owns its rows, so no races)
+  const auto attendHead{[&](size_t item) {
+    const size_t base{item * steps};
+
+    // Row sums of dO * O, the softmax gradient's per-query correction
+    std::vector<float> corrections(steps);
+    for (size_t q{}; q < steps; ++q) {
+      const float *dout{&m_dattention[base + q, 0]};
+      const float *out{&m_state.attention[base + q, 0]};
+      float sum{};
+      for (size_t c{}; c < headSize; ++c)
+        sum += dout[c] * out[c];
+      corrections[q] = sum;
+      std::fill_n(&m_dqueryHeads[base + q, 0], headSize, 0.0f);
+    }
+
+    Math::Matrix<float> probabilities{};
+    Math::Matrix<float> dscores{};
+    Math::Matrix<float> partial{};
+    Math::Matrix<float> dkeyTile{};
+    Math::Matrix<float> dvalueTile{};
+    for (size_t keyStart{}; keyStart < steps; keyStart += tileSize) {
+      const size_t keyEnd{std::min(keyStart + tileSize, steps)};
+      const size_t keyNum{keyEnd - keyStart};
+      const auto keys{m_state.keys.view(base + keyStart, base + keyEnd)};
+      const auto values{m_state.values.view(base + keyStart, base + keyEnd)};
+      dkeyTile.resize(keyNum, headSize);
+      dvalueTile.resize(keyNum, headSize);
+
+      for (size_t queryStart{}; queryStart < steps; queryStart += tileSize) {
+        const size_t queryEnd{std::min(queryStart + tileSize, steps)};
+        const size_t queryNum{queryEnd - queryStart};
+        const auto queries{
+            m_state.queries.view(base + queryStart, base + queryEnd)};
+        const auto dattention{
+            m_dattention.view(base + queryStart, base + queryEnd)};
+
+        // Recompute the tile's probabilities from the stored normalizers
+        Math::dotTB(queries, keys, probabilities, false);
+        for (size_t q{}; q < queryNum; ++q) {
+          float *p{&probabilities[q, 0]};
+          const float logSum{m_state.logSums[base + queryStart + q]};
+          for (size_t k{}; k < keyNum; ++k)
+            p[k] = std::exp(p[k] - logSum);
+        }
+
+        Math::dotTA(probabilities, dattention, partial, false);
+        for (size_t i{}; i < dvalueTile.data().size(); ++i)
+          dvalueTile.data()[i] += partial.data()[i];
+
+        Math::dotTB(dattention, values, dscores, false);
+        for (size_t q{}; q < queryNum; ++q) {
+          float *ds{&dscores[q, 0]};
+          const float *p{&probabilities[q, 0]};
+          const float correction{corrections[queryStart + q]};
+          for (size_t k{}; k < keyNum; ++k)
+            ds[k] = p[k] * (ds[k] - correction);
+        }
+
+        Math::dot(dscores, keys, partial, false);
+        for (size_t q{}; q < queryNum; ++q) {
+          float *dq{&m_dqueryHeads[base + queryStart + q, 0]};
+          const float *add{&partial[q, 0]};
+          for (size_t c{}; c < headSize; ++c)
+            dq[c] += add[c];
+        }
+
+        Math::dotTA(dscores, queries, partial, false);
+        for (size_t i{}; i < dkeyTile.data().size(); ++i)
+          dkeyTile.data()[i] += partial.data()[i];
+      }
+
+      std::copy(dkeyTile.data().begin(), dkeyTile.data().end(),
+                &m_dkeyHeads[base + keyStart, 0]);
+      std::copy(dvalueTile.data().begin(), dvalueTile.data().end(),
+                &m_dvalueHeads[base + keyStart, 0]);
+    }
+  }};
+
+  // Operation cost per iteration (4 tile products per (query, key) pair)
+  const size_t cost{8 * steps * steps * headSize};
+
+  Utils::Parallel::dynamicParallelFor(cost, batches * heads, attendHead);
+
+  // Merge heads back into the projection layout (queries were scaled)
+  Utils::Parallel::dynamicParallelFor(
+      3 * features, batches * steps, [&](size_t row) {
+        const size_t batch{row / steps};
+        const size_t step{row % steps};
+        float *dprojection{&m_dprojections[row, 0]};
+        for (size_t head{}; head < heads; ++head) {
+          const size_t headRow{(batch * heads + head) * steps + step};
+          const size_t start{head * headSize};
+          const float *dquery{&m_dqueryHeads[headRow, 0]};
+          const float *dkey{&m_dkeyHeads[headRow, 0]};
+          const float *dvalue{&m_dvalueHeads[headRow, 0]};
+          for (size_t c{}; c < headSize; ++c) {
+            dprojection[start + c] = dquery[c] * scale;
+            dprojection[features + start + c] = dkey[c];
+            dprojection[2 * features + start + c] = dvalue[c];
+          }
+        }
+      });
+
+  // Input projections
+  auto stepInputs{m_input.view()};
+  stepInputs.reshape(batches * steps, features);
+  Math::dotTA(m_dprojections, stepInputs, m_dinputWeights);
+  sumColumns(m_dprojections, m_dinputBiases);
+
+  reuseAs(m_dinputs, batches * steps, features);
+  Math::dot(m_dprojections, m_inputWeights, m_dinputs);
+  m_dinputs.reshape(batches, steps * features);
+
+  return m_dinputs;
+}
+
+std::vector<Parameter> MultiHeadAttention::parameters() {
+  return {{m_inputWeights.data(), m_dinputWeights.data()},
+          {m_inputBiases.data(), m_dinputBiases.data()},
+          {m_outputWeights.data(), m_doutputWeights.data()},
+          {m_outputBiases.data(), m_doutputBiases.data()}};
+}
+
+Math::Shape
+MultiHeadAttention::outputShape(const Math::Shape &inputShape) const {
+  const size_t inputs{Math::shapeSize(inputShape)};
+  if (inputs == 0 || inputs % m_features != 0)
+    throw ANN::Exception{CURRENT_FUNCTION,
+                         "Input shape's item count isn't a multiple of the "
+                         "layer's feature number"};
+  return {inputs / m_features, m_features};
+}
+
+void MultiHeadAttention::saveParams(std::ofstream &file) const {
+  for (const auto *weights : {&m_inputWeights, &m_outputWeights})
+    for (const float &weight : weights->data())
+      if (!file.write(reinterpret_cast<const char *>(&weight), sizeof(weight)))
+        throw ANN::Exception{CURRENT_FUNCTION, "Error while saving weights"};
+
+  for (const auto *biases : {&m_inputBiases, &m_outputBiases})
+    for (const float &bias : biases->data())
+      if (!file.write(reinterpret_cast<const char *>(&bias), sizeof(bias)))
+        throw ANN::Exception{CURRENT_FUNCTION, "Error while saving biases"};
+}
+
+void MultiHeadAttention::loadParams(std::ifstream &file) {
+  for (auto *weights : {&m_inputWeights, &m_outputWeights})
+    weights->fill(
+        [&file](float *f) {
+          if (!file.read(reinterpret_cast<char *>(f), sizeof(*f)))
+            throw ANN::Exception{CURRENT_FUNCTION,
+                                 "Error while reading weights"};
+        },
+        false);
+
+  for (auto *biases : {&m_inputBiases, &m_outputBiases})
+    biases->fill(
+        [&file](float *f) {
+          if (!file.read(reinterpret_cast<char *>(f), sizeof(*f)))
+            throw ANN::Exception{CURRENT_FUNCTION,
+                                 "Error while reading biases"};
+        },
+        false);
+}
+
+size_t MultiHeadAttention::reserve(size_t batchSize,
+                                   const Math::Shape &inputShape) {
+  const size_t steps{Math::shapeSize(inputShape) / m_features};
+  const size_t headRows{batchSize * m_heads * steps};
+  m_state.logSums.reserve(headRows);
+  return headRows * sizeof(float) +
+         reserveBuffers({&m_state.projections, &m_dprojections},
+                        batchSize * steps, 3 * m_features) +
+         reserveBuffers({&m_state.queries, &m_state.keys, &m_state.values,
+                         &m_state.attention, &m_dattention, &m_dqueryHeads,
+                         &m_dkeyHeads, &m_dvalueHeads},
+                        headRows, m_features / m_heads) +
+         reserveBuffers({&m_state.concatenated, &m_dconcatenated, &m_output,
+                         &m_dinputs},
+                        batchSize * steps, m_features);
+}
+} // namespace Layers
+} // namespace ANN
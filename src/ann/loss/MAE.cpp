@@ -30,8 +30,8 @@ MAE::forward(const Math::MatrixBase<float> &predictions,
   // If m_dinput's size doesn't match inputs' size, resize all matrices
   if (m_dinputs.rows() != predictions.rows() ||
       m_dinputs.cols() != predictions.cols()) {
-    m_output = Math::Vector<float>(predictions.rows());
-    m_dinputs = Math::Matrix<float>(predictions.rows(), predictions.cols());
+    m_output.resize(predictions.rows());
+    m_dinputs.resize(predictions.rows(), predictions.cols());
   }
 
   // An estimation of the cost of each iteration in terms of integer addition
@@ -48,8 +48,7 @@ MAE::forward(const Math::MatrixBase<float> &predictions,
         output[batch] = lossSum / static_cast<float>(predictions.cols());
       }};
 
-  Utils::Parallel::dynamicParallelFor(cost, predictions.rows(), calculateBatch);
-
+  forwardSamples(cost, predictions.rows(), calculateBatch);
   return m_output;
 }
 
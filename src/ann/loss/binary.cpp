@@ -15,6 +15,7 @@ Binary &Binary::operator=(Binary &&other) noexcept {
   if (&other != this) {
     m_predictions = std::move(other.m_predictions);
     m_output = std::move(other.m_output);
+    m_hits = std::move(other.m_hits);
     m_correct = std::move(other.m_correct);
     m_dinputs = std::move(other.m_dinputs);
   }
@@ -31,8 +32,9 @@ Binary::forward(const Math::MatrixBase<float> &predictions,
   // If m_dinput's size doesn't match inputs' size, resize all matrices
   if (m_dinputs.rows() != predictions.rows() ||
       m_dinputs.cols() != predictions.cols()) {
-    m_output = Math::Vector<float>{predictions.rows()};
-    m_dinputs = Math::Matrix<float>{predictions.rows(), predictions.cols()};
+    m_output.resize(predictions.rows());
+    m_hits.resize(predictions.rows());
+    m_dinputs.resize(predictions.rows(), predictions.cols());
   }
 
   // An estimation of the cost of each iteration in terms of integer addition
@@ -40,21 +42,24 @@ Binary::forward(const Math::MatrixBase<float> &predictions,
 
   constexpr float epsilon{1e-7f};
 
-  auto calculateBatch{
-      [&predictions, &correct, &output = m_output, epsilon](size_t batch) {
-        float lossSum{};
-        for (size_t i{}; i < predictions.cols(); ++i) {
-          float predictionClamped{
-              std::clamp(predictions[batch, i], epsilon, 1 - epsilon)};
-          // Sum loss for both correct and incorrect options
-          lossSum += -correct[batch, i] * std::log(predictionClamped) -
-                     (1 - correct[batch, i]) * std::log(1 - predictionClamped);
-        }
-        output[batch] = lossSum / static_cast<float>(predictions.cols());
-      }};
-
-  Utils::Parallel::dynamicParallelFor(cost, predictions.rows(), calculateBatch);
+  auto calculateBatch{[&predictions, &correct, &output = m_output,
+                       &hits = m_hits, epsilon](size_t batch) {
+    float lossSum{};
+    float hitSum{};
+    for (size_t i{}; i < predictions.cols(); ++i) {
+      float predictionClamped{
+          std::clamp(predictions[batch, i], epsilon, 1 - epsilon)};
+      // Sum loss for both correct and incorrect options
+      lossSum += -correct[batch, i] * std::log(predictionClamped) -
+                 (1 - correct[batch, i]) * std::log(1 - predictionClamped);
+      if ((predictions[batch, i] >= 0.5) == (correct[batch, i] == 1))
+        ++hitSum;
+    }
+    output[batch] = lossSum / static_cast<float>(predictions.cols());
+    hits[batch] = hitSum;
+  }};
 
+  forwardSamples(cost, predictions.rows(), calculateBatch, predictions.cols());
   return m_output;
 }
 
@@ -84,16 +89,6 @@ const Math::Matrix<float> &Binary::backward() {
   return m_dinputs;
 }
 
-float Binary::accuracy() const {
-  float correctPredictions{};
-  for (size_t batch{}; batch < m_predictions.rows(); ++batch)
-    for (size_t i{}; i < m_predictions.cols(); ++i) {
-      bool prediction{m_predictions[batch, i] >= 0.5};
-      if (prediction == ((m_correct[batch, i] == 1) ? true : false))
-        ++correctPredictions;
-    }
-  return correctPredictions /
-         static_cast<float>(m_predictions.rows() * m_predictions.cols());
-}
+float Binary::accuracy() const { return hitRate(m_predictions.cols()); }
 } // namespace Loss
 } // namespace ANN
@@ -0,0 +1,86 @@
+#include "ann/loss/binarySigmoid.h"
+
+#include "utils/parallel.h"
+
+#include <cmath>
+
+namespace ANN {
+namespace Loss {
+
+BinarySigmoid::BinarySigmoid(BinarySigmoid &&other) noexcept
+    : Loss(std::move(other)), m_labels{other.m_labels} {
+  m_dinputs = std::move(other.m_dinputs);
+}
+
+BinarySigmoid &BinarySigmoid::operator=(BinarySigmoid &&other) noexcept {
+  if (&other != this) {
+    m_output = std::move(other.m_output);
+    m_hits = std::move(other.m_hits);
+    m_dinputs = std::move(other.m_dinputs);
+    m_labels = other.m_labels;
+  }
+  return *this;
+}
+
+const Math::Vector<float> &
+BinarySigmoid::forward(const Math::MatrixBase<float> &inputs,
+                       const Math::MatrixBase<float> &correct) {
+  // If m_dinput's size doesn't match inputs' size, resize all matrices
+  if (m_dinputs.rows() != inputs.rows() || m_dinputs.cols() != inputs.cols()) {
+    m_output.resize(inputs.rows());
+    m_hits.resize(inputs.rows());
+    m_dinputs.resize(inputs.rows(), inputs.cols());
+  }
+  m_labels = inputs.cols();
+
+  // An estimation of the cost of each iteration in terms of integer addition
+  const size_t cost{60 * inputs.cols()};
+
+  // Gradients are averaged over every label of the batch
+  const float normalization{
+      1 / static_cast<float>(inputs.rows() * inputs.cols())};
+
+  auto calculateBatch{[&inputs, &correct, &output = m_output, &hits = m_hits,
+                       &dinputs = m_dinputs, normalization](size_t batch) {
+    const float *in{&inputs[batch, 0]};
+    const float *wanted{&correct[batch, 0]};
+    float *din{&dinputs[batch, 0]};
+
+    float lossSum{};
+    float hitSum{};
+    for (size_t i{}; i < inputs.cols(); ++i) {
+      const float x{in[i]};
+      // exp(-|x|) never overflows, and gives both log-sigmoid and sigmoid
+      const float e{std::exp(-std::abs(x))};
+      // -(y * log(sigmoid(x)) + (1 - y) * log(1 - sigmoid(x)))
+      lossSum += std::fmax(x, 0.0f) - x * wanted[i] + std::log1p(e);
+      const float sigmoid{(x >= 0 ? 1.0f : e) / (1 + e)};
+      din[i] = (sigmoid - wanted[i]) * normalization;
+      // sigmoid(x) >= 0.5 exactly when x >= 0
+      hitSum += static_cast<float>((x >= 0) == (wanted[i] == 1));
+    }
+    output[batch] = lossSum / static_cast<float>(inputs.cols());
+    hits[batch] = hitSum;
+  }};
+
+  forwardSamples(cost, inputs.rows(), calculateBatch, inputs.cols());
+  return m_output;
+}
+
+const Math::Matrix<float> &BinarySigmoid::backward() { return m_dinputs; }
+
+Math::Matrix<float>
+BinarySigmoid::predictSigmoid(const Math::MatrixBase<float> &inputs) const {
+  Math::Matrix<float> output{inputs.rows(), inputs.cols()};
+
+  output.transform(
+      inputs,
+      [](float *out, const float *in) { *out = 1 / (1 + std::exp(-*in)); },
+      std::nullopt, 55);
+
+  return output;
+}
+
+float BinarySigmoid::accuracy() const { return hitRate(m_labels); }
+} // namespace Loss
+} // namespace ANN
@@ -8,13 +8,17 @@ namespace Loss {
 Categorical::Categorical(Categorical &&other) noexcept
     : Loss(std::move(other)) {
   m_predictions = std::move(other.m_predictions);
+  m_labels = std::move(other.m_labels);
 }
 
 Categorical &Categorical::operator=(Categorical &&other) noexcept {
   if (&other != this) {
     // Move other's pointers
     m_predictions = std::move(other.m_predictions);
+    m_labels = std::move(other.m_labels);
     m_output = std::move(other.m_output);
+    m_hits = std::move(other.m_hits);
+    m_dinputs = std::move(other.m_dinputs);
   }
   return *this;
 }
@@ -22,52 +26,86 @@ Categorical &Categorical::operator=(Categorical &&other) noexcept {
 const Math::Vector<float> &
 Categorical::forward(const Math::MatrixBase<float> &predictions,
                      const Math::VectorBase<float> &correct) {
+  return forwardLabels(predictions, [&correct](size_t batch) {
+    return static_cast<size_t>(correct[batch]);
+  });
+}
+
+const Math::Vector<float> &
+Categorical::forward(const Math::MatrixBase<float> &predictions,
+                     const Math::VectorBase<uint16_t> &correct) {
+  return forwardLabels(predictions, [&correct](size_t batch) -> size_t {
+    return correct[batch];
+  });
+}
+
+const Math::Vector<float> &
+Categorical::forward(const Math::MatrixBase<float> &predictions,
+                     const Math::VectorBase<uint32_t> &correct) {
+  return forwardLabels(predictions, [&correct](size_t batch) -> size_t {
+    return correct[batch];
+  });
+}
+
+const Math::Vector<float> &
+Categorical::forward(const Math::MatrixBase<float> &predictions,
+                     const Math::MatrixBase<float> &correct) {
+  // The index of every row is found by the forward kernel itself, so one-hot
+  // rows aren't converted into a vector first
+  return forwardLabels(predictions, [&correct](size_t batch) {
+    size_t label{};
+    for (size_t j{1}; j < correct.cols(); ++j)
+      if (correct[batch, label] < correct[batch, j])
+        label = j;
+    return label;
+  });
+}
+
+template <typename LabelOf>
+const Math::Vector<float> &
+Categorical::forwardLabels(const Math::MatrixBase<float> &predictions,
+                           const LabelOf &labelOf) {
   // Store arguments for later use by backpropagation
   m_predictions = predictions.view();
-  m_correct = correct.view();
 
   // If m_dinput's size doesn't match inputs' size, resize all matrices
   if (m_dinputs.rows() != predictions.rows() ||
       m_dinputs.cols() != predictions.cols()) {
-    m_output = Math::Vector<float>{predictions.rows()};
-    m_dinputs = Math::Matrix<float>{predictions.rows(), predictions.cols()};
+    m_output.resize(predictions.rows());
+    m_hits.resize(predictions.rows());
+    m_dinputs.resize(predictions.rows(), predictions.cols());
+    m_labels.resize(predictions.rows());
   }
 
   // An estimation of the cost of each iteration in terms of integer addition
-  const size_t cost{50};
+  const size_t cost{50 + predictions.cols()};
 
   constexpr float epsilon{1e-7f};
 
-  auto calculateBatch{
-      [&predictions, &correct, &output = m_output, epsilon](size_t batch) {
-        float val{
-            std::clamp(predictions[batch, static_cast<size_t>(correct[batch])],
-                       epsilon, 1 - epsilon)};
-        output[batch] = -std::log(val);
-      }};
-
-  Utils::Parallel::dynamicParallelFor(cost, predictions.rows(), calculateBatch);
-
+  auto calculateBatch{[&predictions, &labelOf, &labels = m_labels,
+                       &output = m_output, &hits = m_hits,
+                       epsilon](size_t batch) {
+    const size_t correctIndex{labelOf(batch)};
+    labels[batch] = static_cast<uint32_t>(correctIndex);
+    float val{
+        std::clamp(predictions[batch, correctIndex], epsilon, 1 - epsilon)};
+    output[batch] = -std::log(val);
+
+    size_t prediction{};
+    for (size_t i{1}; i < predictions.cols(); ++i)
+      if (predictions[batch, i] > predictions[batch, prediction])
+        prediction = i;
+    hits[batch] = prediction == correctIndex ? 1 : 0;
+  }};
+
+  forwardSamples(cost, predictions.rows(), calculateBatch, 1);
   return m_output;
 }
 
-const Math::Vector<float> &
-Categorical::forward(const Math::MatrixBase<float> &predictions,
-                     const Math::MatrixBase<float> &correct) {
-  Math::Vector<float> correctVector{correct.rows()};
-
-  for (size_t i{}; i < correct.rows(); ++i)
-    for (size_t j{}; j < correct.cols(); ++j)
-      if (correct[i, static_cast<size_t>(correctVector[i])] < correct[i, j])
-        correctVector[i] = static_cast<float>(j);
-
-  return forward(predictions, correctVector);
-}
-
 const Math::Matrix<float> &Categorical::backward() {
   for (size_t i{}; i < m_predictions.rows(); ++i)
     for (size_t j{}; j < m_predictions.cols(); ++j) {
-      if (m_correct[i] != static_cast<float>(j))
+      if (m_labels[i] != j)
         m_dinputs[i, j] = 0;
       else
         // Set the corresponding value to the derivative of the loss function
@@ -80,16 +118,12 @@ const Math::Matrix<float> &Categorical::backward() {
   return m_dinputs;
 }
 
-float Categorical::accuracy() const {
-  // Get prediction for each row
-  auto prediction{m_predictions.argmaxRow()};
+float Categorical::accuracy() const { return hitRate(1); }
 
-  float correctPredictions{};
-  for (size_t i{}; i < prediction.size(); ++i)
-    if (static_cast<float>(prediction[i]) == m_correct[i])
-      ++correctPredictions;
+size_t Categorical::reserve(size_t batchSize, size_t outputs) {
+  m_labels.reserve(batchSize);
 
-  return correctPredictions / static_cast<float>(prediction.size());
+  return Loss::reserve(batchSize, outputs) + batchSize * sizeof(uint32_t);
 }
 } // namespace Loss
 } // namespace ANN
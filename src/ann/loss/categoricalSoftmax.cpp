@@ -1,5 +1,6 @@
 #include "ann/loss/categoricalSoftmax.h"
 
+#include "math/softmax.h"
 #include "utils/parallel.h"
 
 #include <cmath>
@@ -8,17 +9,20 @@ namespace ANN {
 namespace Loss {
 
 CategoricalSoftmax::CategoricalSoftmax(CategoricalSoftmax &&other) noexcept
-    : m_input{other.m_input}, m_correct{other.m_correct},
+    : m_input{other.m_input}, m_labels{std::move(other.m_labels)},
       m_softmaxOutput{std::move(other.m_softmaxOutput)},
-      m_dinputs{std::move(other.m_dinputs)} {}
+      m_dinputs{std::move(other.m_dinputs)} {
+  m_hits = std::move(other.m_hits);
+}
 
 CategoricalSoftmax &
 CategoricalSoftmax::operator=(CategoricalSoftmax &&other) noexcept {
   if (this != &other) {
     m_input = std::move(other.m_input);
-    m_correct = std::move(other.m_correct);
+    m_labels = std::move(other.m_labels);
     m_softmaxOutput = std::move(other.m_softmaxOutput);
     m_dinputs = std::move(other.m_dinputs);
+    m_hits = std::move(other.m_hits);
   }
   return *this;
 }
@@ -26,99 +30,87 @@ CategoricalSoftmax::operator=(CategoricalSoftmax &&other) noexcept {
 const Math::Vector<float> &
 CategoricalSoftmax::forward(const Math::MatrixBase<float> &inputs,
                             const Math::VectorBase<float> &correct) {
+  return forwardLabels(inputs, [&correct](size_t batch) {
+    return static_cast<size_t>(correct[batch]);
+  });
+}
+
+const Math::Vector<float> &
+CategoricalSoftmax::forward(const Math::MatrixBase<float> &inputs,
+                            const Math::VectorBase<uint16_t> &correct) {
+  return forwardLabels(inputs, [&correct](size_t batch) -> size_t {
+    return correct[batch];
+  });
+}
+
+const Math::Vector<float> &
+CategoricalSoftmax::forward(const Math::MatrixBase<float> &inputs,
+                            const Math::VectorBase<uint32_t> &correct) {
+  return forwardLabels(inputs, [&correct](size_t batch) -> size_t {
+    return correct[batch];
+  });
+}
+
+const Math::Vector<float> &
+CategoricalSoftmax::forward(const Math::MatrixBase<float> &inputs,
+                            const Math::MatrixBase<float> &correct) {
+  // The index of every row is found by the forward kernel itself, so one-hot
+  // rows aren't converted into a vector first
+  return forwardLabels(inputs, [&correct](size_t batch) {
+    size_t label{};
+    for (size_t j{1}; j < correct.cols(); ++j)
+      if (correct[batch, label] < correct[batch, j])
+        label = j;
+    return label;
+  });
+}
+
+template <typename LabelOf>
+const Math::Vector<float> &
+CategoricalSoftmax::forwardLabels(const Math::MatrixBase<float> &inputs,
+                                  const LabelOf &labelOf) {
   m_input = inputs.view();
-  m_correct = correct.view();
 
   // If m_output's size doesn't match inputs' size, resize all matrices
   if (m_softmaxOutput.rows() != inputs.rows() ||
       m_softmaxOutput.cols() != inputs.cols()) {
-    m_softmaxOutput = Math::Matrix<float>{inputs.rows(), inputs.cols()};
-    m_output = Math::Vector<float>{inputs.rows()};
-    m_dinputs = Math::Matrix<float>{inputs.rows(), inputs.cols()};
+    m_softmaxOutput.resize(inputs.rows(), inputs.cols());
+    m_output.resize(inputs.rows());
+    m_hits.resize(inputs.rows());
+    m_dinputs.resize(inputs.rows(), inputs.cols());
+    m_labels.resize(inputs.rows());
   }
 
   constexpr float epsilon{1e-7f};
 
-  // Chose 70 as a rough summation of operations done in the loop in comparison
+  // Chose 25 as a rough summation of operations done in the loop in comparison
   // to a single addition
-  const size_t cost{inputs.cols() * 70};
+  const size_t cost{inputs.cols() * 25};
 
-  Utils::Parallel::dynamicParallelFor(
+  forwardSamples(
       cost, m_softmaxOutput.rows(),
-      [&inputs, &correct, &softmaxOutput = m_softmaxOutput, &output = m_output,
+      [&inputs, &labelOf, &labels = m_labels,
+       &softmaxOutput = m_softmaxOutput, &output = m_output, &hits = m_hits,
        epsilon](size_t batch) {
-        // max value in batch (for exponentiated values to not explode)
-        float maxValue = inputs[batch, 0];
-        for (size_t i{1}; i < inputs.cols(); ++i)
-          if (inputs[batch, i] > maxValue)
-            maxValue = inputs[batch, i];
-
-        // sum exponentiated inputs
-        float normalBase{};
-        for (size_t i{}; i < inputs.cols(); ++i) {
-          softmaxOutput[batch, i] =
-              std::exp(static_cast<float>(inputs[batch, i] - maxValue));
-          normalBase += softmaxOutput[batch, i];
-        }
-
-        // Normalize values
-        for (size_t i{}; i < inputs.cols(); ++i)
-          softmaxOutput[batch, i] /= normalBase;
+        // The row's argmax is also the prediction
+        const Math::SoftmaxRow<float> row{Math::softmax(
+            &inputs[batch, 0], &softmaxOutput[batch, 0], inputs.cols())};
 
         // Calculate batch loss
-        float val{std::clamp(
-            softmaxOutput[batch, static_cast<size_t>(correct[batch])], epsilon,
-            1 - epsilon)};
+        const size_t correctIndex{labelOf(batch)};
+        labels[batch] = static_cast<uint32_t>(correctIndex);
+        float val{std::clamp(softmaxOutput[batch, correctIndex], epsilon,
+                             1 - epsilon)};
         output[batch] = -std::log(val);
-      });
-
+        hits[batch] = row.argmax == correctIndex ? 1 : 0;
+      },
+      1);
   return m_output;
 }
 
-const Math::Vector<float> &
-CategoricalSoftmax::forward(const Math::MatrixBase<float> &inputs,
-                            const Math::MatrixBase<float> &correct) {
-  Math::Vector<float> correctVector{correct.rows()};
-
-  for (size_t i{}; i < correct.rows(); ++i)
-    for (size_t j{}; j < correct.cols(); ++j)
-      if (correct[i, static_cast<size_t>(correctVector[i])] < correct[i, j])
-        correctVector[i] = static_cast<float>(j);
-
-  return forward(inputs, correctVector);
-}
-
 Math::Matrix<float> CategoricalSoftmax::predictSoftmax(
     const Math::MatrixBase<float> &inputs) const {
-  Math::Matrix<float> output{inputs.rows(), inputs.cols()};
-
-  // An estimation of all the operations in a single iteration
-  size_t cost{55 * inputs.cols()};
-
-  auto calculateBatch{[&inputs, &output](size_t batch) {
-    // max value in batch (for exponentiated values to not explode)
-    float maxValue = inputs[batch, 0];
-    for (size_t i{1}; i < inputs.cols(); ++i)
-      if (inputs[batch, i] > maxValue)
-        maxValue = inputs[batch, i];
-
-    // sum of exponentiated inputs
-    float normalBase{};
-
-    for (size_t i{}; i < inputs.cols(); ++i) {
-      output[batch, i] =
-          std::exp(static_cast<float>(inputs[batch, i] - maxValue));
-      normalBase += output[batch, i];
-    }
-
-    // Normalize values
-    for (size_t i{}; i < inputs.cols(); ++i)
-      output[batch, i] /= normalBase;
-  }};
-
-  Utils::Parallel::dynamicParallelFor(cost, output.rows(), calculateBatch);
-
-  return output;
+  return Math::softmax(inputs);
 }
 
 const Math::Matrix<float> &CategoricalSoftmax::backward() {
@@ -131,9 +123,9 @@ const Math::Matrix<float> &CategoricalSoftmax::backward() {
   // Implement derivative
   Utils::Parallel::dynamicParallelFor(
       cost, batches,
-      [batches, &correct = m_correct, &dinputs = m_dinputs,
+      [batches, &labels = m_labels, &dinputs = m_dinputs,
        &softmaxOutput = m_softmaxOutput](size_t i) {
-        size_t correctIndex{static_cast<size_t>(correct[i])};
+        const size_t correctIndex{labels[i]};
         for (size_t j{}; j < dinputs.cols(); ++j)
           dinputs[i, j] =
               (softmaxOutput[i, j] - ((j == correctIndex) ? 1 : 0)) /
@@ -143,17 +135,7 @@ const Math::Matrix<float> &CategoricalSoftmax::backward() {
   return m_dinputs;
 }
 
-float CategoricalSoftmax::accuracy() const {
-  // Get prediction for each row
-  auto prediction{m_softmaxOutput.argmaxRow()};
-
-  float correctPredictions{};
-  for (size_t i{}; i < prediction.size(); ++i)
-    if (prediction[i] == static_cast<size_t>(m_correct[i]))
-      ++correctPredictions;
-
-  return correctPredictions / static_cast<float>(prediction.size());
-}
+float CategoricalSoftmax::accuracy() const { return hitRate(1); }
 
 float CategoricalSoftmax::mean() const {
   float outputSum{};
@@ -163,5 +145,16 @@ float CategoricalSoftmax::mean() const {
 
   return outputSum / static_cast<float>(m_output.size());
 }
+
+size_t CategoricalSoftmax::reserve(size_t batchSize, size_t outputs) {
+  m_output.reserve(batchSize);
+  m_hits.reserve(batchSize);
+  m_softmaxOutput.reserve(batchSize, outputs);
+  m_dinputs.reserve(batchSize, outputs);
+  m_labels.reserve(batchSize);
+
+  return (2 * batchSize + 2 * batchSize * outputs) * sizeof(float) +
+         batchSize * sizeof(uint32_t);
+}
 } // namespace Loss
 } // namespace ANN
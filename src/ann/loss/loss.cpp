@@ -2,7 +2,9 @@
 
 #include "ann/layers/dense.h"
 
-#include <numeric>
+#include "utils/parallel.h"
+
+#include <algorithm>
 
 namespace ANN {
 namespace Loss {
@@ -15,38 +17,88 @@ float Loss::mean() const {
   return outputSum / static_cast<float>(m_output.size());
 }
 
+size_t Loss::reserve(size_t batchSize, size_t outputs) {
+  m_output.reserve(batchSize);
+  m_dinputs.reserve(batchSize, outputs);
+  if (hasAccuracy())
+    m_hits.reserve(batchSize);
+
+  return (batchSize * (hasAccuracy() ? 2 : 1) + batchSize * outputs) *
+         sizeof(float);
+}
+
+float Loss::runningMean() const {
+  if (m_sampleSum == 0)
+    return 0;
+  return static_cast<float>(m_lossSum / static_cast<double>(m_sampleSum));
+}
+
+float Loss::runningAccuracy() const {
+  if (!hasAccuracy())
+    return -1;
+  if (m_predictionSum == 0)
+    return 0;
+  return static_cast<float>(m_hitSum / static_cast<double>(m_predictionSum));
+}
+
+void Loss::resetMetrics() {
+  m_lossSum = 0;
+  m_hitSum = 0;
+  m_sampleSum = 0;
+  m_predictionSum = 0;
+}
+
+void Loss::mergeMetrics(const Loss &other) {
+  m_lossSum += other.m_lossSum;
+  m_hitSum += other.m_hitSum;
+  m_sampleSum += other.m_sampleSum;
+  m_predictionSum += other.m_predictionSum;
+}
+
+void Loss::forwardSamples(size_t cost, size_t samples,
+                          const std::function<void(size_t)> &kernel,
+                          size_t predictionsPerSample) {
+  // A block per thread, which parallelFor() splits the loop into anyway
+  const size_t blocks{std::min(Utils::Parallel::threadBudget(), samples)};
+  if (m_blockSums.size() != blocks * 2)
+    m_blockSums.resize(blocks * 2);
+  if (blocks == 0)
+    return;
+
+  Utils::Parallel::dynamicParallelFor(
+      cost * ((samples + blocks - 1) / blocks), blocks,
+      [this, &kernel, samples, blocks, predictionsPerSample](size_t block) {
+        float lossSum{};
+        float hitSum{};
+        for (size_t sample{block * samples / blocks};
+             sample < (block + 1) * samples / blocks; ++sample) {
+          kernel(sample);
+          lossSum += m_output[sample];
+          if (predictionsPerSample > 0)
+            hitSum += m_hits[sample];
+        }
+        m_blockSums[block * 2] = lossSum;
+        m_blockSums[block * 2 + 1] = hitSum;
+      });
+
+  for (size_t block{}; block < blocks; ++block) {
+    m_lossSum += m_blockSums[block * 2];
+    m_hitSum += m_blockSums[block * 2 + 1];
+  }
+  m_sampleSum += samples;
+  m_predictionSum += samples * predictionsPerSample;
+}
+
+float Loss::hitRate(size_t predictionsPerSample) const {
+  float hitSum{};
+  for (size_t i{}; i < m_hits.size(); ++i)
+    hitSum += m_hits[i];
+
+  return hitSum / static_cast<float>(m_hits.size() * predictionsPerSample);
+}
+
 float Loss::regularizationLoss(const Layers::Dense &layer) const {
-  float regularization{};
-
-  if (layer.m_l1Weight > 0)
-    regularization +=
-        layer.m_l1Weight *
-        std::accumulate(layer.weights().data().begin(),
-                        layer.weights().data().end(), 0.0f,
-                        [](float acc, float i) { return acc + std::abs(i); });
-
-  if (layer.m_l1Bias > 0)
-    regularization +=
-        layer.m_l1Bias *
-        std::accumulate(layer.biases().data().begin(),
-                        layer.biases().data().end(), 0.0f,
-                        [](float acc, float i) { return acc + std::abs(i); });
-
-  if (layer.m_l2Weight > 0)
-    regularization +=
-        layer.m_l2Weight *
-        std::accumulate(layer.weights().data().begin(),
-                        layer.weights().data().end(), 0.0f,
-                        [](float acc, float i) { return acc + i * i; });
-
-  if (layer.m_l2Bias > 0)
-    regularization +=
-        layer.m_l2Bias *
-        std::accumulate(layer.biases().data().begin(),
-                        layer.biases().data().end(), 0.0f,
-                        [](float acc, float i) { return acc + i * i; });
-
-  return regularization;
+  return layer.m_weightsPenalty + layer.m_biasesPenalty;
 }
 } // namespace Loss
 } // namespace ANN
@@ -0,0 +1,210 @@
+#include "ann/loss/sampledSoftmax.h"
+
+#include "ann/exception.h"
+#include "ann/layers/dense.h"
+
+#include "math/random.h"
+#include "math/softmax.h"
+#include "utils/exceptions.h"
+#include "utils/parallel.h"
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <string>
+
+namespace ANN {
+namespace Loss {
+static constexpr size_t noSlot{std::numeric_limits<size_t>::max()};
+
+SampledSoftmax::SampledSoftmax(size_t samples, bool logUniform)
+    : m_samples{samples}, m_logUniform{logUniform} {
+  if (samples == 0)
+    throw ANN::Exception{CURRENT_FUNCTION,
+                         "Sampled softmax needs at least a single sample"};
+}
+
+const Math::Vector<float> &
+SampledSoftmax::forward(Layers::Dense &layer,
+                        const Math::MatrixBase<float> &inputs,
+                        const Math::VectorBase<float> &correct) {
+  return forwardLabels(layer, inputs, [&correct](size_t batch) {
+    return static_cast<size_t>(correct[batch]);
+  });
+}
+
+const Math::Vector<float> &
+SampledSoftmax::forward(Layers::Dense &layer,
+                        const Math::MatrixBase<float> &inputs,
+                        const Math::VectorBase<uint16_t> &correct) {
+  return forwardLabels(layer, inputs, [&correct](size_t batch) -> size_t {
+    return correct[batch];
+  });
+}
+
+const Math::Vector<float> &
+SampledSoftmax::forward(Layers::Dense &layer,
+                        const Math::MatrixBase<float> &inputs,
+                        const Math::VectorBase<uint32_t> &correct) {
+  return forwardLabels(layer, inputs, [&correct](size_t batch) -> size_t {
+    return correct[batch];
+  });
+}
+
+template <typename LabelOf>
+const Math::Vector<float> &
+SampledSoftmax::forwardLabels(Layers::Dense &layer,
+                              const Math::MatrixBase<float> &inputs,
+                              const LabelOf &labelOf) {
+  const size_t classes{layer.weights().cols()};
+  if (m_samples >= classes)
+    throw ANN::Exception{CURRENT_FUNCTION,
+                         "Can't sample " + std::to_string(m_samples) +
+                             " classes out of " + std::to_string(classes)};
+
+  if (m_slots.size() != classes)
+    m_slots.assign(classes, noSlot);
+
+  // Candidates are shared by the whole batch, and the correct classes which
+  // weren't sampled are added after the sampled ones
+  const Draws draws{sample(classes)};
+  for (size_t i{}; i < inputs.rows(); ++i) {
+    const size_t label{labelOf(i)};
+    if (m_slots[label] == noSlot) {
+      m_slots[label] = m_candidates.size();
+      m_candidates.push_back(label);
+    }
+  }
+
+  m_corrections.resize(m_candidates.size());
+  for (size_t k{}; k < m_candidates.size(); ++k)
+    m_corrections[k] = logExpectedCount(classes, draws, m_candidates[k]);
+
+  layer.forwardSampled(inputs, m_candidates, m_dlogits);
+
+  if (m_output.size() != inputs.rows()) {
+    m_output.resize(inputs.rows());
+    m_hits.resize(inputs.rows());
+  }
+
+  // Chose 30 as a rough summation of operations done in the loop in comparison
+  // to a single addition
+  const size_t cost{m_candidates.size() * 30};
+  const float normalization{1 / static_cast<float>(inputs.rows())};
+
+  forwardSamples(
+      cost, inputs.rows(),
+      [this, &labelOf, normalization](size_t batch) {
+        const size_t candidates{m_candidates.size()};
+        const size_t target{m_slots[labelOf(batch)]};
+        float *row{&m_dlogits[batch, 0]};
+
+        // Every sample's softmax covers the sampled classes and its own
+        // correct class, with their logits corrected by their expected counts
+        // (the correct classes of other samples are left out)
+        for (size_t k{}; k < candidates; ++k)
+          row[k] = k < m_samples || k == target
+                       ? row[k] - m_corrections[k]
+                       : -std::numeric_limits<float>::infinity();
+        const float targetLogit{row[target]};
+
+        const Math::SoftmaxRow<float> softmax{
+            Math::softmax(row, row, candidates)};
+        m_output[batch] = softmax.max + std::log(softmax.sum) - targetLogit;
+        m_hits[batch] = softmax.argmax == target ? 1 : 0;
+
+        row[target] -= 1;
+        for (size_t k{}; k < candidates; ++k)
+          row[k] *= normalization;
+      },
+      1);
+
+  for (size_t label : m_candidates)
+    m_slots[label] = noSlot;
+
+  return m_output;
+}
+
+size_t SampledSoftmax::reserve(size_t batchSize, size_t outputs) {
+  const size_t candidates{m_samples + batchSize};
+  m_candidates.reserve(candidates);
+  m_corrections.reserve(candidates);
+  m_dlogits.reserve(batchSize, candidates);
+
+  return CategoricalSoftmax::reserve(batchSize, outputs) +
+         (candidates + batchSize * candidates) * sizeof(float) +
+         candidates * sizeof(size_t);
+}
+
+SampledSoftmax::Draws SampledSoftmax::sample(size_t classes) {
+  m_candidates.clear();
+
+  // Log-uniform classes are exp(u * log(classes + 1)) - 1, rounded down, for a
+  // uniform u in [0, 1)
+  std::uniform_real_distribution<double> uniform{};
+  std::uniform_int_distribution<size_t> uniformClass{0, classes - 1};
+  const double logRange{std::log(static_cast<double>(classes) + 1)};
+
+  Draws draws{};
+  while (m_candidates.size() < m_samples &&
+         draws.draws < maxDrawsPerSample * m_samples) {
+    ++draws.draws;
+    const size_t label{
+        m_logUniform
+            ? std::min(static_cast<size_t>(
+                           std::exp(uniform(Math::Random::mt) * logRange)) -
+                           1,
+                       classes - 1)
+            : uniformClass(Math::Random::mt)};
+    if (m_slots[label] != noSlot)
+      continue;
+
+    m_slots[label] = m_candidates.size();
+    m_candidates.push_back(label);
+  }
+
+  if (m_candidates.size() == m_samples)
+    return draws;
+
+  // Selection sampling of the missing classes over the classes not drawn, in
+  // a single pass
+  size_t missing{m_samples - m_candidates.size()};
+  size_t left{classes - m_candidates.size()};
+  draws.completion = static_cast<double>(missing) / static_cast<double>(left);
+  for (size_t label{}; missing > 0; ++label) {
+    if (m_slots[label] != noSlot)
+      continue;
+
+    if (uniform(Math::Random::mt) * static_cast<double>(left) <
+        static_cast<double>(missing)) {
+      m_slots[label] = m_candidates.size();
+      m_candidates.push_back(label);
+      --missing;
+    }
+    --left;
+  }
+
+  return draws;
+}
+
+float SampledSoftmax::logExpectedCount(size_t classes, const Draws &draws,
+                                       size_t label) const {
+  const double probability{
+      m_logUniform ? std::log((static_cast<double>(label) + 2) /
+                              (static_cast<double>(label) + 1)) /
+                         std::log(static_cast<double>(classes) + 1)
+                   : 1 / static_cast<double>(classes)};
+
+  // Probability of being drawn at least once, as the draws stop at the first
+  // m_samples distinct classes
+  const double drawn{-std::expm1(static_cast<double>(draws.draws) *
+                                 std::log1p(-probability))};
+  if (draws.completion == 0)
+    return static_cast<float>(std::log(drawn));
+
+  // Or of being chosen by the completion otherwise
+  return static_cast<float>(
+      std::log(drawn + (1 - drawn) * draws.completion));
+}
+} // namespace Loss
+} // namespace ANN
@@ -6,6 +6,7 @@
 #include "utils/variants.h"
 
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <fstream>
 #include <string>
@@ -105,6 +106,22 @@ FeedForwardModel ModelLoader::loadFeedForward(const std::string &path) {
             modelDesc.layers.push_back(Dense{});
           else if (val == "dropout")
             modelDesc.layers.push_back(Dropout{});
+          else if (val == "conv2d")
+            modelDesc.layers.push_back(Conv2D{});
+          else if (val == "embedding")
+            modelDesc.layers.push_back(Embedding{});
+          else if (val == "lstm")
+            modelDesc.layers.push_back(LSTM{});
+          else if (val == "gru")
+            modelDesc.layers.push_back(GRU{});
+          else if (val == "multi_head_attention")
+            modelDesc.layers.push_back(MultiHeadAttention{});
+          else if (val == "batch_norm")
+            modelDesc.layers.push_back(BatchNorm{});
+          else if (val == "max_pool2d")
+            modelDesc.layers.push_back(MaxPool2D{});
+          else if (val == "avg_pool2d")
+            modelDesc.layers.push_back(AvgPool2D{});
           else if (val == "step")
             modelDesc.layers.push_back(Step{});
           else if (val == "sigmoid")
@@ -119,7 +136,9 @@ FeedForwardModel ModelLoader::loadFeedForward(const std::string &path) {
             throw ANN::Exception{
                 CURRENT_FUNCTION,
                 "Unknown layer type provided '" + val +
-                    "'. Supported types are: 'dense', 'dropout', 'step', "
+                    "'. Supported types are: 'dense', 'dropout', 'conv2d', "
+                    "'embedding', 'lstm', 'gru', 'multi_head_attention', "
+                    "'batch_norm', 'max_pool2d', 'avg_pool2d', 'step', "
                     "'sigmoid', 'relu', 'leaky_relu', 'softmax'. From line " +
                     lineNumStr};
           continue;
@@ -149,8 +168,12 @@ FeedForwardModel ModelLoader::loadFeedForward(const std::string &path) {
             trainDesc.loss = CategoricalCrossEntropyLoss{};
           else if (val == "categorical_cross_entropy_softmax")
             trainDesc.loss = CategoricalCrossEntropySoftmaxLoss{};
+          else if (val == "sampled_categorical_cross_entropy_softmax")
+            trainDesc.loss = SampledCategoricalCrossEntropySoftmaxLoss{};
           else if (val == "binary_cross_entropy")
             trainDesc.loss = BinaryCrossEntropyLoss{};
+          else if (val == "binary_cross_entropy_sigmoid")
+            trainDesc.loss = BinaryCrossEntropySigmoidLoss{};
           else if (val == "mean_squared_error")
             trainDesc.loss = MeanSquaredErrorLoss{};
           else if (val == "mean_absolute_error")
@@ -161,16 +184,37 @@ FeedForwardModel ModelLoader::loadFeedForward(const std::string &path) {
                 "Unknown loss type provided '" + val +
                     "'. Supported type are: 'categorical_cross_entropy', "
                     "'categorical_cross_entropy_softmax', "
-                    "'binary_cross_entropy', 'mean_squared_error', "
+                    "'sampled_categorical_cross_entropy_softmax', "
+                    "'binary_cross_entropy', "
+                    "'binary_cross_entropy_sigmoid', 'mean_squared_error', "
                     "'mean_absolute_error'. From line " +
                     lineNumStr};
           continue;
         }
 
+        // Sampled softmax is the only loss with further settings
+        auto *sampled{std::get_if<SampledCategoricalCrossEntropySoftmaxLoss>(
+            &trainDesc.loss)};
+        if (sampled && key == "samples") {
+          int samples{parseStrictInt(val, lineNumStr)};
+          if (samples <= 0)
+            throw ANN::Exception{CURRENT_FUNCTION,
+                                 "Sampled classes must be a natural number "
+                                 "(integer greater then 0). From line " +
+                                     lineNumStr};
+          sampled->samples = static_cast<unsigned int>(samples);
+          continue;
+        }
+        if (sampled && key == "log_uniform") {
+          sampled->logUniform = parseStrictBool(val, lineNumStr);
+          continue;
+        }
+
         throw ANN::Exception{
             CURRENT_FUNCTION,
             "Unknown loss configuration provided '" + key +
-                "'. Supported configurations are: 'type'. From line " +
+                "'. Supported configurations are: 'type', and 'samples' and "
+                "'log_uniform' after a sampled softmax type. From line " +
                 lineNumStr};
         continue;
       }
@@ -187,11 +231,16 @@ FeedForwardModel ModelLoader::loadFeedForward(const std::string &path) {
             trainDesc.optimizer = RMSProp{};
           else if (val == "adam")
             trainDesc.optimizer = Adam{};
+          else if (val == "lamb")
+            trainDesc.optimizer = LAMB{};
+          else if (val == "lars")
+            trainDesc.optimizer = LARS{};
           else
             throw ANN::Exception{CURRENT_FUNCTION,
                                  "Unknown optimizer type provided '" + val +
                                      "'. Supported type are: 'sgd', 'adagrad', "
-                                     "'rmsprop', 'adam'. From line " +
+                                     "'rmsprop', 'adam', 'lamb', 'lars'. From "
+                                     "line " +
                                      lineNumStr};
           continue;
         }
@@ -248,11 +297,53 @@ FeedForwardModel ModelLoader::loadFeedForward(const std::string &path) {
         trainDesc.verbose = parseStrictBool(val, lineNumStr);
         continue;
       }
+      if (key == "log_interval") {
+        int interval{parseStrictInt(val, lineNumStr)};
+        if (interval <= 0)
+          throw ANN::Exception{CURRENT_FUNCTION,
+                               "Log interval must be a natural number "
+                               "(integer greater then 0). From line " +
+                                   lineNumStr};
+        trainDesc.logInterval = static_cast<size_t>(interval);
+        continue;
+      }
+      if (key == "gradient_checkpointing") {
+        trainDesc.gradientCheckpointing = parseStrictBool(val, lineNumStr);
+        continue;
+      }
+      if (key == "gradient_accumulation_steps") {
+        int steps{parseStrictInt(val, lineNumStr)};
+        if (steps <= 0)
+          throw ANN::Exception{CURRENT_FUNCTION,
+                               "Gradient accumulation steps must be a natural "
+                               "number (integer greater then 0). From line " +
+                                   lineNumStr};
+        trainDesc.gradientAccumulationSteps = static_cast<size_t>(steps);
+        continue;
+      }
+      if (key == "data_parallel_replicas") {
+        int replicas{parseStrictInt(val, lineNumStr)};
+        if (replicas <= 0)
+          throw ANN::Exception{CURRENT_FUNCTION,
+                               "Data-parallel replicas must be a natural "
+                               "number (integer greater then 0). From line " +
+                                   lineNumStr};
+        trainDesc.dataParallelReplicas = static_cast<size_t>(replicas);
+        continue;
+      }
+      if (key == "quantized_optimizer_state") {
+        trainDesc.quantizedOptimizerState = parseStrictBool(val, lineNumStr);
+        continue;
+      }
 
       throw ANN::Exception{CURRENT_FUNCTION,
                            "Expected 'loss...', 'optimizer...', 'batch_size', "
                            "'epochs', 'train_validation_rate', "
-                           "'shuffle_batches', or 'verbose'. From line " +
+                           "'shuffle_batches', 'verbose', 'log_interval', "
+                           "'gradient_checkpointing', "
+                           "'gradient_accumulation_steps', "
+                           "'data_parallel_replicas', or "
+                           "'quantized_optimizer_state'. From line " +
                                lineNumStr};
     }
   }
@@ -274,6 +365,78 @@ FeedForwardModel ModelLoader::loadFeedForward(const std::string &path) {
             CURRENT_FUNCTION,
             "Required configuration 'drop_rate' in layer number " +
                 std::to_string(i + 1) + " has not been set."};
+    } else if (std::holds_alternative<Conv2D>(layer)) {
+      Conv2D &conv{std::get<Conv2D>(layer)};
+      if (conv.filters == 0)
+        throw ANN::Exception{
+            CURRENT_FUNCTION,
+            "Required configuration 'filters' in layer number " +
+                std::to_string(i + 1) + " has not been set."};
+      if (conv.kernelSize == 0)
+        throw ANN::Exception{
+            CURRENT_FUNCTION,
+            "Required configuration 'kernel_size' in layer number " +
+                std::to_string(i + 1) + " has not been set."};
+      if ((conv.inputHeight == 0) != (conv.inputWidth == 0))
+        throw ANN::Exception{CURRENT_FUNCTION,
+                             "Configurations 'input_height' and 'input_width' "
+                             "in layer number " +
+                                 std::to_string(i + 1) +
+                                 " must be set together."};
+    } else if (std::holds_alternative<Embedding>(layer)) {
+      Embedding &embedding{std::get<Embedding>(layer)};
+      if (embedding.vocabularySize == 0)
+        throw ANN::Exception{
+            CURRENT_FUNCTION,
+            "Required configuration 'vocabulary_size' in layer number " +
+                std::to_string(i + 1) + " has not been set."};
+      if (embedding.dimensions == 0)
+        throw ANN::Exception{
+            CURRENT_FUNCTION,
+            "Required configuration 'dimensions' in layer number " +
+                std::to_string(i + 1) + " has not been set."};
+    } else if (std::holds_alternative<LSTM>(layer) ||
+               std::holds_alternative<GRU>(layer)) {
+      const unsigned int units{std::visit(
+          [](const auto &recurrent) -> unsigned int {
+            if constexpr (requires { recurrent.units; })
+              return recurrent.units;
+            else
+              return {};
+          },
+          layer)};
+      if (units == 0)
+        throw ANN::Exception{
+            CURRENT_FUNCTION,
+            "Required configuration 'units' in layer number " +
+                std::to_string(i + 1) + " has not been set."};
+    } else if (std::holds_alternative<MultiHeadAttention>(layer)) {
+      if (std::get<MultiHeadAttention>(layer).heads == 0)
+        throw ANN::Exception{
+            CURRENT_FUNCTION,
+            "Required configuration 'heads' in layer number " +
+                std::to_string(i + 1) + " has not been set."};
+    } else if (std::holds_alternative<MaxPool2D>(layer) ||
+               std::holds_alternative<AvgPool2D>(layer)) {
+      const auto [poolSize, inputHeight, inputWidth]{std::visit(
+          [](const auto &pool) -> std::array<unsigned int, 3> {
+            if constexpr (requires { pool.poolSize; })
+              return {pool.poolSize, pool.inputHeight, pool.inputWidth};
+            else
+              return {};
+          },
+          layer)};
+      if (poolSize == 0)
+        throw ANN::Exception{
+            CURRENT_FUNCTION,
+            "Required configuration 'pool_size' in layer number " +
+                std::to_string(i + 1) + " has not been set."};
+      if ((inputHeight == 0) != (inputWidth == 0))
+        throw ANN::Exception{CURRENT_FUNCTION,
+                             "Configurations 'input_height' and 'input_width' "
+                             "in layer number " +
+                                 std::to_string(i + 1) +
+                                 " must be set together."};
     } else if (std::holds_alternative<LeakyReLU>(layer)) {
       LeakyReLU &leakyReLU{std::get<LeakyReLU>(layer)};
       if (leakyReLU.alpha == 0)
@@ -283,6 +446,13 @@ FeedForwardModel ModelLoader::loadFeedForward(const std::string &path) {
     }
   }
 
+  if (auto sampled{std::get_if<SampledCategoricalCrossEntropySoftmaxLoss>(
+          &trainDesc.loss)};
+      sampled && sampled->samples == 0)
+    throw ANN::Exception{
+        CURRENT_FUNCTION,
+        "Required loss configuration 'samples' has not been set."};
+
   // Check if input number has been set
   if (modelDesc.inputs == 0)
     throw ANN::Exception{
@@ -356,6 +526,259 @@ void ModelLoader::configLayer(Dropout &layer, const std::string &config,
           "'. Allowed configurations are: 'drop_rate'. From line " +
           lineNumStr};
 }
+void ModelLoader::configLayer(Conv2D &layer, const std::string &config,
+                              const std::string &value,
+                              const std::string &lineNumStr) {
+  // All the integer configurations share the same parsing
+  unsigned int *intConfig{nullptr};
+  bool allowZero{false};
+  if (config == "filters")
+    intConfig = &layer.filters;
+  else if (config == "kernel_size")
+    intConfig = &layer.kernelSize;
+  else if (config == "stride")
+    intConfig = &layer.stride;
+  else if (config == "input_channels")
+    intConfig = &layer.inputChannels;
+  else if (config == "input_height")
+    intConfig = &layer.inputHeight;
+  else if (config == "input_width")
+    intConfig = &layer.inputWidth;
+  else if (config == "padding") {
+    intConfig = &layer.padding;
+    allowZero = true;
+  }
+
+  if (intConfig) {
+    int val{parseStrictInt(value, lineNumStr)};
+    if (val < 0 || (val == 0 && !allowZero))
+      throw ANN::Exception{
+          CURRENT_FUNCTION,
+          "Conv2D " + config + " must be a " +
+              (allowZero ? "non-negative integer"
+                         : "natural number (integer greater then 0)") +
+              ". From line " + lineNumStr};
+    *intConfig = static_cast<unsigned int>(val);
+    return;
+  }
+
+  if (config == "init_method") {
+    if (value == "random")
+      layer.initMethod = WeightInit::Random;
+    else if (value == "he")
+      layer.initMethod = WeightInit::He;
+    else if (value == "xavier")
+      layer.initMethod = WeightInit::Xavier;
+    else
+      throw ANN::Exception{CURRENT_FUNCTION,
+                           "Unknown weight initalizer. Allowed initializers "
+                           "are: 'random', 'he', and 'xavier'. From line " +
+                               lineNumStr};
+    return;
+  }
+  throw ANN::Exception{
+      CURRENT_FUNCTION,
+      "Unknown conv2d configuration provided '" + config +
+          "'. Allowed configurations are: 'filters', 'kernel_size', "
+          "'stride', 'padding', 'input_channels', 'input_height', "
+          "'input_width', 'init_method'. From line " +
+          lineNumStr};
+}
+void ModelLoader::configLayer(Embedding &layer, const std::string &config,
+                              const std::string &value,
+                              const std::string &lineNumStr) {
+  if (config == "vocabulary_size" || config == "dimensions") {
+    int val{parseStrictInt(value, lineNumStr)};
+    if (val <= 0)
+      throw ANN::Exception{CURRENT_FUNCTION,
+                           "Embedding " + config +
+                               " must be a natural number (integer greater "
+                               "then 0). From line " +
+                               lineNumStr};
+    (config == "dimensions" ? layer.dimensions : layer.vocabularySize) =
+        static_cast<unsigned int>(val);
+    return;
+  } else if (config == "init_method") {
+    if (value == "random")
+      layer.initMethod = WeightInit::Random;
+    else if (value == "he")
+      layer.initMethod = WeightInit::He;
+    else if (value == "xavier")
+      layer.initMethod = WeightInit::Xavier;
+    else
+      throw ANN::Exception{CURRENT_FUNCTION,
+                           "Unknown weight initalizer. Allowed initializers "
+                           "are: 'random', 'he', and 'xavier'. From line " +
+                               lineNumStr};
+    return;
+  }
+  throw ANN::Exception{
+      CURRENT_FUNCTION,
+      "Unknown embedding configuration provided '" + config +
+          "'. Allowed configurations are: 'vocabulary_size', 'dimensions', "
+          "'init_method'. From line " +
+          lineNumStr};
+}
+void ModelLoader::configLayer(LSTM &layer, const std::string &config,
+                              const std::string &value,
+                              const std::string &lineNumStr) {
+  configRecurrent(layer, "lstm", config, value, lineNumStr);
+}
+void ModelLoader::configLayer(GRU &layer, const std::string &config,
+                              const std::string &value,
+                              const std::string &lineNumStr) {
+  configRecurrent(layer, "gru", config, value, lineNumStr);
+}
+void ModelLoader::configLayer(MultiHeadAttention &layer,
+                              const std::string &config,
+                              const std::string &value,
+                              const std::string &lineNumStr) {
+  if (config == "heads" || config == "input_size") {
+    int val{parseStrictInt(value, lineNumStr)};
+    if (val <= 0)
+      throw ANN::Exception{CURRENT_FUNCTION,
+                           "Multi head attention " + config +
+                               " must be a natural number (integer greater "
+                               "then 0). From line " +
+                               lineNumStr};
+    (config == "heads" ? layer.heads : layer.inputSize) =
+        static_cast<unsigned int>(val);
+    return;
+  } else if (config == "init_method") {
+    if (value == "random")
+      layer.initMethod = WeightInit::Random;
+    else if (value == "he")
+      layer.initMethod = WeightInit::He;
+    else if (value == "xavier")
+      layer.initMethod = WeightInit::Xavier;
+    else
+      throw ANN::Exception{CURRENT_FUNCTION,
+                           "Unknown weight initalizer. Allowed initializers "
+                           "are: 'random', 'he', and 'xavier'. From line " +
+                               lineNumStr};
+    return;
+  }
+  throw ANN::Exception{
+      CURRENT_FUNCTION,
+      "Unknown multi_head_attention configuration provided '" + config +
+          "'. Allowed configurations are: 'heads', 'input_size', "
+          "'init_method'. From line " +
+          lineNumStr};
+}
+void ModelLoader::configLayer(BatchNorm &layer, const std::string &config,
+                              const std::string &value,
+                              const std::string &lineNumStr) {
+  if (config == "momentum") {
+    layer.momentum = parseStrictFloat(value, lineNumStr);
+    if (layer.momentum < 0 || layer.momentum > 1)
+      throw ANN::Exception{CURRENT_FUNCTION,
+                           "Invalid batch norm momentum provided. Needs to be "
+                           "between 0 and 1 (including). From line " +
+                               lineNumStr};
+    return;
+  } else if (config == "epsilon") {
+    layer.epsilon = parseStrictFloat(value, lineNumStr);
+    if (layer.epsilon <= 0)
+      throw ANN::Exception{CURRENT_FUNCTION,
+                           "Batch norm epsilon must be positive. From line " +
+                               lineNumStr};
+    return;
+  }
+  throw ANN::Exception{
+      CURRENT_FUNCTION,
+      "Unknown batch_norm configuration provided '" + config +
+          "'. Allowed configurations are: 'momentum', 'epsilon'. From line " +
+          lineNumStr};
+}
+template <typename PoolDescriptor>
+void ModelLoader::configPool(PoolDescriptor &layer, std::string_view typeName,
+                             const std::string &config,
+                             const std::string &value,
+                             const std::string &lineNumStr) {
+  unsigned int *intConfig{nullptr};
+  if (config == "pool_size")
+    intConfig = &layer.poolSize;
+  else if (config == "stride")
+    intConfig = &layer.stride;
+  else if (config == "input_channels")
+    intConfig = &layer.inputChannels;
+  else if (config == "input_height")
+    intConfig = &layer.inputHeight;
+  else if (config == "input_width")
+    intConfig = &layer.inputWidth;
+
+  if (intConfig) {
+    int val{parseStrictInt(value, lineNumStr)};
+    if (val <= 0)
+      throw ANN::Exception{CURRENT_FUNCTION,
+                           std::string{typeName} + " " + config +
+                               " must be a natural number (integer greater "
+                               "then 0). From line " +
+                               lineNumStr};
+    *intConfig = static_cast<unsigned int>(val);
+    return;
+  }
+
+  throw ANN::Exception{
+      CURRENT_FUNCTION,
+      "Unknown " + std::string{typeName} + " configuration provided '" +
+          config +
+          "'. Allowed configurations are: 'pool_size', 'stride', "
+          "'input_channels', 'input_height', 'input_width'. From line " +
+          lineNumStr};
+}
+template <typename RecurrentDescriptor>
+void ModelLoader::configRecurrent(RecurrentDescriptor &layer,
+                                  std::string_view typeName,
+                                  const std::string &config,
+                                  const std::string &value,
+                                  const std::string &lineNumStr) {
+  if (config == "units" || config == "input_size") {
+    int val{parseStrictInt(value, lineNumStr)};
+    if (val <= 0)
+      throw ANN::Exception{CURRENT_FUNCTION,
+                           std::string{typeName} + " " + config +
+                               " must be a natural number (integer greater "
+                               "then 0). From line " +
+                               lineNumStr};
+    (config == "units" ? layer.units : layer.inputSize) =
+        static_cast<unsigned int>(val);
+    return;
+  } else if (config == "return_sequences") {
+    layer.returnSequences = parseStrictBool(value, lineNumStr);
+    return;
+  } else if (config == "init_method") {
+    if (value == "random")
+      layer.initMethod = WeightInit::Random;
+    else if (value == "he")
+      layer.initMethod = WeightInit::He;
+    else if (value == "xavier")
+      layer.initMethod = WeightInit::Xavier;
+    else
+      throw ANN::Exception{CURRENT_FUNCTION,
+                           "Unknown weight initalizer. Allowed initializers "
+                           "are: 'random', 'he', and 'xavier'. From line " +
+                               lineNumStr};
+    return;
+  }
+  throw ANN::Exception{
+      CURRENT_FUNCTION,
+      "Unknown " + std::string{typeName} + " configuration provided '" +
+          config +
+          "'. Allowed configurations are: 'units', 'input_size', "
+          "'return_sequences', 'init_method'. From line " +
+          lineNumStr};
+}
+void ModelLoader::configLayer(MaxPool2D &layer, const std::string &config,
+                              const std::string &value,
+                              const std::string &lineNumStr) {
+  configPool(layer, "max_pool2d", config, value, lineNumStr);
+}
+void ModelLoader::configLayer(AvgPool2D &layer, const std::string &config,
+                              const std::string &value,
+                              const std::string &lineNumStr) {
+  configPool(layer, "avg_pool2d", config, value, lineNumStr);
+}
 void ModelLoader::configLayer(Step &, const std::string &, const std::string &,
                               const std::string &lineNumStr) {
   throw ANN::Exception{CURRENT_FUNCTION,
@@ -491,6 +914,70 @@ void ModelLoader::configOptimizer(Adam &optimizer, const std::string &config,
                            "'decay', 'epsilon', 'beta1', 'beta2'. From line " +
                            lineNumStr};
 }
+void ModelLoader::configOptimizer(LAMB &optimizer, const std::string &config,
+                                  const std::string &value,
+                                  const std::string &lineNumStr) {
+  if (config == "learning_rate") {
+    optimizer.learningRate = parseStrictFloat(value, lineNumStr);
+    return;
+  }
+  if (config == "decay") {
+    optimizer.decay = parseStrictFloat(value, lineNumStr);
+    return;
+  }
+  if (config == "epsilon") {
+    optimizer.epsilon = parseStrictFloat(value, lineNumStr);
+    return;
+  }
+  if (config == "beta1") {
+    optimizer.beta1 = parseStrictFloat(value, lineNumStr);
+    return;
+  }
+  if (config == "beta2") {
+    optimizer.beta2 = parseStrictFloat(value, lineNumStr);
+    return;
+  }
+  if (config == "weight_decay") {
+    optimizer.weightDecay = parseStrictFloat(value, lineNumStr);
+    return;
+  }
+  throw ANN::Exception{CURRENT_FUNCTION,
+                       "Unknown LAMB configuration provided '" + config +
+                           "'. Allowed configurations are: 'learning_rate', "
+                           "'decay', 'epsilon', 'beta1', 'beta2', "
+                           "'weight_decay'. From line " +
+                           lineNumStr};
+}
+void ModelLoader::configOptimizer(LARS &optimizer, const std::string &config,
+                                  const std::string &value,
+                                  const std::string &lineNumStr) {
+  if (config == "learning_rate") {
+    optimizer.learningRate = parseStrictFloat(value, lineNumStr);
+    return;
+  }
+  if (config == "decay") {
+    optimizer.decay = parseStrictFloat(value, lineNumStr);
+    return;
+  }
+  if (config == "momentum") {
+    optimizer.momentum = parseStrictFloat(value, lineNumStr);
+    return;
+  }
+  if (config == "weight_decay") {
+    optimizer.weightDecay = parseStrictFloat(value, lineNumStr);
+    return;
+  }
+  if (config == "trust_coefficient") {
+    optimizer.trustCoefficient = parseStrictFloat(value, lineNumStr);
+    return;
+  }
+  throw ANN::Exception{CURRENT_FUNCTION,
+                       "Unknown LARS configuration provided '" + config +
+                           "'. Allowed configurations are: 'learning_rate', "
+                           "'decay', 'momentum', 'weight_decay', "
+                           "'trust_coefficient'. From line " +
+                           lineNumStr};
+}
 
 void ModelLoader::trim(std::string &str) {
   // Comment trim - erases from first '#' character to str end
@@ -1,5 +1,6 @@
 #include "ann/optimizers/adagrad.h"
 
+#include <algorithm>
 #include <cmath>
 
 namespace ANN {
@@ -9,43 +10,22 @@ void Adagrad::preUpdate() {
       std::max(m_startingLearningRate / (1 + m_decay * m_iteration), 1e-7f);
 }
 
-void Adagrad::updateParams(Layers::Dense &layer) const {
-  auto learningRate{m_learningRate};
-  auto epsilon{m_epsilon};
+void Adagrad::updateRange(const Range &range) const {
+  const float learningRate{m_learningRate};
+  const float epsilon{m_epsilon};
 
-  // update weight/bias cache member variables to account for adaptive lr
-  layer.m_weightCache.transform(layer.m_dweights,
-                                [](float *weightCache, const float *gradient) {
-                                  *weightCache += *gradient * *gradient;
-                                });
-  layer.m_biasCache.transform(layer.m_dbiases,
-                              [](float *biasCache, const float *gradient) {
-                                *biasCache += *gradient * *gradient;
-                              });
+  float *values{range.values};
+  float *cache{range.cache};
+  const float *gradients{range.gradients};
+  const float l1{range.l1};
+  const float l2{range.l2};
 
-  // Calculate actual weight/bias updates
-  layer.m_weightMomentums.transform(
-      layer.m_dweights, layer.m_weightCache,
-      [learningRate, epsilon](float *weightUpdates, const float *gradient,
-                              const float *cache) {
-        *weightUpdates =
-            learningRate * *gradient / (std::sqrt(*cache) + epsilon);
-      });
-  layer.m_biasMomentums.transform(
-      layer.m_dbiases, layer.m_biasCache,
-      [learningRate, epsilon](float *biasUpdates, const float *gradient,
-                              const float *cache) {
-        *biasUpdates = learningRate * *gradient / (std::sqrt(*cache) + epsilon);
-      });
-
-  // use weight/bias update to update weights/biases
-  layer.m_weights.transform(layer.m_weightMomentums,
-                            [](float *weight, const float *weightUpdates) {
-                              *weight -= *weightUpdates;
-                            });
-  layer.m_biases.transform(
-      layer.m_biasMomentums,
-      [](float *bias, const float *biasUpdates) { *bias -= *biasUpdates; });
+  // update cache to account for adaptive lr, and use it to update parameters
+  for (size_t i{}; i < range.count; ++i) {
+    const float gradient{regularize(gradients[i], values[i], l1, l2)};
+    cache[i] += gradient * gradient;
+    values[i] -= learningRate * gradient / (std::sqrt(cache[i]) + epsilon);
+  }
 }
 
 void Adagrad::postUpdate() { ++m_iteration; }
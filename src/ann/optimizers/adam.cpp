@@ -1,5 +1,6 @@
 #include "ann/optimizers/adam.h"
 
+#include <algorithm>
 #include <cmath>
 
 namespace ANN {
@@ -9,56 +10,33 @@ void Adam::preUpdate() {
       std::max(m_startingLearningRate / (1 + m_decay * m_iteration), 1e-7f);
 }
 
-void Adam::updateParams(Layers::Dense &layer) const {
-  auto learningRate{m_learningRate};
-  auto epsilon{m_epsilon};
-  auto beta1{m_beta1};
-  auto beta2{m_beta2};
-  auto iteration{m_iteration};
-  auto momentumCorrection{1 - std::pow(beta1, iteration + 1)};
-  auto cacheCorrection{1 - std::pow(beta2, iteration + 1)};
+void Adam::updateRange(const Range &range) const {
+  const float learningRate{m_learningRate};
+  const float epsilon{m_epsilon};
+  const float beta1{m_beta1};
+  const float beta2{m_beta2};
+  const float momentumCorrection{1 - std::pow(beta1, m_iteration + 1)};
+  const float cacheCorrection{1 - std::pow(beta2, m_iteration + 1)};
 
-  // Calculate weight/bias update momentums
-  layer.m_weightMomentums.transform(
-      layer.m_dweights, [beta1](float *weightMomentums, const float *gradient) {
-        *weightMomentums = beta1 * *weightMomentums + (1 - beta1) * *gradient;
-      });
-  layer.m_biasMomentums.transform(
-      layer.m_dbiases, [beta1](float *biasMomentums, const float *gradient) {
-        *biasMomentums = beta1 * *biasMomentums + (1 - beta1) * *gradient;
-      });
+  float *values{range.values};
+  float *momentums{range.momentums};
+  float *cache{range.cache};
+  const float *gradients{range.gradients};
+  const float l1{range.l1};
+  const float l2{range.l2};
 
-  // update weight/bias cache member variables to account for adaptive lr
-  layer.m_weightCache.transform(
-      layer.m_dweights, [beta2](float *weightCache, const float *gradient) {
-        *weightCache =
-            beta2 * *weightCache + (1 - beta2) * *gradient * *gradient;
-      });
-  layer.m_biasCache.transform(
-      layer.m_dbiases, [beta2](float *biasCache, const float *gradient) {
-        *biasCache = beta2 * *biasCache + (1 - beta2) * *gradient * *gradient;
-      });
+  // Momentums, cache (for the adaptive lr) and parameters in a single pass,
+  // so every gradient is read once
+  for (size_t i{}; i < range.count; ++i) {
+    const float gradient{regularize(gradients[i], values[i], l1, l2)};
+    momentums[i] = beta1 * momentums[i] + (1 - beta1) * gradient;
+    cache[i] = beta2 * cache[i] + (1 - beta2) * gradient * gradient;
 
-  // use weight/bias update to update weights/biases
-  layer.m_weights.transform(
-      layer.m_weightMomentums, layer.m_weightCache,
-      [momentumCorrection, cacheCorrection, epsilon,
-       learningRate](float *weight, const float *weightMomentum,
-                     const float *weightCache) {
-        float correctWeightMomentum{*weightMomentum / momentumCorrection};
-        float correctWeightCache{*weightCache / cacheCorrection};
-        *weight -= learningRate * correctWeightMomentum /
-                   (std::sqrt(correctWeightCache) + epsilon);
-      });
-  layer.m_biases.transform(
-      layer.m_biasMomentums, layer.m_biasCache,
-      [momentumCorrection, cacheCorrection, epsilon, learningRate](
-          float *bias, const float *biasMomentum, const float *biasCache) {
-        float correctBiasMomentum{*biasMomentum / momentumCorrection};
-        float correctBiasCache{*biasCache / cacheCorrection};
-        *bias -= learningRate * correctBiasMomentum /
-                 (std::sqrt(correctBiasCache) + epsilon);
-      });
+    float correctMomentum{momentums[i] / momentumCorrection};
+    float correctCache{cache[i] / cacheCorrection};
+    values[i] -=
+        learningRate * correctMomentum / (std::sqrt(correctCache) + epsilon);
+  }
 }
 
 void Adam::postUpdate() { ++m_iteration; }
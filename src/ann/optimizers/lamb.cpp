@@ -0,0 +1,73 @@
+#include "ann/optimizers/lamb.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ANN {
+namespace Optimizers {
+void LAMB::preUpdate() {
+  m_learningRate =
+      std::max(m_startingLearningRate / (1 + m_decay * m_iteration), 1e-7f);
+}
+
+void LAMB::measureRange(const Range &range, float *sums) const {
+  const float epsilon{m_epsilon};
+  const float beta1{m_beta1};
+  const float beta2{m_beta2};
+  const float weightDecay{m_weightDecay};
+  const float momentumCorrection{1 - std::pow(beta1, m_iteration + 1)};
+  const float cacheCorrection{1 - std::pow(beta2, m_iteration + 1)};
+
+  const float *values{range.values};
+  float *momentums{range.momentums};
+  float *cache{range.cache};
+  const float *gradients{range.gradients};
+  const float l1{range.l1};
+  const float l2{range.l2};
+
+  float valueNorm{};
+  float stepNorm{};
+  for (size_t i{}; i < range.count; ++i) {
+    const float gradient{regularize(gradients[i], values[i], l1, l2)};
+    momentums[i] = beta1 * momentums[i] + (1 - beta1) * gradient;
+    cache[i] = beta2 * cache[i] + (1 - beta2) * gradient * gradient;
+
+    const float step{(momentums[i] / momentumCorrection) /
+                         (std::sqrt(cache[i] / cacheCorrection) + epsilon) +
+                     weightDecay * values[i]};
+    valueNorm += values[i] * values[i];
+    stepNorm += step * step;
+  }
+
+  sums[0] += valueNorm;
+  sums[1] += stepNorm;
+}
+
+void LAMB::updateRange(const Range &range) const {
+  const float epsilon{m_epsilon};
+  const float weightDecay{m_weightDecay};
+  const float momentumCorrection{1 - std::pow(m_beta1, m_iteration + 1)};
+  const float cacheCorrection{1 - std::pow(m_beta2, m_iteration + 1)};
+
+  // Trust ratio of the whole parameter (1 if either norm is 0, e.g. for
+  // zero-initialized biases)
+  const float valueNorm{std::sqrt(range.sums[0])};
+  const float stepNorm{std::sqrt(range.sums[1])};
+  const float trustRatio{
+      valueNorm > 0 && stepNorm > 0 ? valueNorm / stepNorm : 1.0f};
+  const float learningRate{m_learningRate * trustRatio};
+
+  float *values{range.values};
+  const float *momentums{range.momentums};
+  const float *cache{range.cache};
+
+  for (size_t i{}; i < range.count; ++i)
+    values[i] -= learningRate *
+                 ((momentums[i] / momentumCorrection) /
+                      (std::sqrt(cache[i] / cacheCorrection) + epsilon) +
+                  weightDecay * values[i]);
+}
+
+void LAMB::postUpdate() { ++m_iteration; }
+} // namespace Optimizers
+} // namespace ANN
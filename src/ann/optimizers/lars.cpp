@@ -0,0 +1,71 @@
+#include "ann/optimizers/lars.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ANN {
+namespace Optimizers {
+void LARS::preUpdate() {
+  m_learningRate =
+      std::max(m_startingLearningRate / (1 + m_decay * m_iteration), 1e-7f);
+}
+
+void LARS::measureRange(const Range &range, float *sums) const {
+  const float *values{range.values};
+  const float *gradients{range.gradients};
+  const float l1{range.l1};
+  const float l2{range.l2};
+
+  float valueNorm{};
+  float gradientNorm{};
+  for (size_t i{}; i < range.count; ++i) {
+    const float gradient{regularize(gradients[i], values[i], l1, l2)};
+    valueNorm += values[i] * values[i];
+    gradientNorm += gradient * gradient;
+  }
+
+  sums[0] += valueNorm;
+  sums[1] += gradientNorm;
+}
+
+void LARS::updateRange(const Range &range) const {
+  const float momentum{m_momentum};
+  const float weightDecay{m_weightDecay};
+
+  // Trust ratio of the whole parameter (1 if either norm is 0, e.g. for
+  // zero-initialized biases)
+  const float valueNorm{std::sqrt(range.sums[0])};
+  const float gradientNorm{std::sqrt(range.sums[1])};
+  const float trustRatio{valueNorm > 0 && gradientNorm > 0
+                             ? m_trustCoefficient * valueNorm /
+                                   (gradientNorm + weightDecay * valueNorm)
+                             : 1.0f};
+  const float learningRate{m_learningRate * trustRatio};
+
+  float *values{range.values};
+  float *momentums{range.momentums};
+  const float *gradients{range.gradients};
+  const float l1{range.l1};
+  const float l2{range.l2};
+
+  // Without momentum, no state is kept (see usesMomentums())
+  if (!momentums) {
+    for (size_t i{}; i < range.count; ++i)
+      values[i] -=
+          learningRate * (regularize(gradients[i], values[i], l1, l2) +
+                          weightDecay * values[i]);
+    return;
+  }
+
+  for (size_t i{}; i < range.count; ++i) {
+    momentums[i] =
+        momentum * momentums[i] -
+        learningRate * (regularize(gradients[i], values[i], l1, l2) +
+                        weightDecay * values[i]);
+    values[i] += momentums[i];
+  }
+}
+
+void LARS::postUpdate() { ++m_iteration; }
+} // namespace Optimizers
+} // namespace ANN
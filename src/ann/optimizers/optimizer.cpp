@@ -0,0 +1,332 @@
+#include "ann/optimizers/optimizer.h"
+
+#include "utils/parallel.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ANN {
+namespace Optimizers {
+// Returns the largest transform(value) over values (which must be
+// non-negative). Independent partial maxima, so the loop vectorizes
+template <typename Transform>
+static float maximum(const float *values, size_t count, Transform transform) {
+  constexpr size_t lanes{8};
+  float maxima[lanes]{};
+  const size_t body{count - count % lanes};
+  for (size_t i{}; i < body; i += lanes)
+    for (size_t j{}; j < lanes; ++j)
+      maxima[j] = std::max(maxima[j], transform(values[i + j]));
+  for (size_t i{body}; i < count; ++i)
+    maxima[0] = std::max(maxima[0], transform(values[i]));
+
+  float result{};
+  for (size_t j{}; j < lanes; ++j)
+    result = std::max(result, maxima[j]);
+  return result;
+}
+
+// Quantization of a single block of state. Values are mapped through a square
+// root before being spread over the 8-bit range, so the small values most of
+// the state is made of keep more precision than with even steps
+
+// Momentums are signed, and scaled by the block's largest magnitude
+static void dequantizeMomentums(const int8_t *quantized, float scale,
+                                float *momentums, size_t count) {
+  for (size_t i{}; i < count; ++i) {
+    const float step{static_cast<float>(quantized[i]) / 127};
+    momentums[i] = step * std::abs(step) * scale;
+  }
+}
+
+static float quantizeMomentums(const float *momentums, int8_t *quantized,
+                               size_t count) {
+  const float scale{
+      maximum(momentums, count, [](float value) { return std::abs(value); })};
+
+  const float inverse{scale > 0 ? 1 / scale : 0};
+  for (size_t i{}; i < count; ++i) {
+    const float step{std::sqrt(std::abs(momentums[i]) * inverse) * 127};
+    quantized[i] =
+        static_cast<int8_t>(std::copysign(step + 0.5f, momentums[i]));
+  }
+  return scale;
+}
+
+// Cache is non-negative, and rounded up, so non-zero cache never turns into
+// zero (which would blow up adaptive learning rates)
+static void dequantizeCache(const uint8_t *quantized, float scale,
+                            float *cache, size_t count) {
+  for (size_t i{}; i < count; ++i) {
+    const float step{static_cast<float>(quantized[i]) / 255};
+    cache[i] = step * step * scale;
+  }
+}
+
+static float quantizeCache(const float *cache, uint8_t *quantized,
+                           size_t count) {
+  const float scale{maximum(cache, count, [](float value) { return value; })};
+
+  if (scale == 0) {
+    std::fill_n(quantized, count, 0);
+    return scale;
+  }
+
+  // Divided rather than multiplied by the inverse, so steps never exceed 255
+  for (size_t i{}; i < count; ++i) {
+    const float step{std::sqrt(cache[i] / scale) * 255};
+    const int truncated{static_cast<int>(step)};
+    quantized[i] = static_cast<uint8_t>(
+        truncated + static_cast<int>(static_cast<float>(truncated) < step));
+  }
+  return scale;
+}
+
+void Optimizer::update(std::span<const Parameter> params) {
+  bind(params);
+  split(params);
+  if (sumCount() > 0)
+    measure(params);
+
+  m_chunkPenalties.assign(m_chunks.size(), 0);
+  Utils::Parallel::dynamicParallelFor(
+      itemCost() * chunkSize, m_chunks.size(),
+      [this, params](size_t i) { updateChunk(params, i); });
+  trackPenalties(params);
+}
+
+void Optimizer::setQuantizedState(bool quantized) {
+  if (quantized == m_quantized)
+    return;
+
+  m_quantized = quantized;
+  // Forces the next update to allocate state of the new kind
+  m_bound.clear();
+  m_momentums = {};
+  m_cache = {};
+  m_quantizedMomentums = {};
+  m_quantizedCache = {};
+  m_momentumScales = {};
+  m_cacheScales = {};
+}
+
+template <typename Function>
+void Optimizer::visit(std::span<const Parameter> params, size_t chunk,
+                      Function &&function) {
+  const Chunk &current{m_chunks[chunk]};
+  const Range whole{range(params, chunk)};
+  if (!m_quantized && current.stride == 1) {
+    function(whole);
+    return;
+  }
+
+  const size_t state{m_offsets[current.param] + current.stateStart};
+  float values[quantizationBlock];
+  float momentums[quantizationBlock];
+  float cache[quantizationBlock];
+  size_t block{firstBlock(params, chunk)};
+  for (size_t start{}; start < whole.count;
+       start += quantizationBlock, ++block) {
+    Range piece{whole};
+    piece.gradients += start;
+    piece.count = std::min(quantizationBlock, whole.count - start);
+
+    float *strided{};
+    if (current.stride == 1) {
+      piece.values += start;
+    } else {
+      strided = whole.values + start * current.stride;
+      for (size_t i{}; i < piece.count; ++i)
+        values[i] = strided[i * current.stride];
+      piece.values = values;
+    }
+
+    int8_t *quantizedMomentums{};
+    uint8_t *quantizedCache{};
+    if (!m_quantized) {
+      if (piece.momentums)
+        piece.momentums += start;
+      if (piece.cache)
+        piece.cache += start;
+    } else {
+      if (usesMomentums()) {
+        quantizedMomentums = m_quantizedMomentums.data() + state + start;
+        dequantizeMomentums(quantizedMomentums, m_momentumScales[block],
+                            momentums, piece.count);
+        piece.momentums = momentums;
+      }
+      if (usesCache()) {
+        quantizedCache = m_quantizedCache.data() + state + start;
+        dequantizeCache(quantizedCache, m_cacheScales[block], cache,
+                        piece.count);
+        piece.cache = cache;
+      }
+    }
+
+    function(piece);
+
+    if (strided)
+      for (size_t i{}; i < piece.count; ++i)
+        strided[i * current.stride] = values[i];
+    if (quantizedMomentums)
+      m_momentumScales[block] =
+          quantizeMomentums(momentums, quantizedMomentums, piece.count);
+    if (quantizedCache)
+      m_cacheScales[block] =
+          quantizeCache(cache, quantizedCache, piece.count);
+  }
+}
+
+size_t Optimizer::firstBlock(std::span<const Parameter> params,
+                             size_t chunk) const {
+  const Chunk &current{m_chunks[chunk]};
+  const Parameter &param{params[current.param]};
+  if (!param.isSparse())
+    return m_blockOffsets[current.param] +
+           current.stateStart / quantizationBlock;
+
+  const size_t rowBlocks{(param.rowSize + quantizationBlock - 1) /
+                         quantizationBlock};
+  return m_blockOffsets[current.param] +
+         current.stateStart / param.rowSize * rowBlocks;
+}
+
+void Optimizer::updateChunk(std::span<const Parameter> params, size_t chunk) {
+  const Parameter &param{params[m_chunks[chunk].param]};
+  if (!param.isRegularized() || !param.penalty) {
+    visit(params, chunk, [this](const Range &range) { updateRange(range); });
+    return;
+  }
+
+  // Dense parameters are covered by their chunks, so their penalty is
+  // rebuilt from the new values. Sparse ones only change on touched rows,
+  // so the difference is tracked instead. Either is measured on every range
+  // right around its update, while it's still in cache
+  float penalty{};
+  visit(params, chunk, [this, &param, &penalty](const Range &range) {
+    const std::span<const float> values{range.values, range.count};
+    if (param.isSparse())
+      penalty -= regularizationLoss(values, param.l1, param.l2);
+    updateRange(range);
+    penalty += regularizationLoss(values, param.l1, param.l2);
+  });
+  m_chunkPenalties[chunk] = penalty;
+}
+
+void Optimizer::trackPenalties(std::span<const Parameter> params) {
+  for (const auto &param : params)
+    if (param.isRegularized() && param.penalty && !param.isSparse())
+      *param.penalty = 0;
+
+  for (size_t i{}; i < m_chunks.size(); ++i) {
+    const Parameter &param{params[m_chunks[i].param]};
+    if (param.isRegularized() && param.penalty)
+      *param.penalty += m_chunkPenalties[i];
+  }
+}
+
+Optimizer::Range Optimizer::range(std::span<const Parameter> params,
+                                  size_t chunk) {
+  const Chunk &current{m_chunks[chunk]};
+  const Parameter &param{params[current.param]};
+  const size_t state{m_offsets[current.param] + current.stateStart};
+
+  return {param.values.data() + current.valueStart,
+          param.gradients.data() + current.gradientStart,
+          m_momentums.empty() ? nullptr : m_momentums.data() + state,
+          m_cache.empty() ? nullptr : m_cache.data() + state,
+          current.count,
+          m_sums.empty() ? nullptr
+                         : m_sums.data() + current.param * sumCount(),
+          param.l1,
+          param.l2};
+}
+
+void Optimizer::measure(std::span<const Parameter> params) {
+  const size_t sums{sumCount()};
+
+  // Every chunk gathers its own sums in parallel, which are then reduced per
+  // parameter (so no synchronization is needed)
+  m_chunkSums.assign(m_chunks.size() * sums, 0);
+  m_sums.clear();
+  Utils::Parallel::dynamicParallelFor(
+      itemCost() * chunkSize, m_chunks.size(), [this, params, sums](size_t i) {
+        float *chunkSums{m_chunkSums.data() + i * sums};
+        visit(params, i, [this, chunkSums](const Range &range) {
+          measureRange(range, chunkSums);
+        });
+      });
+
+  m_sums.assign(params.size() * sums, 0);
+  for (size_t i{}; i < m_chunks.size(); ++i)
+    for (size_t j{}; j < sums; ++j)
+      m_sums[m_chunks[i].param * sums + j] += m_chunkSums[i * sums + j];
+}
+
+void Optimizer::bind(std::span<const Parameter> params) {
+  if (std::ranges::equal(params, m_bound,
+                         [](const Parameter &param, const Binding &bound) {
+                           return param.values.data() ==
+                                      bound.values.data() &&
+                                  param.values.size() ==
+                                      bound.values.size() &&
+                                  param.sparseColumns == bound.sparseColumns;
+                         }))
+    return;
+
+  m_bound.clear();
+  m_offsets.clear();
+  m_blockOffsets.clear();
+  size_t size{};
+  size_t blocks{};
+  for (const auto &param : params) {
+    m_bound.push_back({param.values, param.sparseColumns});
+    m_offsets.push_back(size);
+    m_blockOffsets.push_back(blocks);
+    size += param.values.size();
+
+    const size_t segment{param.isSparse() ? param.rowSize
+                                          : param.values.size()};
+    if (segment > 0)
+      blocks += param.values.size() / segment *
+                ((segment + quantizationBlock - 1) / quantizationBlock);
+  }
+
+  const bool momentums{usesMomentums()};
+  const bool cache{usesCache()};
+  m_momentums.assign(momentums && !m_quantized ? size : 0, 0);
+  m_cache.assign(cache && !m_quantized ? size : 0, 0);
+  m_quantizedMomentums.assign(momentums && m_quantized ? size : 0, 0);
+  m_quantizedCache.assign(cache && m_quantized ? size : 0, 0);
+  m_momentumScales.assign(momentums && m_quantized ? blocks : 0, 0);
+  m_cacheScales.assign(cache && m_quantized ? blocks : 0, 0);
+}
+
+void Optimizer::split(std::span<const Parameter> params) {
+  m_chunks.clear();
+  for (size_t i{}; i < params.size(); ++i) {
+    const Parameter &param{params[i]};
+    if (!param.isSparse()) {
+      const size_t size{param.values.size()};
+      for (size_t start{}; start < size; start += chunkSize)
+        m_chunks.push_back(
+            {i, start, start, std::min(chunkSize, size - start), start});
+      continue;
+    }
+
+    // Touched columns start at their index, and their state (laid out by
+    // columns) is contiguous like a touched row's
+    const size_t columns{param.values.size() / param.rowSize};
+    for (size_t row{}; row < param.rows.size(); ++row) {
+      const size_t index{param.rows[row]};
+      if (param.sparseColumns)
+        m_chunks.push_back({i, index, row * param.rowSize, param.rowSize,
+                            index * param.rowSize, columns});
+      else
+        m_chunks.push_back({i, index * param.rowSize, row * param.rowSize,
+                            param.rowSize, index * param.rowSize});
+    }
+  }
+}
+} // namespace Optimizers
+} // namespace ANN
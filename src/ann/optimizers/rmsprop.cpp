@@ -1,5 +1,6 @@
 #include "ann/optimizers/rmsprop.h"
 
+#include <algorithm>
 #include <cmath>
 
 namespace ANN {
@@ -9,43 +10,23 @@ void RMSProp::preUpdate() {
       std::max(m_startingLearningRate / (1 + m_decay * m_iteration), 1e-7f);
 }
 
-void RMSProp::updateParams(Layers::Dense &layer) const {
-  auto learningRate{m_learningRate};
-  auto epsilon{m_epsilon};
-  auto rho{m_rho};
-  // update weight/bias cache member variables to account for adaptive lr
-  layer.m_weightCache.transform(
-      layer.m_dweights, [rho](float *weightCache, const float *gradient) {
-        *weightCache = rho * *weightCache + (1 - rho) * *gradient * *gradient;
-      });
-  layer.m_biasCache.transform(
-      layer.m_dbiases, [rho](float *biasCache, const float *gradient) {
-        *biasCache = rho * *biasCache + (1 - rho) * *gradient * *gradient;
-      });
+void RMSProp::updateRange(const Range &range) const {
+  const float learningRate{m_learningRate};
+  const float epsilon{m_epsilon};
+  const float rho{m_rho};
 
-  // Calculate actual weight/bias updates
-  layer.m_weightMomentums.transform(
-      layer.m_dweights, layer.m_weightCache,
-      [learningRate, epsilon](float *weightUpdates, const float *gradient,
-                              const float *cache) {
-        *weightUpdates =
-            learningRate * *gradient / (std::sqrt(*cache) + epsilon);
-      });
-  layer.m_biasMomentums.transform(
-      layer.m_dbiases, layer.m_biasCache,
-      [learningRate, epsilon](float *biasUpdates, const float *gradient,
-                              const float *cache) {
-        *biasUpdates = learningRate * *gradient / (std::sqrt(*cache) + epsilon);
-      });
+  float *values{range.values};
+  float *cache{range.cache};
+  const float *gradients{range.gradients};
+  const float l1{range.l1};
+  const float l2{range.l2};
 
-  // use weight/bias update to update weights/biases
-  layer.m_weights.transform(layer.m_weightMomentums,
-                            [](float *weight, const float *weightUpdates) {
-                              *weight -= *weightUpdates;
-                            });
-  layer.m_biases.transform(
-      layer.m_biasMomentums,
-      [](float *bias, const float *biasUpdates) { *bias -= *biasUpdates; });
+  // update cache to account for adaptive lr, and use it to update parameters
+  for (size_t i{}; i < range.count; ++i) {
+    const float gradient{regularize(gradients[i], values[i], l1, l2)};
+    cache[i] = rho * cache[i] + (1 - rho) * gradient * gradient;
+    values[i] -= learningRate * gradient / (std::sqrt(cache[i]) + epsilon);
+  }
 }
 
 void RMSProp::postUpdate() { ++m_iteration; }
@@ -1,5 +1,7 @@
 #include "ann/optimizers/sgd.h"
 
+#include <algorithm>
+
 namespace ANN {
 namespace Optimizers {
 void SGD::preUpdate() {
@@ -7,27 +9,29 @@ void SGD::preUpdate() {
       std::max(m_startingLearningRate / (1 + m_decay * m_iteration), 1e-7f);
 }
 
-void SGD::updateParams(Layers::Dense &layer) const {
-  auto learningRate{m_learningRate};
-  auto momentum{m_momentum};
+void SGD::updateRange(const Range &range) const {
+  const float learningRate{m_learningRate};
+  const float momentum{m_momentum};
+
+  float *values{range.values};
+  float *momentums{range.momentums};
+  const float *gradients{range.gradients};
+  const float l1{range.l1};
+  const float l2{range.l2};
 
-  // update weight/bias momentum member variables
-  layer.m_weightMomentums.transform(
-      layer.m_dweights, [learningRate, momentum](float *w, const float *d) {
-        *w = momentum * *w - learningRate * *d;
-      });
-  layer.m_biasMomentums.transform(
-      layer.m_dbiases, [learningRate, momentum](float *b, const float *d) {
-        *b = momentum * *b - learningRate * *d;
-      });
+  // Without momentum, no state is kept (see usesMomentums())
+  if (!momentums) {
+    for (size_t i{}; i < range.count; ++i)
+      values[i] -= learningRate * regularize(gradients[i], values[i], l1, l2);
+    return;
+  }
 
-  // use weight/bias momentum to update weights/biases
-  layer.m_weights.transform(
-      layer.m_weightMomentums,
-      [](float *w, const float *u) { *w += *u; });
-  layer.m_biases.transform(
-      layer.m_biasMomentums,
-      [](float *b, const float *u) { *b += *u; });
+  // update parameter momentums, and use them to update parameters
+  for (size_t i{}; i < range.count; ++i) {
+    momentums[i] = momentum * momentums[i] -
+                   learningRate * regularize(gradients[i], values[i], l1, l2);
+    values[i] += momentums[i];
+  }
 }
 
 void SGD::postUpdate() { ++m_iteration; }
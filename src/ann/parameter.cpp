@@ -0,0 +1,34 @@
+#include "ann/parameter.h"
+
+#include <cmath>
+
+namespace ANN {
+float regularizationLoss(std::span<const float> values, float l1, float l2) {
+  if (l1 == 0 && l2 == 0)
+    return 0;
+
+  // Independent partial sums, so the loop vectorizes without reassociating
+  // a single sum
+  constexpr size_t lanes{8};
+  float absolutes[lanes]{};
+  float squares[lanes]{};
+  const size_t body{values.size() - values.size() % lanes};
+  for (size_t i{}; i < body; i += lanes)
+    for (size_t j{}; j < lanes; ++j) {
+      absolutes[j] += std::abs(values[i + j]);
+      squares[j] += values[i + j] * values[i + j];
+    }
+  for (size_t i{body}; i < values.size(); ++i) {
+    absolutes[0] += std::abs(values[i]);
+    squares[0] += values[i] * values[i];
+  }
+
+  float absolute{};
+  float square{};
+  for (size_t j{}; j < lanes; ++j) {
+    absolute += absolutes[j];
+    square += squares[j];
+  }
+  return l1 * absolute + l2 * square;
+}
+} // namespace ANN
@@ -0,0 +1,183 @@
+#include "ann/trainingLog.h"
+
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+namespace ANN {
+TrainingLog::TrainingLog(bool verbose, std::ofstream file)
+    : m_verbose{verbose}, m_hasFile{file.is_open()}, m_file{std::move(file)} {
+  m_writer = std::thread{[this]() { write(); }};
+}
+
+TrainingLog::~TrainingLog() {
+  push({.kind = Kind::Stop});
+  m_writer.join();
+}
+
+void TrainingLog::plannedMemory(size_t bytes) {
+  push({.kind = Kind::PlannedMemory, .count = bytes});
+}
+
+void TrainingLog::epoch(size_t epoch) {
+  push({.kind = Kind::Epoch, .count = epoch});
+}
+
+void TrainingLog::update(const Update &update, bool toConsole, bool toFile) {
+  toConsole = toConsole && m_verbose;
+  toFile = toFile && hasFile();
+  if (toConsole || toFile)
+    push({.kind = Kind::Update,
+          .toConsole = toConsole,
+          .toFile = toFile,
+          .update = update});
+}
+
+void TrainingLog::validation(float loss, float accuracy) {
+  push({.kind = Kind::Validation,
+        .update = {.accuracy = accuracy, .dataLoss = loss}});
+}
+
+void TrainingLog::epochEnd() { push({.kind = Kind::EpochEnd}); }
+
+void TrainingLog::push(const Record &record) {
+  const uint32_t tail{m_tail.load(std::memory_order_relaxed)};
+
+  uint32_t head{m_head.load(std::memory_order_acquire)};
+  while (tail - head == capacity) {
+    m_head.wait(head, std::memory_order_acquire);
+    head = m_head.load(std::memory_order_acquire);
+  }
+
+  m_records[tail % capacity] = record;
+  m_tail.store(tail + 1, std::memory_order_release);
+  m_tail.notify_one();
+}
+
+void TrainingLog::write() {
+  uint32_t head{m_head.load(std::memory_order_relaxed)};
+  while (true) {
+    const uint32_t tail{m_tail.load(std::memory_order_acquire)};
+    if (head == tail) {
+      // Flushed only once the buffer is drained, so bursts are written
+      // together
+      std::cout.flush();
+      if (m_hasFile)
+        m_file.flush();
+      m_tail.wait(tail, std::memory_order_acquire);
+      continue;
+    }
+
+    for (; head != tail; ++head) {
+      const Record &record{m_records[head % capacity]};
+      if (record.kind == Kind::Stop) {
+        std::cout.flush();
+        return;
+      }
+      format(record);
+    }
+
+    m_head.store(head, std::memory_order_release);
+    m_head.notify_one();
+  }
+}
+
+void TrainingLog::format(const Record &record) {
+  switch (record.kind) {
+  case Kind::PlannedMemory:
+    if (m_verbose)
+      std::cout << "Planned buffer memory: " << formatBytes(record.count)
+                << '\n';
+    if (m_hasFile)
+      m_file << "Planned buffer memory: " << formatBytes(record.count) << '\n';
+    break;
+  case Kind::Epoch:
+    if (m_verbose)
+      std::cout << "\nEpoch " << record.count << ":\n";
+    if (m_hasFile)
+      m_file << "\nEPOCH " << record.count << ":\n";
+    break;
+  case Kind::Update: {
+    const Update &update{record.update};
+    std::stringstream out{};
+    out << std::fixed << std::setprecision(4) << update.batch + 1 << '/'
+        << update.steps << '\t' << static_cast<size_t>(update.epochTime)
+        << "s "
+        << formatTime(update.epochTime /
+                      (static_cast<double>(update.batch + 1)))
+        << "/step \t";
+
+    // Get accuracy only for classification losses (no regression accuracy)
+    if (update.accuracy != -1)
+      out << "accuracy: " << update.accuracy << " - ";
+
+    out << "loss: " << update.dataLoss + update.regularizationLoss
+        << " (data loss: " << update.dataLoss
+        << ", reg loss: " << update.regularizationLoss
+        << ") - lr: " << update.learningRate;
+
+    if (record.toConsole)
+      std::cout << '\r' << out.str() << std::flush;
+    if (record.toFile)
+      m_file << out.str() << '\n';
+    break;
+  }
+  case Kind::Validation:
+    if (m_verbose)
+      std::cout << " - val loss: " << record.update.dataLoss;
+    if (m_hasFile)
+      m_file << "Validation loss: " << record.update.dataLoss << '\n';
+
+    if (record.update.accuracy != -1) {
+      if (m_verbose)
+        std::cout << " - val accuracy: " << record.update.accuracy;
+      if (m_hasFile)
+        m_file << "Validation accuracy: " << record.update.accuracy << '\n';
+    }
+    break;
+  case Kind::EpochEnd:
+    std::cout << '\n';
+    break;
+  case Kind::Stop:
+    break;
+  }
+}
+
+std::string TrainingLog::formatTime(double seconds) {
+  if (seconds >= 1.0)
+    return std::to_string(static_cast<unsigned long long>(seconds)) + "s";
+
+  const unsigned long long ns = static_cast<unsigned long long>(seconds * 1e9);
+  if (ns < 1000)
+    return std::to_string(ns) + "ns";
+
+  const unsigned long long us = ns / 1000;
+  if (us < 1000)
+    return std::to_string(us) + "us";
+
+  const unsigned long long ms = us / 1000;
+  if (ms < 1000)
+    return std::to_string(ms) + "ms";
+
+  // Fallback: round down to 0s
+  return "0s";
+}
+
+std::string TrainingLog::formatBytes(size_t bytes) {
+  constexpr std::array<std::string_view, 4> units{"B", "KiB", "MiB", "GiB"};
+
+  double size{static_cast<double>(bytes)};
+  size_t unit{};
+  while (size >= 1024.0 && unit + 1 < units.size()) {
+    size /= 1024.0;
+    ++unit;
+  }
+
+  std::stringstream out{};
+  out << std::fixed << std::setprecision(unit == 0 ? 0 : 1) << size << ' '
+      << units[unit];
+  return out.str();
+}
+} // namespace ANN